@@ -27,6 +27,7 @@ typedef struct {
 	GtkWidget * strength;
 	GtkWidget * hbox;
 
+	NMDevice *  device;
 	char *      ssid_string;
 	guint32     int_strength;
 	gchar *     hash;
@@ -47,6 +48,14 @@ nm_network_menu_item_get_ssid (NMNetworkMenuItem *item)
 	return NM_NETWORK_MENU_ITEM_GET_PRIVATE (item)->ssid_string;
 }
 
+NMDevice *
+nm_network_menu_item_get_device (NMNetworkMenuItem *item)
+{
+	g_return_val_if_fail (NM_IS_NETWORK_MENU_ITEM (item), NULL);
+
+	return NM_NETWORK_MENU_ITEM_GET_PRIVATE (item)->device;
+}
+
 guint32
 nm_network_menu_item_get_strength (NMNetworkMenuItem *item)
 {
@@ -255,6 +264,7 @@ nm_network_menu_item_get_is_encrypted (NMNetworkMenuItem *item)
 
 GtkWidget *
 nm_network_menu_item_new (NMAccessPoint *ap,
+                          NMDevice *device,
                           guint32 dev_caps,
                           const char *hash,
                           gboolean has_connections,
@@ -272,6 +282,9 @@ nm_network_menu_item_new (NMAccessPoint *ap,
 
 	nm_network_menu_item_add_dupe (item, ap);
 
+	/* Only compared against, not referenced */
+	priv->device = device;
+
 	ssid = nm_access_point_get_ssid (ap);
 	if (ssid) {
 		priv->ssid_string = nm_utils_ssid_to_utf8 (g_bytes_get_data (ssid, NULL),
@@ -36,6 +36,7 @@ struct _NMNetworkMenuItemClass {
 
 GType	   nm_network_menu_item_get_type (void) G_GNUC_CONST;
 GtkWidget* nm_network_menu_item_new (NMAccessPoint *ap,
+                                     NMDevice *device,
                                      guint32 dev_caps,
                                      const char *hash,
                                      gboolean has_connections,
@@ -43,6 +44,8 @@ GtkWidget* nm_network_menu_item_new (NMAccessPoint *ap,
 
 const char *nm_network_menu_item_get_ssid (NMNetworkMenuItem *item);
 
+NMDevice * nm_network_menu_item_get_device (NMNetworkMenuItem *item);
+
 gboolean   nm_network_menu_item_get_is_adhoc (NMNetworkMenuItem *item);
 gboolean   nm_network_menu_item_get_is_encrypted (NMNetworkMenuItem *item);
 
@@ -13,11 +13,16 @@
 
 #include "applet-agent.h"
 #include "utils.h"
+#include "profile.h"
+#include "applet-probes.h"
 
 #define KEYRING_UUID_TAG "connection-uuid"
 #define KEYRING_SN_TAG "setting-name"
 #define KEYRING_SK_TAG "setting-key"
 
+/* The secrets classes of the settings of a remote connection, see get_secrets_class() */
+#define SECRETS_CLASS_TAG "applet-agent-secrets-class"
+
 static const SecretSchema network_manager_secret_schema = {
 	"org.freedesktop.NetworkManager.Connection",
 	SECRET_SCHEMA_DONT_MATCH_NAME,
@@ -34,9 +39,18 @@ G_DEFINE_TYPE (AppletAgent, applet_agent, NM_TYPE_SECRET_AGENT_OLD);
 #define APPLET_AGENT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), APPLET_TYPE_AGENT, AppletAgentPrivate))
 
 typedef struct {
+	NMClient *client;
 	GHashTable *requests;
+	/* In-flight GetSecrets requests by "path/setting-name", each a GSList */
+	GHashTable *get_requests;
 	gboolean vpn_only;
 
+	/* GetSecrets requests received, and those that joined an identical
+	 * request in flight rather than starting their own.
+	 */
+	guint get_requests_total;
+	guint get_requests_coalesced;
+
 	gboolean disposed;
 } AppletAgentPrivate;
 
@@ -50,6 +64,17 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 /*******************************************************/
 
+typedef enum {
+	/* Set once the setting has been classified */
+	SECRETS_CLASS_KNOWN           = (1 << 0),
+	/* The setting has secrets and none of them is ever saved, so there's
+	 * nothing to look for in the keyring.
+	 */
+	SECRETS_CLASS_NOT_SAVED_ONLY  = (1 << 1),
+	/* Some secret relevant to the connection type is never saved */
+	SECRETS_CLASS_ALWAYS_ASK      = (1 << 2),
+} SecretsClass;
+
 typedef struct {
 	guint id;
 
@@ -66,6 +91,16 @@ typedef struct {
 
 	GCancellable *cancellable;
 	gint keyring_calls;
+
+	/* For GetSecrets: how the requested setting's secrets are stored */
+	SecretsClass secrets_class;
+	/* For GetSecrets: the key in get_requests, if indexed there */
+	char *index_key;
+	/* Identical GetSecrets requests waiting for this one's result */
+	GSList *waiters;
+
+	/* nma_profile_now() when the request came in */
+	gint64 profile_begin;
 } Request;
 
 static Request *
@@ -97,18 +132,100 @@ request_new (NMSecretAgentOld *agent,
 	r->delete_callback = delete_callback;
 	r->callback_data = callback_data;
 	r->cancellable = g_cancellable_new ();
+	r->profile_begin = nma_profile_now ();
 	return r;
 }
 
+static char *
+request_index_key (const char *connection_path, const char *setting_name)
+{
+	return g_strdup_printf ("%s/%s", connection_path, setting_name);
+}
+
+static void
+request_index_add (Request *r)
+{
+	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (r->agent);
+	GSList *list;
+
+	r->index_key = request_index_key (r->path, r->setting_name);
+	list = g_hash_table_lookup (priv->get_requests, r->index_key);
+	g_hash_table_insert (priv->get_requests, g_strdup (r->index_key), g_slist_prepend (list, r));
+}
+
+static void
+request_index_remove (Request *r)
+{
+	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (r->agent);
+	GSList *list;
+
+	if (!r->index_key)
+		return;
+
+	list = g_hash_table_lookup (priv->get_requests, r->index_key);
+	list = g_slist_remove (list, r);
+	if (list)
+		g_hash_table_insert (priv->get_requests, g_strdup (r->index_key), list);
+	else
+		g_hash_table_remove (priv->get_requests, r->index_key);
+	g_clear_pointer (&r->index_key, g_free);
+}
+
+static gboolean
+hints_equal (char **a, char **b)
+{
+	guint i;
+
+	if (!a || !b)
+		return (!a || !a[0]) && (!b || !b[0]);
+
+	for (i = 0; a[i] && b[i]; i++) {
+		if (strcmp (a[i], b[i]) != 0)
+			return FALSE;
+	}
+	return !a[i] && !b[i];
+}
+
+/* Returns an in-flight GetSecrets request that the given one can share the
+ * result of: same connection and setting, and the same flags and hints, so
+ * that eg a request for new secrets never gets the ones already in the keyring.
+ */
+static Request *
+request_find_identical (AppletAgentPrivate *priv,
+                        const char *connection_path,
+                        const char *setting_name,
+                        const char **hints,
+                        guint32 flags)
+{
+	gs_free char *key = request_index_key (connection_path, setting_name);
+	GSList *iter;
+
+	for (iter = g_hash_table_lookup (priv->get_requests, key); iter; iter = iter->next) {
+		Request *r = iter->data;
+
+		if (r->flags == flags && hints_equal (r->hints, (char **) hints))
+			return r;
+	}
+	return NULL;
+}
+
 static void
 request_free (Request *r)
 {
-	if (!g_cancellable_is_cancelled (r->cancellable))
+	if (!g_cancellable_is_cancelled (r->cancellable)) {
 		g_hash_table_remove (APPLET_AGENT_GET_PRIVATE (r->agent)->requests, GUINT_TO_POINTER (r->id));
+		request_index_remove (r);
+	}
 
 	/* By the time the request is freed, all keyring calls should be completed */
 	g_warn_if_fail (r->keyring_calls == 0);
 
+	/* Waiters whose callback wasn't called yet were canceled along with
+	 * the agent.
+	 */
+	g_slist_free_full (r->waiters, (GDestroyNotify) request_free);
+
+	g_free (r->index_key);
 	g_object_unref (r->connection);
 	g_free (r->path);
 	g_free (r->setting_name);
@@ -118,6 +235,33 @@ request_free (Request *r)
 	g_slice_free (Request, r);
 }
 
+/* Calls the GetSecrets callback of the request and of the requests that
+ * were waiting for it, then frees them all.
+ */
+static void
+request_complete (Request *r, GVariant *secrets, GError *error)
+{
+	GSList *waiters, *iter;
+
+	waiters = g_steal_pointer (&r->waiters);
+	for (iter = waiters; iter; iter = iter->next) {
+		Request *waiter = iter->data;
+
+		waiter->get_callback (NM_SECRET_AGENT_OLD (waiter->agent), waiter->connection, secrets, error, waiter->callback_data);
+		NMA_PROBE2 (get_secrets_reply, waiter->id, error != NULL);
+		nma_profile_mark_message (waiter->profile_begin, "agent", "get-secrets (coalesced)",
+		                          "%s/%s", waiter->path, waiter->setting_name);
+		request_free (waiter);
+	}
+	g_slist_free (waiters);
+
+	r->get_callback (NM_SECRET_AGENT_OLD (r->agent), r->connection, secrets, error, r->callback_data);
+	NMA_PROBE2 (get_secrets_reply, r->id, error != NULL);
+	nma_profile_mark_message (r->profile_begin, "agent", "get-secrets",
+	                          "%s/%s%s", r->path, r->setting_name, error ? " (failed)" : "");
+	request_free (r);
+}
+
 /*******************************************************/
 
 static void
@@ -164,9 +308,9 @@ get_secrets_cb (AppletAgent *self,
 			g_object_unref (dupl);
 		}
 
-		r->get_callback (NM_SECRET_AGENT_OLD (r->agent), r->connection, secrets, error, r->callback_data);
-	}
-	request_free (r);
+		request_complete (r, secrets, error);
+	} else
+		request_free (r);
 }
 
 static void
@@ -254,6 +398,99 @@ is_connection_always_ask (NMConnection *connection)
 	return FALSE;
 }
 
+static void
+check_not_saved_only_cb (NMSetting *setting,
+                         const char *key,
+                         const GValue *value,
+                         GParamFlags flags,
+                         gpointer user_data)
+{
+	guint *counts = user_data;
+	NMSettingSecretFlags secret_flags = NM_SETTING_SECRET_FLAG_NONE;
+
+	if (!(flags & NM_SETTING_PARAM_SECRET))
+		return;
+	if (!nm_setting_get_secret_flags (setting, key, &secret_flags, NULL))
+		return;
+
+	if (secret_flags & NM_SETTING_SECRET_FLAG_NOT_SAVED)
+		counts[0]++;
+	else if (secret_flags & NM_SETTING_SECRET_FLAG_AGENT_OWNED)
+		counts[1]++;
+}
+
+static SecretsClass
+classify_secrets (NMConnection *connection, const char *setting_name)
+{
+	SecretsClass secrets_class = SECRETS_CLASS_KNOWN;
+	NMSetting *setting;
+	/* not-saved secrets, agent-owned (saved) secrets */
+	guint counts[2] = { 0, 0 };
+
+	if (is_connection_always_ask (connection))
+		secrets_class |= SECRETS_CLASS_ALWAYS_ASK;
+
+	/* WireGuard peers' preshared keys are saved in the keyring as
+	 * separate items that the setting's secret flags don't cover.
+	 */
+	setting = nm_connection_get_setting_by_name (connection, setting_name);
+	if (!setting || NM_IS_SETTING_WIREGUARD (setting))
+		return secrets_class;
+
+	nm_setting_enumerate_values (setting, check_not_saved_only_cb, counts);
+	if (counts[0] > 0 && counts[1] == 0)
+		secrets_class |= SECRETS_CLASS_NOT_SAVED_ONLY;
+
+	return secrets_class;
+}
+
+static void
+remote_connection_changed (NMConnection *connection, gpointer user_data)
+{
+	GHashTable *classes = user_data;
+
+	/* The secret flags may have changed */
+	g_hash_table_remove_all (classes);
+}
+
+/* Classifying the secrets enumerates all the properties of the connection.
+ * The result is kept on the remote connection until it changes, since NM
+ * sends a fresh copy of the connection with each request.
+ */
+static SecretsClass
+get_secrets_class (AppletAgent *self,
+                   NMConnection *connection,
+                   const char *connection_path,
+                   const char *setting_name)
+{
+	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (self);
+	NMRemoteConnection *remote = NULL;
+	GHashTable *classes;
+	SecretsClass secrets_class;
+
+	if (priv->client && connection_path)
+		remote = nm_client_get_connection_by_path (priv->client, connection_path);
+	if (!remote)
+		return classify_secrets (connection, setting_name);
+
+	classes = g_object_get_data (G_OBJECT (remote), SECRETS_CLASS_TAG);
+	if (!classes) {
+		classes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		g_object_set_data_full (G_OBJECT (remote), SECRETS_CLASS_TAG, classes,
+		                        (GDestroyNotify) g_hash_table_unref);
+		g_signal_connect (remote, NM_CONNECTION_CHANGED,
+		                  G_CALLBACK (remote_connection_changed), classes);
+	}
+
+	secrets_class = GPOINTER_TO_UINT (g_hash_table_lookup (classes, setting_name));
+	if (!secrets_class) {
+		secrets_class = classify_secrets (connection, setting_name);
+		g_hash_table_insert (classes, g_strdup (setting_name), GUINT_TO_POINTER (secrets_class));
+	}
+
+	return secrets_class;
+}
+
 static void
 keyring_find_secrets_cb (GObject *source,
                          GAsyncResult *result,
@@ -387,7 +624,7 @@ keyring_find_secrets_cb (GObject *source,
 			g_message ("New secrets for %s/%s requested; ask the user", connection_id, r->setting_name);
 			ask = TRUE;
 		} else if (   (r->flags & NM_SECRET_AGENT_GET_SECRETS_FLAG_ALLOW_INTERACTION)
-			       && is_connection_always_ask (r->connection))
+			       && (r->secrets_class & SECRETS_CLASS_ALWAYS_ASK))
 			ask = TRUE;
 	}
 
@@ -418,8 +655,7 @@ done:
 		ask_for_secrets (r);
 	} else {
 		/* Otherwise send the secrets back to NetworkManager */
-		r->get_callback (NM_SECRET_AGENT_OLD (r->agent), r->connection, error ? NULL : settings, error, r->callback_data);
-		request_free (r);
+		request_complete (r, error ? NULL : settings, error);
 	}
 
 	if (settings)
@@ -438,7 +674,7 @@ get_secrets (NMSecretAgentOld *agent,
              gpointer callback_data)
 {
 	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (agent);
-	Request *r;
+	Request *r, *primary;
 	GError *error = NULL;
 	NMSettingConnection *s_con;
 	NMSetting *setting;
@@ -472,9 +708,37 @@ get_secrets (NMSecretAgentOld *agent,
 		return;
 	}
 
+	/* Only handle non-VPN secrets if we're supposed to */
+	if (priv->vpn_only == TRUE && strcmp (ctype, NM_SETTING_VPN_SETTING_NAME)) {
+		error = g_error_new_literal (NM_SECRET_AGENT_ERROR,
+		                             NM_SECRET_AGENT_ERROR_NO_SECRETS,
+		                             "Only handling VPN secrets at this time.");
+		callback (agent, connection, NULL, error, callback_data);
+		g_error_free (error);
+		return;
+	}
+
 	/* Track the secrets request */
 	r = request_new (agent, connection, connection_path, setting_name, hints, flags, callback, NULL, NULL, callback_data);
 	g_hash_table_insert (priv->requests, GUINT_TO_POINTER (r->id), r);
+	priv->get_requests_total++;
+	NMA_PROBE3 (get_secrets, r->id, r->path, r->setting_name);
+
+	/* NM may ask again for the same secrets before the first request
+	 * completed, eg when a connection is quickly reactivated. Let such a
+	 * request wait for the result of the first instead of searching the
+	 * keyring or asking the user again.
+	 */
+	primary = request_find_identical (priv, connection_path, setting_name, hints, flags);
+	if (primary) {
+		primary->waiters = g_slist_append (primary->waiters, r);
+		priv->get_requests_coalesced++;
+		g_debug ("Secrets for %s/%s already requested; waiting for request %u (%u of %u requests coalesced)",
+		         nm_connection_get_id (connection), setting_name, primary->id,
+		         priv->get_requests_coalesced, priv->get_requests_total);
+		return;
+	}
+	request_index_add (r);
 
 	/* VPN passwords are handled by the VPN plugin's auth dialog */
 	if (!strcmp (ctype, NM_SETTING_VPN_SETTING_NAME)) {
@@ -482,13 +746,26 @@ get_secrets (NMSecretAgentOld *agent,
 		return;
 	}
 
-	/* Only handle non-VPN secrets if we're supposed to */
-	if (priv->vpn_only == TRUE) {
-		error = g_error_new_literal (NM_SECRET_AGENT_ERROR,
-		                             NM_SECRET_AGENT_ERROR_NO_SECRETS,
-		                             "Only handling VPN secrets at this time.");
-		callback (agent, connection, NULL, error, callback_data);
-		g_error_free (error);
+	/* Don't search the keyring (and maybe prompt for unlocking it) when none
+	 * of the setting's secrets can be there.
+	 */
+	r->secrets_class = get_secrets_class (APPLET_AGENT (agent), connection, connection_path, setting_name);
+	if (r->secrets_class & SECRETS_CLASS_NOT_SAVED_ONLY) {
+		if (flags & NM_SECRET_AGENT_GET_SECRETS_FLAG_ALLOW_INTERACTION) {
+			g_message ("Secrets for %s/%s are never saved; asking user.",
+			           nm_connection_get_id (connection), setting_name);
+			ask_for_secrets (r);
+		} else {
+			GVariantBuilder builder_connection;
+			GVariant *settings;
+
+			g_variant_builder_init (&builder_connection, NM_VARIANT_TYPE_CONNECTION);
+			g_variant_builder_add (&builder_connection, "{s@a{sv}}", setting_name,
+			                       g_variant_new_array (G_VARIANT_TYPE ("{sv}"), NULL, 0));
+			settings = g_variant_ref_sink (g_variant_builder_end (&builder_connection));
+			request_complete (r, settings, NULL);
+			g_variant_unref (settings);
+		}
 		return;
 	}
 
@@ -516,32 +793,41 @@ cancel_get_secrets (NMSecretAgentOld *agent,
                     const char *setting_name)
 {
 	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (agent);
-	GHashTableIter iter;
-	Request *r;
+	gs_free char *key = NULL;
+	gs_free char *index_key = NULL;
+	GSList *list, *iter, *waiter_iter;
 	GError *error;
 
+	key = request_index_key (connection_path, setting_name);
+	if (!g_hash_table_lookup_extended (priv->get_requests, key, (gpointer) &index_key, (gpointer) &list))
+		return;
+	g_hash_table_steal (priv->get_requests, key);
+
 	error = g_error_new_literal (NM_SECRET_AGENT_ERROR,
 	                             NM_SECRET_AGENT_ERROR_AGENT_CANCELED,
 	                             "Canceled by NetworkManager");
 
-	g_hash_table_iter_init (&iter, priv->requests);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &r)) {
-		/* Only care about GetSecrets requests here */
-		if (r->get_callback == NULL)
-			continue;
+	/* Cancel any matching GetSecrets call, along with the calls waiting for it */
+	for (iter = list; iter; iter = iter->next) {
+		Request *r = iter->data;
 
-		/* Cancel any matching GetSecrets call */
-		if (   g_strcmp0 (r->path, connection_path) == 0
-		    && g_strcmp0 (r->setting_name, setting_name) == 0) {
-			/* cancel outstanding keyring operations */
-			g_cancellable_cancel (r->cancellable);
+		for (waiter_iter = r->waiters; waiter_iter; waiter_iter = waiter_iter->next) {
+			Request *waiter = waiter_iter->data;
 
-			r->get_callback (NM_SECRET_AGENT_OLD (r->agent), r->connection, NULL, error, r->callback_data);
-			g_hash_table_iter_remove (&iter);
-			g_signal_emit (r->agent, signals[CANCEL_SECRETS], 0, GUINT_TO_POINTER (r->id));
+			waiter->get_callback (NM_SECRET_AGENT_OLD (waiter->agent), waiter->connection, NULL, error, waiter->callback_data);
+			request_free (waiter);
 		}
+		g_clear_pointer (&r->waiters, g_slist_free);
+
+		/* cancel outstanding keyring operations */
+		g_cancellable_cancel (r->cancellable);
+
+		r->get_callback (NM_SECRET_AGENT_OLD (r->agent), r->connection, NULL, error, r->callback_data);
+		g_hash_table_remove (priv->requests, GUINT_TO_POINTER (r->id));
+		g_signal_emit (r->agent, signals[CANCEL_SECRETS], 0, GUINT_TO_POINTER (r->id));
 	}
 
+	g_slist_free (list);
 	g_error_free (error);
 }
 
@@ -807,6 +1093,28 @@ delete_secrets (NMSecretAgentOld *agent,
 	r->keyring_calls++;
 }
 
+/**
+ * applet_agent_set_client:
+ * @agent: the #AppletAgent
+ * @client: the #NMClient whose connections the agent's requests are for
+ *
+ * Lets the agent keep per-connection data on the remote connections, up
+ * to date with their changes.
+ */
+void
+applet_agent_set_client (AppletAgent *agent, NMClient *client)
+{
+	AppletAgentPrivate *priv;
+
+	g_return_if_fail (APPLET_IS_AGENT (agent));
+
+	priv = APPLET_AGENT_GET_PRIVATE (agent);
+	if (client)
+		g_object_ref (client);
+	g_clear_object (&priv->client);
+	priv->client = client;
+}
+
 void
 applet_agent_handle_vpn_only (AppletAgent *agent, gboolean vpn_only)
 {
@@ -816,6 +1124,30 @@ applet_agent_handle_vpn_only (AppletAgent *agent, gboolean vpn_only)
 	APPLET_AGENT_GET_PRIVATE (agent)->vpn_only = vpn_only;
 }
 
+/**
+ * applet_agent_get_statistics:
+ * @agent: the agent
+ * @out_pending: (out) (allow-none): the requests in flight
+ * @out_get_total: (out) (allow-none): the GetSecrets requests received
+ * @out_get_coalesced: (out) (allow-none): the GetSecrets requests that
+ *   waited for an identical one
+ */
+void
+applet_agent_get_statistics (AppletAgent *agent,
+                             guint *out_pending,
+                             guint *out_get_total,
+                             guint *out_get_coalesced)
+{
+	AppletAgentPrivate *priv;
+
+	g_return_if_fail (APPLET_IS_AGENT (agent));
+
+	priv = APPLET_AGENT_GET_PRIVATE (agent);
+	NM_SET_OUT (out_pending, g_hash_table_size (priv->requests));
+	NM_SET_OUT (out_get_total, priv->get_requests_total);
+	NM_SET_OUT (out_get_coalesced, priv->get_requests_coalesced);
+}
+
 /*******************************************************/
 
 AppletAgent *
@@ -841,6 +1173,7 @@ applet_agent_init (AppletAgent *self)
 	AppletAgentPrivate *priv = APPLET_AGENT_GET_PRIVATE (self);
 
 	priv->requests = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->get_requests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
@@ -859,6 +1192,8 @@ dispose (GObject *object)
 			g_cancellable_cancel (r->cancellable);
 
 		g_hash_table_destroy (priv->requests);
+		g_hash_table_destroy (priv->get_requests);
+		g_clear_object (&priv->client);
 		priv->disposed = TRUE;
 	}
 
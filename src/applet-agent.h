@@ -51,7 +51,14 @@ GType applet_agent_get_type (void) G_GNUC_CONST;
 
 AppletAgent *applet_agent_new (GError **error);
 
+void applet_agent_set_client (AppletAgent *agent, NMClient *client);
+
 void applet_agent_handle_vpn_only (AppletAgent *agent, gboolean vpn_only);
 
+void applet_agent_get_statistics (AppletAgent *agent,
+                                  guint *out_pending,
+                                  guint *out_get_total,
+                                  guint *out_get_coalesced);
+
 #endif /* _APPLET_AGENT_H_ */
 
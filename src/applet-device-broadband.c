@@ -16,8 +16,6 @@
 #include "mobile-helpers.h"
 #include "mb-menu-item.h"
 
-#define BROADBAND_INFO_TAG "devinfo"
-
 typedef struct {
 	NMApplet *applet;
 	NMDevice *device;
@@ -28,6 +26,10 @@ typedef struct {
 	MMModemCdma  *mm_modem_cdma;
 	MMSim        *mm_sim;
 
+	/* What the icon and menu show; only updated when that changes */
+	guint32 quality;
+	guint32 mb_act;
+
 	/* Operator info */
 	gchar *operator_name;
 	guint operator_name_update_id;
@@ -40,6 +42,14 @@ typedef struct {
 	GCancellable *cancellable;
 } BroadbandDeviceInfo;
 
+static BroadbandDeviceInfo *
+broadband_device_info_get (NMApplet *applet, NMDevice *device)
+{
+	AppletObjectData *data = applet_object_data_lookup (applet, device);
+
+	return data ? data->device_data : NULL;
+}
+
 /********************************************************************/
 
 static gboolean
@@ -282,6 +292,7 @@ unlock_dialog_new (NMDevice *device,
 {
 	MMModemLock lock;
 	const gchar *unlock_required;
+	gs_free_error GError *error = NULL;
 
 	if (info->dialog)
 		return;
@@ -300,6 +311,13 @@ unlock_dialog_new (NMDevice *device,
 		return;
 	}
 
+	if (!applet_ensure_gtk (info->applet, &error)) {
+		g_warning ("Cannot unlock devid: '%s': %s",
+		           mm_modem_get_device_identifier (info->mm_modem),
+		           error->message);
+		return;
+	}
+
 	info->dialog = applet_mobile_pin_dialog_new (unlock_required,
 	                                             nm_device_get_description (device));
 
@@ -458,7 +476,7 @@ get_secrets (SecretsRequest *req,
 	                                error))
 		return FALSE;
 
-	devinfo = g_object_get_data (G_OBJECT (device), BROADBAND_INFO_TAG);
+	devinfo = broadband_device_info_get (req->applet, device);
 	if (!devinfo) {
 		g_set_error (error,
 		             NM_SECRET_AGENT_ERROR,
@@ -625,7 +643,7 @@ get_icon (NMDevice *device,
 		return;
 	}
 
-	info = g_object_get_data (G_OBJECT (device), BROADBAND_INFO_TAG);
+	info = broadband_device_info_get (applet, device);
 	if (!info) {
 		g_warning ("ModemManager is not available for modem at %s",
 		           nm_device_get_udi (device));
@@ -640,8 +658,8 @@ get_icon (NMDevice *device,
 	                        tip,
 	                        applet,
 	                        broadband_state_to_mb_state (info),
-	                        broadband_act_to_mb_act (info),
-	                        mm_modem_get_signal_quality (info->mm_modem, NULL),
+	                        info->mb_act,
+	                        info->quality,
 	                        (mm_modem_get_state (info->mm_modem) >= MM_MODEM_STATE_ENABLED));
 }
 
@@ -711,7 +729,7 @@ add_menu_item (NMDevice *device,
 	GtkWidget *item;
 	int i;
 
-	info = g_object_get_data (G_OBJECT (device), BROADBAND_INFO_TAG);
+	info = broadband_device_info_get (applet, device);
 	if (!info) {
 		g_warning ("ModemManager is not available for modem at %s",
 		           nm_device_get_udi (device));
@@ -741,10 +759,10 @@ add_menu_item (NMDevice *device,
 		g_assert (s_con);
 
 		item = nm_mb_menu_item_new (nm_setting_connection_get_id (s_con),
-		                            mm_modem_get_signal_quality (info->mm_modem, NULL),
+		                            info->quality,
 		                            info->operator_name,
 		                            TRUE,
-		                            broadband_act_to_mb_act (info),
+		                            info->mb_act,
 		                            broadband_state_to_mb_state (info),
 		                            mm_modem_get_state (info->mm_modem) >= MM_MODEM_STATE_ENABLED,
 		                            applet);
@@ -762,10 +780,10 @@ add_menu_item (NMDevice *device,
 	} else {
 		/* Otherwise show idle registration state or disabled */
 		item = nm_mb_menu_item_new (NULL,
-		                            mm_modem_get_signal_quality (info->mm_modem, NULL),
+		                            info->quality,
 		                            info->operator_name,
 		                            FALSE,
-		                            broadband_act_to_mb_act (info),
+		                            info->mb_act,
 		                            broadband_state_to_mb_state (info),
 		                            mm_modem_get_state (info->mm_modem) >= MM_MODEM_STATE_ENABLED,
 		                            applet);
@@ -814,11 +832,38 @@ notify_connected (NMDevice *device,
 
 /********************************************************************/
 
+/* Modems on marginal coverage report small quality changes several times
+ * a second. Only redraw when the signal strength level shown changes, and
+ * only once the quality is past the level's boundary by the hysteresis.
+ */
 static void
 signal_quality_updated (GObject *object,
                         GParamSpec *pspec,
                         BroadbandDeviceInfo *info)
 {
+	guint32 quality = mm_modem_get_signal_quality (info->mm_modem, NULL);
+	const char *shown;
+	int hysteresis;
+
+	shown = mobile_helper_get_quality_icon_name (info->quality);
+	if (object && nm_streq (shown, mobile_helper_get_quality_icon_name (quality))) {
+		info->quality = quality;
+		return;
+	}
+
+	if (object) {
+		hysteresis = g_settings_get_int (info->applet->gsettings, PREF_BROADBAND_SIGNAL_HYSTERESIS);
+		hysteresis = CLAMP (hysteresis, 0, 25);
+		if (quality > info->quality) {
+			if (nm_streq (shown, mobile_helper_get_quality_icon_name (MAX ((int) quality - hysteresis, 0))))
+				return;
+		} else {
+			if (nm_streq (shown, mobile_helper_get_quality_icon_name (quality + hysteresis)))
+				return;
+		}
+	}
+
+	info->quality = quality;
 	applet_schedule_update_icon (info->applet);
 	applet_schedule_update_menu (info->applet);
 }
@@ -828,6 +873,13 @@ access_technologies_updated (GObject *object,
                              GParamSpec *pspec,
                              BroadbandDeviceInfo *info)
 {
+	guint32 mb_act = broadband_act_to_mb_act (info);
+
+	/* The technology shows as an icon and in the menu item's text */
+	if (object && mb_act == info->mb_act)
+		return;
+
+	info->mb_act = mb_act;
 	applet_schedule_update_icon (info->applet);
 	applet_schedule_update_menu (info->applet);
 }
@@ -1001,7 +1053,7 @@ device_added (NMDevice *device,
 	if (!udi)
 		return;
 
-	if (g_object_get_data (G_OBJECT (modem), BROADBAND_INFO_TAG))
+	if (broadband_device_info_get (applet, device))
 		return;
 
 	if (!applet->mm1_running) {
@@ -1053,10 +1105,9 @@ device_added (NMDevice *device,
 	                  info);
 
 	/* Store device info */
-	g_object_set_data_full (G_OBJECT (modem),
-	                        BROADBAND_INFO_TAG,
-	                        info,
-	                        (GDestroyNotify)broadband_device_info_free);
+	applet_object_data_set_device_data (applet_object_data_get (applet, modem),
+	                                    info,
+	                                    (GDestroyNotify) broadband_device_info_free);
 }
 
 /********************************************************************/
@@ -428,10 +428,14 @@ static gboolean
 nm_8021x_get_secrets (SecretsRequest *req, GError **error)
 {
 	NM8021xInfo *info = (NM8021xInfo *) req;
+	gboolean prewarmed;
 
 	applet_secrets_request_set_free_func (req, free_8021x_info);
 
-	info->dialog = nma_ethernet_dialog_new (g_object_ref (req->connection));
+	info->dialog = applet_secrets_request_take_prewarmed_dialog (req);
+	prewarmed = !!info->dialog;
+	if (!info->dialog)
+		info->dialog = nma_ethernet_dialog_new (g_object_ref (req->connection));
 	if (!info->dialog) {
 		g_set_error (error,
 		             NM_SECRET_AGENT_ERROR,
@@ -446,6 +450,7 @@ nm_8021x_get_secrets (SecretsRequest *req, GError **error)
 	gtk_window_set_position (GTK_WINDOW (info->dialog), GTK_WIN_POS_CENTER_ALWAYS);
 	gtk_widget_realize (info->dialog);
 	gtk_window_present (GTK_WINDOW (info->dialog));
+	applet_secrets_request_dialog_shown (req, prewarmed);
 
 	return TRUE;
 }
@@ -482,6 +487,18 @@ ethernet_get_secrets (SecretsRequest *req, GError **error)
 	return FALSE;
 }
 
+static GtkWidget *
+ethernet_new_secrets_dialog (NMConnection *connection,
+                             const char *setting_name,
+                             NMApplet *applet)
+{
+	if (   !nm_connection_is_type (connection, NM_SETTING_WIRED_SETTING_NAME)
+	    || strcmp (setting_name, NM_SETTING_802_1X_SETTING_NAME))
+		return NULL;
+
+	return nma_ethernet_dialog_new (connection);
+}
+
 NMADeviceClass *
 applet_device_ethernet_get_class (NMApplet *applet)
 {
@@ -497,6 +514,7 @@ applet_device_ethernet_get_class (NMApplet *applet)
 	dclass->get_icon = ethernet_get_icon;
 	dclass->get_secrets = ethernet_get_secrets;
 	dclass->secrets_request_size = MAX (sizeof (NM8021xInfo), sizeof (NMPppoeInfo));
+	dclass->new_secrets_dialog = ethernet_new_secrets_dialog;
 
 	return dclass;
 }
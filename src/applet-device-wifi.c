@@ -20,157 +20,30 @@
 #include "nma-wifi-dialog.h"
 #include "mobile-helpers.h"
 
-#define ACTIVE_AP_TAG "active-ap"
-
 static void wifi_dialog_response_cb (GtkDialog *dialog, gint response, gpointer user_data);
 
 static NMAccessPoint *update_active_ap (NMDevice *device, NMDeviceState state, NMApplet *applet);
 
 /*****************************************************************************/
 
-typedef struct {
-	NMApplet *applet;
-	NMDevice *device;
-	NMAccessPoint *ap;
-	gulong signal_id;
-} ActiveAPData;
-
-static void _active_ap_set (NMApplet *applet, NMDevice *device, NMAccessPoint *ap);
-static void _active_ap_set_weakref (gpointer data, GObject *where_the_object_was);
-
-static void
-_active_ap_set_notify (NMAccessPoint *ap, GParamSpec *pspec, gpointer user_data)
-{
-	ActiveAPData *d = user_data;
-
-	g_return_if_fail (NM_IS_ACCESS_POINT (ap));
-	g_return_if_fail (d);
-	g_return_if_fail (NM_IS_APPLET (d->applet));
-	g_return_if_fail (NM_IS_DEVICE (d->device));
-	g_return_if_fail (d->ap == ap);
-	g_return_if_fail (d->signal_id);
-
-	applet_schedule_update_icon (d->applet);
-}
-
-static void
-_active_ap_data_free (ActiveAPData *d)
-{
-	if (d->device)
-		g_object_weak_unref ((GObject *) d->device, _active_ap_set_weakref, d);
-	if (d->ap) {
-		g_object_weak_unref ((GObject *) d->ap, _active_ap_set_weakref, d);
-		g_signal_handler_disconnect (d->ap, d->signal_id);
-	}
-	g_slice_free (ActiveAPData, d);
-}
-
 static NMAccessPoint *
 _active_ap_get (NMApplet *applet, NMDevice *device)
 {
-	GSList *list, *iter;
+	AppletObjectData *data;
 
 	g_return_val_if_fail (NM_IS_APPLET (applet), NULL);
 	g_return_val_if_fail (NM_IS_DEVICE (device), NULL);
 
-	list = g_object_get_data ((GObject *) applet, ACTIVE_AP_TAG);
-	for (iter = list; iter; iter = iter->next) {
-		ActiveAPData *d = iter->data;
-
-		if (device == d->device && d->ap)
-			return d->ap;
-	}
-	return NULL;
-}
-
-static void
-_active_ap_set_destroy (gpointer data)
-{
-	g_slist_free_full (data, (GDestroyNotify) _active_ap_data_free);
+	data = applet_object_data_lookup (applet, device);
+	return data ? data->active_ap : NULL;
 }
 
-static void
-_active_ap_set_weakref (gpointer data, GObject *where_the_object_was)
+static const char *
+ap_get_hash (NMApplet *applet, NMAccessPoint *ap)
 {
-	ActiveAPData *d = data;
-	NMApplet *applet = d->applet;
+	AppletObjectData *data = applet_object_data_lookup (applet, ap);
 
-	if ((GObject *) d->ap == where_the_object_was)
-		d->ap = NULL;
-	else if ((GObject *) d->device == where_the_object_was)
-		d->device = NULL;
-	else
-		g_return_if_reached ();
-	_active_ap_set (applet, NULL, NULL);
-
-	applet_schedule_update_icon (applet);
-}
-
-static void
-_active_ap_set (NMApplet *applet, NMDevice *device, NMAccessPoint *ap)
-{
-	GSList *list, *iter, *list0, *pcurrent;
-	ActiveAPData *d;
-
-	g_return_if_fail (NM_IS_APPLET (applet));
-	g_return_if_fail (!device || NM_IS_DEVICE (device));
-	g_return_if_fail (!ap || NM_IS_ACCESS_POINT (ap));
-
-	list0 = g_object_get_data ((GObject *) applet, ACTIVE_AP_TAG);
-	list = list0;
-
-remove_empty:
-	pcurrent = NULL;
-	for (iter = list; iter; iter = iter->next) {
-		d = iter->data;
-		if (!d->device || !d->ap) {
-			_active_ap_data_free (d);
-			list = g_slist_delete_link (list, iter);
-			goto remove_empty;
-		}
-		if (device && d->device == device)
-			pcurrent = iter;
-	}
-
-	if (!device)
-		goto out;
-
-	if (!ap) {
-		if (pcurrent) {
-			_active_ap_data_free (pcurrent->data);
-			list = g_slist_delete_link (list, pcurrent);
-		}
-		goto out;
-	}
-
-	if (pcurrent) {
-		d = pcurrent->data;
-
-		if (d->ap == ap)
-			goto out;
-		g_object_weak_unref ((GObject *) d->ap, _active_ap_set_weakref, d);
-		g_signal_handler_disconnect (d->ap, d->signal_id);
-	} else {
-		d = g_slice_new (ActiveAPData);
-
-		d->applet = applet;
-		d->device = device;
-		g_object_weak_ref ((GObject *) device, _active_ap_set_weakref, d);
-		list = g_slist_append (list, d);
-	}
-	d->ap = ap;
-	g_object_weak_ref ((GObject *) ap, _active_ap_set_weakref, d);
-	d->signal_id = g_signal_connect (ap,
-	                                 "notify::" NM_ACCESS_POINT_STRENGTH,
-	                                 G_CALLBACK (_active_ap_set_notify),
-	                                 d);
-
-out:
-	if (list0 != list) {
-		g_object_replace_data ((GObject *) applet, ACTIVE_AP_TAG,
-		                       list0, list,
-		                       _active_ap_set_destroy, NULL);
-	}
+	return data ? data->ap_hash : NULL;
 }
 
 /*****************************************************************************/
@@ -565,7 +438,7 @@ wifi_menu_item_activate (GtkMenuItem *item, gpointer user_data)
 struct dup_data {
 	NMDevice *device;
 	NMNetworkMenuItem *found;
-	char *hash;
+	const char *hash;
 };
 
 static void
@@ -583,8 +456,8 @@ find_duplicate (gpointer d, gpointer user_data)
 	if (data->found || !NM_IS_NETWORK_MENU_ITEM (widget))
 		return;
 
-	device = g_object_get_data (G_OBJECT (widget), "device");
-	if (NM_DEVICE (device) != data->device)
+	device = nm_network_menu_item_get_device (NM_NETWORK_MENU_ITEM (widget));
+	if (device != data->device)
 		return;
 
 	hash = nm_network_menu_item_get_hash (NM_NETWORK_MENU_ITEM (widget));
@@ -610,11 +483,11 @@ create_new_ap_item (NMDeviceWifi *device,
 	g_ptr_array_unref (dev_connections);
 
 	item = nm_network_menu_item_new (ap,
+	                                 NM_DEVICE (device),
 	                                 nm_device_wifi_get_capabilities (device),
 	                                 dup_data->hash,
 	                                 ap_connections->len != 0,
 	                                 applet);
-	g_object_set_data (G_OBJECT (item), "device", NM_DEVICE (device));
 
 	/* If there's only one connection, don't show the submenu */
 	if (ap_connections->len > 1) {
@@ -694,7 +567,7 @@ get_menu_item_for_ap (NMDeviceWifi *device,
 	 * menu item's duplicate list.
 	 */
 	dup_data.found = NULL;
-	dup_data.hash = g_object_get_data (G_OBJECT (ap), "hash");
+	dup_data.hash = ap_get_hash (applet, ap);
 	g_return_val_if_fail (dup_data.hash != NULL, NULL);
 
 	dup_data.device = NM_DEVICE (device);
@@ -951,16 +824,16 @@ notify_active_ap_changed_cb (NMDeviceWifi *device,
 }
 
 static void
-add_hash_to_ap (NMAccessPoint *ap)
+add_hash_to_ap (NMApplet *applet, NMAccessPoint *ap)
 {
-	char *hash;
-
-	hash = utils_hash_ap (nm_access_point_get_ssid (ap),
-	                      nm_access_point_get_mode (ap),
-	                      nm_access_point_get_flags (ap),
-	                      nm_access_point_get_wpa_flags (ap),
-	                      nm_access_point_get_rsn_flags (ap));
-	g_object_set_data_full (G_OBJECT (ap), "hash", hash, (GDestroyNotify) g_free);
+	AppletObjectData *data = applet_object_data_get (applet, ap);
+
+	g_free (data->ap_hash);
+	data->ap_hash = utils_hash_ap (nm_access_point_get_ssid (ap),
+	                               nm_access_point_get_mode (ap),
+	                               nm_access_point_get_flags (ap),
+	                               nm_access_point_get_wpa_flags (ap),
+	                               nm_access_point_get_rsn_flags (ap));
 }
 
 static void
@@ -976,7 +849,7 @@ notify_ap_prop_changed_cb (NMAccessPoint *ap,
 	    || !strcmp (prop, NM_ACCESS_POINT_SSID)
 	    || !strcmp (prop, NM_ACCESS_POINT_FREQUENCY)
 	    || !strcmp (prop, NM_ACCESS_POINT_MODE)) {
-		add_hash_to_ap (ap);
+		add_hash_to_ap (applet, ap);
 	}
 }
 
@@ -987,10 +860,107 @@ struct ap_notification_data
 	guint id;
 	gulong last_notification_time;
 	guint new_con_id;
+	guint removed_con_id;
+
+	/* Whether there's an autoconnect connection for an AP, by AP fingerprint;
+	 * valid as long as the connections don't change.
+	 */
+	GHashTable *ap_index;
+	/* All connections, watched for changes while ap_index is in use */
+	GPtrArray *all_connections;
+	/* The connections compatible with the device */
+	GPtrArray *connections;
 };
 
+enum {
+	AP_INDEX_NO_AUTOCONNECT = 1,
+	AP_INDEX_AUTOCONNECT,
+};
+
+static void
+ap_index_clear (struct ap_notification_data *data)
+{
+	guint i;
+
+	if (data->ap_index)
+		g_hash_table_remove_all (data->ap_index);
+
+	if (data->all_connections) {
+		for (i = 0; i < data->all_connections->len; i++)
+			g_signal_handlers_disconnect_by_data (data->all_connections->pdata[i], data);
+		g_clear_pointer (&data->all_connections, g_ptr_array_unref);
+	}
+	g_clear_pointer (&data->connections, g_ptr_array_unref);
+}
+
+static void
+ap_index_connection_changed (NMConnection *connection, gpointer user_data)
+{
+	ap_index_clear (user_data);
+}
+
+/* The AP properties nm_access_point_connection_valid() looks at */
+static char *
+ap_index_fingerprint (NMApplet *applet, NMAccessPoint *ap)
+{
+	return g_strdup_printf ("%s/%s/%u",
+	                        ap_get_hash (applet, ap),
+	                        nm_access_point_get_bssid (ap) ?: "",
+	                        nm_access_point_get_frequency (ap));
+}
+
+static gboolean
+ap_index_has_autoconnect (struct ap_notification_data *data, NMAccessPoint *ap)
+{
+	char *fingerprint;
+	GPtrArray *ap_connections;
+	gboolean is_autoconnect = FALSE;
+	guint i;
+
+	if (!data->connections) {
+		data->all_connections = applet_get_all_connections (data->applet);
+		for (i = 0; i < data->all_connections->len; i++) {
+			g_signal_connect (data->all_connections->pdata[i], NM_CONNECTION_CHANGED,
+			                  G_CALLBACK (ap_index_connection_changed), data);
+		}
+		data->connections = nm_device_filter_connections (NM_DEVICE (data->device),
+		                                                  data->all_connections);
+	}
+	if (!data->ap_index)
+		data->ap_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	fingerprint = ap_index_fingerprint (data->applet, ap);
+	switch (GPOINTER_TO_UINT (g_hash_table_lookup (data->ap_index, fingerprint))) {
+	case AP_INDEX_AUTOCONNECT:
+		g_free (fingerprint);
+		return TRUE;
+	case AP_INDEX_NO_AUTOCONNECT:
+		g_free (fingerprint);
+		return FALSE;
+	}
+
+	ap_connections = nm_access_point_filter_connections (ap, data->connections);
+	for (i = 0; i < ap_connections->len; i++) {
+		NMConnection *connection = NM_CONNECTION (ap_connections->pdata[i]);
+		NMSettingConnection *s_con;
+
+		s_con = nm_connection_get_setting_connection (connection);
+		if (nm_setting_connection_get_autoconnect (s_con))  {
+			is_autoconnect = TRUE;
+			break;
+		}
+	}
+	g_ptr_array_unref (ap_connections);
+
+	g_hash_table_insert (data->ap_index, fingerprint,
+	                     GUINT_TO_POINTER (is_autoconnect ? AP_INDEX_AUTOCONNECT : AP_INDEX_NO_AUTOCONNECT));
+	return is_autoconnect;
+}
+
 /* Scan the list of access points, looking for the case where we have no
  * known (i.e. autoconnect) access points, but we do have unknown ones.
+ * Only the APs not seen since the connections last changed are matched
+ * against the connections.
  * 
  * If we find one, notify the user.
  */
@@ -1002,8 +972,6 @@ idle_check_avail_access_point_notification (gpointer datap)
 	NMDeviceWifi *device = data->device;
 	int i;
 	const GPtrArray *aps;
-	GPtrArray *all_connections;
-	GPtrArray *connections;
 	GTimeVal timeval;
 	gboolean have_unused_access_point = FALSE;
 	gboolean have_no_autoconnect_points = TRUE;
@@ -1020,40 +988,24 @@ idle_check_avail_access_point_notification (gpointer datap)
 	if ((timeval.tv_sec - data->last_notification_time) < 60*60) /* Notify at most once an hour */
 		return FALSE;	
 
-	all_connections = applet_get_all_connections (applet);
-	connections = nm_device_filter_connections (NM_DEVICE (device), all_connections);
-	g_ptr_array_unref (all_connections);	
-
 	aps = nm_device_wifi_get_access_points (device);
-	for (i = 0; i < aps->len; i++) {
+	for (i = 0; aps && i < aps->len; i++) {
 		NMAccessPoint *ap = aps->pdata[i];
-		GPtrArray *ap_connections;
-		int a;
-		gboolean is_autoconnect = FALSE;
 
 		if (!nm_access_point_get_ssid (ap))
 			continue;
 
-		ap_connections = nm_access_point_filter_connections (ap, connections);
-
-		for (a = 0; a < ap_connections->len; a++) {
-			NMConnection *connection = NM_CONNECTION (ap_connections->pdata[a]);
-			NMSettingConnection *s_con;
-
-			s_con = nm_connection_get_setting_connection (connection);
-			if (nm_setting_connection_get_autoconnect (s_con))  {
-				is_autoconnect = TRUE;
-				break;
-			}
-		}
-		g_ptr_array_unref (ap_connections);
-
-		if (!is_autoconnect)
+		if (!ap_index_has_autoconnect (data, ap))
 			have_unused_access_point = TRUE;
-		else
+		else {
 			have_no_autoconnect_points = FALSE;
+			break;
+		}
 	}
-	g_ptr_array_unref (connections);
+
+	/* Forget the APs that went away or changed */
+	if (data->ap_index && g_hash_table_size (data->ap_index) > 2 * (aps ? aps->len : 0) + 16)
+		g_hash_table_remove_all (data->ap_index);
 
 	if (!(have_unused_access_point && have_no_autoconnect_points))
 		return FALSE;
@@ -1072,16 +1024,17 @@ idle_check_avail_access_point_notification (gpointer datap)
 }
 
 static void
-queue_avail_access_point_notification (NMDevice *device)
+queue_avail_access_point_notification (NMDevice *device, NMApplet *applet)
 {
+	AppletObjectData *object_data;
 	struct ap_notification_data *data;
 
-	data = g_object_get_data (G_OBJECT (device), "notify-wifi-avail-data");	
-	if (data->id != 0)
+	object_data = applet_object_data_lookup (applet, device);
+	data = object_data ? object_data->device_data : NULL;
+	if (!data || data->id != 0)
 		return;
 
-	if (g_settings_get_boolean (data->applet->gsettings,
-	                            PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE))
+	if (applet_notification_pref_get (data->applet, PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE))
 		return;
 
 	data->id = g_timeout_add_seconds (3, idle_check_avail_access_point_notification, data);
@@ -1094,13 +1047,13 @@ access_point_added_cb (NMDeviceWifi *device,
 {
 	NMApplet *applet = NM_APPLET  (user_data);
 
-	add_hash_to_ap (ap);
+	add_hash_to_ap (applet, ap);
 	g_signal_connect (G_OBJECT (ap),
 	                  "notify",
 	                  G_CALLBACK (notify_ap_prop_changed_cb),
 	                  applet);
 
-	queue_avail_access_point_notification (NM_DEVICE (device));
+	queue_avail_access_point_notification (NM_DEVICE (device), applet);
 	applet_schedule_update_menu (applet);
 }
 
@@ -1112,12 +1065,10 @@ access_point_removed_cb (NMDeviceWifi *device,
 	NMApplet *applet = NM_APPLET  (user_data);
 	NMAccessPoint *old;
 
-	/* If this AP was the active AP, make sure ACTIVE_AP_TAG gets cleared from
-	 * its device.
-	 */
+	/* If this AP was the active AP, make sure it gets cleared from its device */
 	old = _active_ap_get (applet, (NMDevice *) device);
 	if (old == ap) {
-		_active_ap_set (applet, (NMDevice *) device, NULL);
+		applet_object_data_set_active_ap (applet, (NMDevice *) device, NULL);
 		applet_schedule_update_icon (applet);
 	}
 
@@ -1130,7 +1081,17 @@ on_new_connection (NMClient *client,
                    gpointer datap)
 {
 	struct ap_notification_data *data = datap;
-	queue_avail_access_point_notification (NM_DEVICE (data->device));
+
+	ap_index_clear (data);
+	queue_avail_access_point_notification (NM_DEVICE (data->device), data->applet);
+}
+
+static void
+on_connection_removed (NMClient *client,
+                       NMRemoteConnection *connection,
+                       gpointer datap)
+{
+	ap_index_clear (datap);
 }
 
 static void
@@ -1140,9 +1101,13 @@ free_ap_notification_data (gpointer user_data)
 	NMClient *client = data->applet->nm_client;
 
 	nm_clear_g_source (&data->id);
+	ap_index_clear (data);
+	g_clear_pointer (&data->ap_index, g_hash_table_unref);
 
-	if (client)
+	if (client) {
 		g_signal_handler_disconnect (client, data->new_con_id);
+		g_signal_handler_disconnect (client, data->removed_con_id);
+	}
 	memset (data, 0, sizeof (*data));
 	g_free (data);
 }
@@ -1186,15 +1151,19 @@ wifi_device_added (NMDevice *device, NMApplet *applet)
 	                       G_CALLBACK (on_new_connection),
 	                       data);
 	data->new_con_id = id;
-	g_object_set_data_full (G_OBJECT (wdev), "notify-wifi-avail-data",
-	                        data, free_ap_notification_data);
+	data->removed_con_id = g_signal_connect (applet->nm_client,
+	                                         NM_CLIENT_CONNECTION_REMOVED,
+	                                         G_CALLBACK (on_connection_removed),
+	                                         data);
+	applet_object_data_set_device_data (applet_object_data_get (applet, wdev),
+	                                    data, free_ap_notification_data);
 
-	queue_avail_access_point_notification (device);
+	queue_avail_access_point_notification (device, applet);
 
 	/* Hash all APs this device knows about */
 	aps = nm_device_wifi_get_access_points (wdev);
 	for (i = 0; aps && (i < aps->len); i++)
-		add_hash_to_ap (g_ptr_array_index (aps, i));
+		add_hash_to_ap (applet, g_ptr_array_index (aps, i));
 }
 
 static NMAccessPoint *
@@ -1210,7 +1179,7 @@ update_active_ap (NMDevice *device, NMDeviceState state, NMApplet *applet)
 		new = nm_device_wifi_get_active_access_point (NM_DEVICE_WIFI (device));
 	}
 
-	_active_ap_set (applet, device, new);
+	applet_object_data_set_active_ap (applet, device, new);
 	return new;
 }
 
@@ -1224,7 +1193,7 @@ wifi_device_state_changed (NMDevice *device,
 	update_active_ap (device, new_state, applet);
 
 	if (new_state == NM_DEVICE_STATE_DISCONNECTED)
-		queue_avail_access_point_notification (device);
+		queue_avail_access_point_notification (device, applet);
 }
 
 static void
@@ -1577,19 +1546,25 @@ static gboolean
 wifi_get_secrets (SecretsRequest *req, GError **error)
 {
 	NMWifiInfo *info = (NMWifiInfo *) req;
+	gboolean prewarmed;
 
 	g_return_val_if_fail (!info->dialog, FALSE);
 
-	info->dialog = nma_wifi_dialog_new_for_secrets (req->applet->nm_client,
-	                                                req->connection,
-	                                                req->setting_name,
-	                                                (const char *const*) req->hints);
+	info->dialog = applet_secrets_request_take_prewarmed_dialog (req);
+	prewarmed = !!info->dialog;
+	if (!info->dialog) {
+		info->dialog = nma_wifi_dialog_new_for_secrets (req->applet->nm_client,
+		                                                req->connection,
+		                                                req->setting_name,
+		                                                (const char *const*) req->hints);
+	}
 	if (info->dialog) {
 		applet_secrets_request_set_free_func (req, free_wifi_info);
 		g_signal_connect (info->dialog, "response",
 		                  G_CALLBACK (get_secrets_dialog_response_cb),
 		                  info);
 		show_ignore_focus_stealing_prevention (info->dialog);
+		applet_secrets_request_dialog_shown (req, prewarmed);
 	} else {
 		g_set_error (error,
 		             NM_SECRET_AGENT_ERROR,
@@ -1600,6 +1575,14 @@ wifi_get_secrets (SecretsRequest *req, GError **error)
 	return !!info->dialog;
 }
 
+static GtkWidget *
+wifi_new_secrets_dialog (NMConnection *connection,
+                         const char *setting_name,
+                         NMApplet *applet)
+{
+	return nma_wifi_dialog_new_for_secrets (applet->nm_client, connection, setting_name, NULL);
+}
+
 NMADeviceClass *
 applet_device_wifi_get_class (NMApplet *applet)
 {
@@ -1617,6 +1600,7 @@ applet_device_wifi_get_class (NMApplet *applet)
 	dclass->get_icon = wifi_get_icon;
 	dclass->get_secrets = wifi_get_secrets;
 	dclass->secrets_request_size = sizeof (NMWifiInfo);
+	dclass->new_secrets_dialog = wifi_new_secrets_dialog;
 
 	return dclass;
 }
@@ -468,26 +468,558 @@ _got_wsec_secrets (GObject *source_object, GAsyncResult *res, gpointer user_data
 	                    nm_setting_wireless_security_get_psk (s_wsec));
 }
 
+/* Interface statistics: the counters of all pages are sampled with one
+ * read of /proc/net/dev per second, only while the dialog is visible.
+ */
+#define INFO_STATS_TAG     "info-stats"
+#define INFO_STATS_HISTORY 60
+
+typedef struct {
+	char *iface;
+	GtkWidget *rx_label;
+	GtkWidget *tx_label;
+	GtkWidget *graph;
+
+	guint64 rx_bytes;
+	guint64 tx_bytes;
+	gint64 last_time;
+
+	/* Rates in bytes/s, a ring buffer with the next slot at @head */
+	guint64 rx_rate[INFO_STATS_HISTORY];
+	guint64 tx_rate[INFO_STATS_HISTORY];
+	guint head;
+	guint len;
+} InfoStats;
+
+typedef struct {
+	guint64 rx_bytes, rx_packets, rx_errs, rx_drop;
+	guint64 tx_bytes, tx_packets, tx_errs, tx_drop;
+} InfoStatsCounters;
+
+static void
+info_stats_free (gpointer data)
+{
+	InfoStats *stats = data;
+
+	g_free (stats->iface);
+	g_slice_free (InfoStats, stats);
+}
+
+/* Finds the line of @iface in the contents of /proc/net/dev */
+static gboolean
+info_stats_parse (const char *contents, const char *iface, InfoStatsCounters *c)
+{
+	gsize iface_len = strlen (iface);
+	const char *line, *next, *p;
+	guint64 dummy;
+
+	for (line = contents; line; line = next) {
+		next = strchr (line, '\n');
+		if (next)
+			next++;
+
+		p = line;
+		while (*p == ' ')
+			p++;
+		if (strncmp (p, iface, iface_len) != 0 || p[iface_len] != ':')
+			continue;
+
+		return sscanf (p + iface_len + 1,
+		               "%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+		               " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT
+		               " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT,
+		               &c->rx_bytes, &c->rx_packets, &c->rx_errs, &c->rx_drop,
+		               &dummy, &dummy, &dummy, &dummy,
+		               &c->tx_bytes, &c->tx_packets, &c->tx_errs, &c->tx_drop) == 12;
+	}
+	return FALSE;
+}
+
+static void
+info_stats_set_label (GtkWidget *label, guint64 rate, guint64 packets, guint64 errs, guint64 drop)
+{
+	char *size, *str;
+
+	size = g_format_size (rate);
+	str = g_strdup_printf (_("%s/s (%llu packets, %llu errors, %llu dropped)"),
+	                       size,
+	                       (unsigned long long) packets,
+	                       (unsigned long long) errs,
+	                       (unsigned long long) drop);
+	gtk_label_set_text (GTK_LABEL (label), str);
+	g_free (str);
+	g_free (size);
+}
+
+static void
+info_stats_update (InfoStats *stats, const InfoStatsCounters *c, gint64 now)
+{
+	guint64 rx_rate = 0, tx_rate = 0;
+	gint64 elapsed = now - stats->last_time;
+
+	/* Counters go back to zero when the device gets reset */
+	if (stats->last_time && elapsed > 0) {
+		if (c->rx_bytes >= stats->rx_bytes)
+			rx_rate = (c->rx_bytes - stats->rx_bytes) * G_USEC_PER_SEC / elapsed;
+		if (c->tx_bytes >= stats->tx_bytes)
+			tx_rate = (c->tx_bytes - stats->tx_bytes) * G_USEC_PER_SEC / elapsed;
+
+		stats->rx_rate[stats->head] = rx_rate;
+		stats->tx_rate[stats->head] = tx_rate;
+		stats->head = (stats->head + 1) % INFO_STATS_HISTORY;
+		stats->len = MIN (stats->len + 1, INFO_STATS_HISTORY);
+		gtk_widget_queue_draw (stats->graph);
+	}
+	stats->rx_bytes = c->rx_bytes;
+	stats->tx_bytes = c->tx_bytes;
+	stats->last_time = now;
+
+	info_stats_set_label (stats->rx_label, rx_rate, c->rx_packets, c->rx_errs, c->rx_drop);
+	info_stats_set_label (stats->tx_label, tx_rate, c->tx_packets, c->tx_errs, c->tx_drop);
+}
+
+static gboolean
+info_stats_tick (gpointer user_data)
+{
+	NMApplet *applet = user_data;
+	GtkWidget *dialog;
+	GtkNotebook *notebook;
+	gs_free char *contents = NULL;
+	gint64 now;
+	int i;
+
+	dialog = GTK_WIDGET (gtk_builder_get_object (applet->info_dialog_ui, "info_dialog"));
+	if (!gtk_widget_get_visible (dialog)) {
+		applet->info_stats_id = 0;
+		return G_SOURCE_REMOVE;
+	}
+
+	if (!g_file_get_contents ("/proc/net/dev", &contents, NULL, NULL))
+		return G_SOURCE_CONTINUE;
+	now = g_get_monotonic_time ();
+
+	notebook = GTK_NOTEBOOK (gtk_builder_get_object (applet->info_dialog_ui, "info_notebook"));
+	for (i = 0; i < gtk_notebook_get_n_pages (notebook); i++) {
+		InfoStats *stats;
+		InfoStatsCounters c;
+
+		stats = g_object_get_data (G_OBJECT (gtk_notebook_get_nth_page (notebook, i)), INFO_STATS_TAG);
+		if (stats && info_stats_parse (contents, stats->iface, &c))
+			info_stats_update (stats, &c, now);
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+info_stats_start (NMApplet *applet)
+{
+	if (applet->info_stats_id)
+		return;
+
+	info_stats_tick (applet);
+	applet->info_stats_id = g_timeout_add_seconds (1, info_stats_tick, applet);
+}
+
+static gboolean
+info_stats_draw (GtkWidget *widget, cairo_t *cr, gpointer user_data)
+{
+	InfoStats *stats = user_data;
+	GtkStyleContext *context;
+	GdkRGBA color;
+	double width, height;
+	guint64 max = 1;
+	guint i, n;
+
+	if (!stats->len)
+		return FALSE;
+
+	for (i = 0; i < stats->len; i++) {
+		max = MAX (max, stats->rx_rate[i]);
+		max = MAX (max, stats->tx_rate[i]);
+	}
+
+	width = gtk_widget_get_allocated_width (widget);
+	height = gtk_widget_get_allocated_height (widget);
+	context = gtk_widget_get_style_context (widget);
+	gtk_style_context_get_color (context, gtk_widget_get_state_flags (widget), &color);
+	cairo_set_line_width (cr, 1.0);
+
+	/* Received solid, sent dashed; the newest sample on the right */
+	for (n = 0; n < 2; n++) {
+		const guint64 *rate = n == 0 ? stats->rx_rate : stats->tx_rate;
+		double dash = 3.0;
+
+		cairo_set_dash (cr, &dash, n == 0 ? 0 : 1, 0);
+		gdk_cairo_set_source_rgba (cr, &color);
+		for (i = 0; i < stats->len; i++) {
+			guint idx = (stats->head + INFO_STATS_HISTORY - stats->len + i) % INFO_STATS_HISTORY;
+			double x = width - (stats->len - 1 - i) * width / (INFO_STATS_HISTORY - 1);
+			double y = height - 0.5 - (height - 1) * rate[idx] / max;
+
+			if (i == 0)
+				cairo_move_to (cr, x, y);
+			else
+				cairo_line_to (cr, x, y);
+		}
+		cairo_stroke (cr);
+	}
+
+	return FALSE;
+}
+
+static void
+display_stats_info (NMDevice *device, GtkWidget *page, GtkGrid *grid, int *row)
+{
+	InfoStats *stats;
+	GtkWidget *desc_widget, *data_widget;
+	AtkObject *desc_object, *data_object;
+	const char *iface;
+
+	iface = nm_device_get_ip_iface (device) ?: nm_device_get_iface (device);
+	if (!iface)
+		return;
+
+	stats = g_slice_new0 (InfoStats);
+	stats->iface = g_strdup (iface);
+	g_object_set_data_full (G_OBJECT (page), INFO_STATS_TAG, stats, info_stats_free);
+
+	gtk_grid_attach (grid, gtk_label_new (""), 0, *row, 2, 1);
+	(*row)++;
+	gtk_grid_attach (grid, create_info_group_label (_("Statistics"), FALSE), 0, *row, 2, 1);
+	(*row)++;
+
+	desc_widget = create_info_label (_("Received"));
+	desc_object = gtk_widget_get_accessible (desc_widget);
+	data_widget = stats->rx_label = create_info_value ("\xe2\x80\x94" /* em dash */);
+	data_object = gtk_widget_get_accessible (data_widget);
+	atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
+	gtk_grid_attach (grid, desc_widget, 0, *row, 1, 1);
+	gtk_grid_attach (grid, data_widget, 1, *row, 1, 1);
+	(*row)++;
+
+	desc_widget = create_info_label (_("Sent"));
+	desc_object = gtk_widget_get_accessible (desc_widget);
+	data_widget = stats->tx_label = create_info_value ("\xe2\x80\x94" /* em dash */);
+	data_object = gtk_widget_get_accessible (data_widget);
+	atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
+	gtk_grid_attach (grid, desc_widget, 0, *row, 1, 1);
+	gtk_grid_attach (grid, data_widget, 1, *row, 1, 1);
+	(*row)++;
+
+	desc_widget = create_info_label (_("Last Minute"));
+	desc_object = gtk_widget_get_accessible (desc_widget);
+	data_widget = stats->graph = gtk_drawing_area_new ();
+	gtk_widget_set_size_request (data_widget, -1, 48);
+	gtk_widget_set_tooltip_text (data_widget, _("Received (solid) and sent (dashed) data rate"));
+	g_signal_connect (data_widget, "draw", G_CALLBACK (info_stats_draw), stats);
+	data_object = gtk_widget_get_accessible (data_widget);
+	atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
+	gtk_grid_attach (grid, desc_widget, 0, *row, 1, 1);
+	gtk_grid_attach (grid, data_widget, 1, *row, 1, 1);
+	(*row)++;
+}
+
+/* A page of the dialog, bound to an active connection. The page is built
+ * once; its IPv4 and IPv6 sections get rebuilt when the device's (or the
+ * VPN's) IP configuration changes. While the dialog is hidden the changes
+ * are only recorded, and applied the next time it's shown.
+ */
+typedef struct _InfoDialogData InfoDialogData;
+
+enum {
+	INFO_PAGE_IP4 = (1 << 0),
+	INFO_PAGE_IP6 = (1 << 1),
+};
+
+typedef struct {
+	InfoDialogData *data;
+	NMActiveConnection *active;
+
+	/* Only set while the page is shown */
+	GtkWidget *page;
+	GtkWidget *ip4_grid;
+	GtkWidget *ip6_grid;
+	NMDevice *device;
+	GObject *config_source;
+	NMIPConfig *ip4_config;
+	NMIPConfig *ip6_config;
+	guint dirty;
+} InfoPage;
+
+struct _InfoDialogData {
+	NMApplet *applet;
+	GHashTable *pages;
+	gulong ac_added_id;
+	gulong ac_removed_id;
+	guint sync_id;
+};
+
+static void info_dialog_schedule_sync (InfoDialogData *data);
+
+static GtkGrid *
+info_page_grid_new (void)
+{
+	GtkGrid *grid;
+
+	grid = GTK_GRID (gtk_grid_new ());
+	gtk_grid_set_column_spacing (grid, 12);
+	gtk_grid_set_row_spacing (grid, 6);
+	gtk_grid_set_column_homogeneous (grid, TRUE);
+	return grid;
+}
+
+static void
+info_page_grid_clear (GtkWidget *grid)
+{
+	gtk_container_foreach (GTK_CONTAINER (grid), (GtkCallback) gtk_widget_destroy, NULL);
+}
+
+static void
+info_page_fill_ip4 (InfoPage *page, GtkGrid *grid)
+{
+	NMIPAddress *def_addr = NULL;
+	GPtrArray *addresses = NULL;
+	const char *gateway = NULL;
+	const char * const *dns;
+	GtkWidget *desc_widget, *data_widget;
+	AtkObject *desc_object, *data_object;
+	int row = 0;
+
+	/* Empty line */
+	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
+	row++;
+
+	gtk_grid_attach (grid, create_info_group_label (_("IPv4"), FALSE), 0, row, 2, 1);
+	row++;
+
+	if (page->ip4_config) {
+		addresses = nm_ip_config_get_addresses (page->ip4_config);
+		gateway = nm_ip_config_get_gateway (page->ip4_config);
+	}
+
+	if (addresses && addresses->len > 0)
+		def_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
+
+	display_ip4_info (def_addr, addresses, grid, &row);
+
+	/* Gateway */
+	if (page->device && gateway && *gateway) {
+		desc_widget = create_info_label (_("Default Route"));
+		desc_object = gtk_widget_get_accessible (desc_widget);
+		data_widget = create_info_value (gateway);
+		data_object = gtk_widget_get_accessible (data_widget);
+		atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
+
+		gtk_grid_attach (grid, desc_widget, 0, row, 1, 1);
+		gtk_grid_attach (grid, data_widget, 1, row, 1, 1);
+		row++;
+	}
+
+	/* DNS */
+	dns = def_addr ? nm_ip_config_get_nameservers (page->ip4_config) : NULL;
+	display_dns_info (dns, grid, &row);
+
+	gtk_widget_show_all (GTK_WIDGET (grid));
+}
+
+static void
+info_page_fill_ip6 (InfoPage *page, GtkGrid *grid)
+{
+	NMConnection *connection = NM_CONNECTION (nm_active_connection_get_connection (page->active));
+	NMSettingIPConfig *s_ip;
+	const char *method = NULL;
+	NMIPAddress *def6_addr = NULL;
+	GPtrArray *addresses = NULL;
+	const char *gateway = NULL;
+	const char * const *dns6;
+	GtkWidget *desc_widget, *data_widget;
+	AtkObject *desc_object, *data_object;
+	int row = 0;
+
+	s_ip = nm_connection_get_setting_ip6_config (connection);
+	if (s_ip)
+		method = nm_setting_ip_config_get_method (s_ip);
+
+	if (!method || strcmp (method, NM_SETTING_IP6_CONFIG_METHOD_IGNORE) == 0)
+		return;
+	if (!page->device && !page->ip6_config)
+		return;
+
+	/* Empty line */
+	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
+	row++;
+
+	gtk_grid_attach (grid, create_info_group_label (_("IPv6"), FALSE), 0, row, 2, 1);
+	row++;
+
+	if (page->ip6_config) {
+		addresses = nm_ip_config_get_addresses (page->ip6_config);
+		gateway = nm_ip_config_get_gateway (page->ip6_config);
+	}
+
+	if (addresses && addresses->len > 0)
+		def6_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
+
+	display_ip6_info (def6_addr, addresses, method, grid, &row);
+
+	/* Gateway */
+	if (page->device && gateway && *gateway) {
+		desc_widget = create_info_label (_("Default Route"));
+		desc_object = gtk_widget_get_accessible (desc_widget);
+		data_widget = create_info_value (gateway);
+		data_object = gtk_widget_get_accessible (data_widget);
+		atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
+
+		gtk_grid_attach (grid, desc_widget, 0, row, 1, 1);
+		gtk_grid_attach (grid, data_widget, 1, row, 1, 1);
+		row++;
+	}
+
+	/* DNS */
+	dns6 = def6_addr ? nm_ip_config_get_nameservers (page->ip6_config) : NULL;
+	display_dns_info (dns6, grid, &row);
+
+	gtk_widget_show_all (GTK_WIDGET (grid));
+}
+
+static void
+info_page_ip4_config_changed (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	InfoPage *page = user_data;
+
+	page->dirty |= INFO_PAGE_IP4;
+	info_dialog_schedule_sync (page->data);
+}
+
+static void
+info_page_ip6_config_changed (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	InfoPage *page = user_data;
+
+	page->dirty |= INFO_PAGE_IP6;
+	info_dialog_schedule_sync (page->data);
+}
+
+static void
+info_page_watch_config (InfoPage *page, NMIPConfig **config, NMIPConfig *new_config, GCallback callback)
+{
+	if (*config == new_config)
+		return;
+
+	if (*config) {
+		g_signal_handlers_disconnect_by_data (*config, page);
+		g_object_unref (*config);
+	}
+	*config = new_config;
+	if (new_config) {
+		g_object_ref (new_config);
+		g_signal_connect (new_config, "notify", callback, page);
+	}
+}
+
+static void
+info_page_configs_changed (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	InfoPage *page = user_data;
+
+	if (page->device) {
+		info_page_watch_config (page, &page->ip4_config, nm_device_get_ip4_config (page->device),
+		                        G_CALLBACK (info_page_ip4_config_changed));
+		info_page_watch_config (page, &page->ip6_config, nm_device_get_ip6_config (page->device),
+		                        G_CALLBACK (info_page_ip6_config_changed));
+	} else {
+		info_page_watch_config (page, &page->ip4_config, nm_active_connection_get_ip4_config (page->active),
+		                        G_CALLBACK (info_page_ip4_config_changed));
+		info_page_watch_config (page, &page->ip6_config, nm_active_connection_get_ip6_config (page->active),
+		                        G_CALLBACK (info_page_ip6_config_changed));
+	}
+
+	if (object) {
+		page->dirty |= INFO_PAGE_IP4 | INFO_PAGE_IP6;
+		info_dialog_schedule_sync (page->data);
+	}
+}
+
+static void
+info_page_bind (InfoPage *page, GtkWidget *widget, NMDevice *device)
+{
+	page->page = widget;
+	page->device = device ? g_object_ref (device) : NULL;
+	page->config_source = g_object_ref (device ? G_OBJECT (device) : G_OBJECT (page->active));
+
+	/* NM_DEVICE_IP4_CONFIG and NM_ACTIVE_CONNECTION_IP4_CONFIG alike */
+	g_signal_connect (page->config_source, "notify::ip4-config",
+	                  G_CALLBACK (info_page_configs_changed), page);
+	g_signal_connect (page->config_source, "notify::ip6-config",
+	                  G_CALLBACK (info_page_configs_changed), page);
+	info_page_configs_changed (NULL, NULL, page);
+}
+
+static void
+info_page_unbind (InfoPage *page)
+{
+	if (!page->page)
+		return;
+
+	info_page_watch_config (page, &page->ip4_config, NULL, NULL);
+	info_page_watch_config (page, &page->ip6_config, NULL, NULL);
+	g_signal_handlers_disconnect_by_func (page->config_source, info_page_configs_changed, page);
+	g_clear_object (&page->config_source);
+	g_clear_object (&page->device);
+
+	gtk_widget_destroy (page->page);
+	page->page = NULL;
+	page->ip4_grid = NULL;
+	page->ip6_grid = NULL;
+	page->dirty = 0;
+}
+
+static void
+info_page_refresh (InfoPage *page)
+{
+	if (page->dirty & INFO_PAGE_IP4) {
+		info_page_grid_clear (page->ip4_grid);
+		info_page_fill_ip4 (page, GTK_GRID (page->ip4_grid));
+	}
+	if (page->dirty & INFO_PAGE_IP6) {
+		info_page_grid_clear (page->ip6_grid);
+		info_page_fill_ip6 (page, GTK_GRID (page->ip6_grid));
+	}
+	page->dirty = 0;
+}
+
+static GtkWidget *
+info_page_box_new (InfoPage *page, GtkGrid *general)
+{
+	GtkWidget *box;
+
+	box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+	gtk_container_set_border_width (GTK_CONTAINER (box), 12);
+	gtk_box_pack_start (GTK_BOX (box), GTK_WIDGET (general), FALSE, FALSE, 0);
+
+	page->ip4_grid = GTK_WIDGET (info_page_grid_new ());
+	gtk_box_pack_start (GTK_BOX (box), page->ip4_grid, FALSE, FALSE, 0);
+	page->ip6_grid = GTK_WIDGET (info_page_grid_new ());
+	gtk_box_pack_start (GTK_BOX (box), page->ip6_grid, FALSE, FALSE, 0);
+
+	return box;
+}
+
 static void
 info_dialog_add_page (GtkNotebook *notebook,
+                      InfoPage *page,
                       NMConnection *connection,
                       NMDevice *device)
 {
 	GtkGrid *grid;
+	GtkWidget *box;
 	guint32 speed = 0;
 	char *str;
 	const char *iface, *method = NULL;
-	NMIPConfig *ip4_config;
-	NMIPConfig *ip6_config = NULL;
-	const char * const *dns;
-	const char * const *dns6;
-	NMIPAddress *def_addr = NULL;
-	NMIPAddress *def6_addr = NULL;
-	const char *gateway;
 	NMSettingIPConfig *s_ip;
 	int row = 0;
 	GtkWidget* speed_label, *sec_label, *desc_widget, *data_widget = NULL;
-	GPtrArray *addresses;
 	gboolean show_security = FALSE;
 	gboolean is_hotspot = FALSE;
 	NMSettingWireless *s_wireless;
@@ -495,11 +1027,7 @@ info_dialog_add_page (GtkNotebook *notebook,
 	gs_free char *ssid_utf8 = NULL;
 	AtkObject *desc_object, *data_object = NULL;
 
-	grid = GTK_GRID (gtk_grid_new ());
-	gtk_grid_set_column_spacing (grid, 12);
-	gtk_grid_set_row_spacing (grid, 6);
-	gtk_container_set_border_width (GTK_CONTAINER (grid), 12);
-	gtk_grid_set_column_homogeneous (grid, TRUE);
+	grid = info_page_grid_new ();
 
 	/* Interface */
 	iface = nm_device_get_iface (device);
@@ -614,57 +1142,20 @@ info_dialog_add_page (GtkNotebook *notebook,
 		}
 	}
 
-	/* Empty line */
-	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
-	row++;
+	box = info_page_box_new (page, grid);
+	info_page_bind (page, box, device);
 
-	/*--- IPv4 ---*/
+	/*--- IPv4 and IPv6, rebuilt on changes ---*/
+	info_page_fill_ip4 (page, GTK_GRID (page->ip4_grid));
+	info_page_fill_ip6 (page, GTK_GRID (page->ip6_grid));
+
+	/* Wi-Fi */
 	s_ip = nm_connection_get_setting_ip4_config (connection);
 	if (s_ip) {
 		method = nm_setting_ip_config_get_method (s_ip);
 		if (strcmp (method, NM_SETTING_IP4_CONFIG_METHOD_SHARED) == 0)
 			is_hotspot = TRUE;
 	}
-
-	gtk_grid_attach (grid, create_info_group_label (_("IPv4"), FALSE), 0, row, 2, 1);
-	row++;
-
-	ip4_config = nm_device_get_ip4_config (device);
-	if (ip4_config) {
-		addresses = nm_ip_config_get_addresses (ip4_config);
-		gateway = nm_ip_config_get_gateway (ip4_config);
-	} else {
-		addresses = NULL;
-		gateway = NULL;
-	}
-
-	if (addresses && addresses->len > 0)
-		def_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
-
-	display_ip4_info (def_addr, addresses, grid, &row);
-
-	/* Gateway */
-	if (gateway && *gateway) {
-		desc_widget = create_info_label (_("Default Route"));
-		desc_object = gtk_widget_get_accessible (desc_widget);
-		data_widget = create_info_value (gateway);
-		data_object = gtk_widget_get_accessible (data_widget);
-		atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
-
-		gtk_grid_attach (grid, desc_widget, 0, row, 1, 1);
-		gtk_grid_attach (grid, data_widget, 1, row, 1, 1);
-		row++;
-	}
-
-	/* DNS */
-	dns = def_addr ? nm_ip_config_get_nameservers (ip4_config) : NULL;
-	display_dns_info (dns, grid, &row);
-
-	/* Empty line */
-	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
-	row++;
-
-	/*--- IPv6 ---*/
 	s_ip = nm_connection_get_setting_ip6_config (connection);
 	if (s_ip) {
 		method = nm_setting_ip_config_get_method (s_ip);
@@ -672,43 +1163,9 @@ info_dialog_add_page (GtkNotebook *notebook,
 			is_hotspot = TRUE;
 	}
 
-	if (method && strcmp (method, NM_SETTING_IP6_CONFIG_METHOD_IGNORE) != 0) {
-		gtk_grid_attach (grid, create_info_group_label (_("IPv6"), FALSE), 0, row, 2, 1);
-		row++;
-
-		ip6_config = nm_device_get_ip6_config (device);
-		if (ip6_config) {
-			addresses = nm_ip_config_get_addresses (ip6_config);
-			gateway = nm_ip_config_get_gateway (ip6_config);
-		} else {
-			addresses = NULL;
-			gateway = NULL;
-		}
-
-		if (addresses && addresses->len > 0)
-			def6_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
-
-		display_ip6_info (def6_addr, addresses, method, grid, &row);
-	}
+	grid = info_page_grid_new ();
+	row = 0;
 
-	/* Gateway */
-	if (gateway && *gateway) {
-		desc_widget = create_info_label (_("Default Route"));
-		desc_object = gtk_widget_get_accessible (desc_widget);
-		data_widget = create_info_value (gateway);
-		data_object = gtk_widget_get_accessible (data_widget);
-		atk_object_add_relationship (desc_object, ATK_RELATION_LABEL_FOR, data_object);
-
-		gtk_grid_attach (grid, desc_widget, 0, row, 1, 1);
-		gtk_grid_attach (grid, data_widget, 1, row, 1, 1);
-		row++;
-	}
-
-	/* DNS */
-	dns6 = def6_addr ? nm_ip_config_get_nameservers (ip6_config) : NULL;
-	display_dns_info (dns6, grid, &row);
-
-	/* Wi-Fi */
 	if (!NM_IS_DEVICE_WIFI (device))
 		is_hotspot = FALSE;
 	if (is_hotspot) {
@@ -753,15 +1210,18 @@ info_dialog_add_page (GtkNotebook *notebook,
 		row++;
 	}
 
+	display_stats_info (device, box, grid, &row);
+	gtk_box_pack_start (GTK_BOX (box), GTK_WIDGET (grid), FALSE, FALSE, 0);
+
 	desc_widget = NULL;
 	desc_object = NULL;
 	data_widget = NULL;
 	data_object = NULL;
 
-	gtk_notebook_append_page (notebook, GTK_WIDGET (grid),
+	gtk_notebook_append_page (notebook, box,
 	                          gtk_label_new (nm_connection_get_id (connection)));
 
-	gtk_widget_show_all (GTK_WIDGET (grid));
+	gtk_widget_show_all (box);
 }
 
 static char *
@@ -835,27 +1295,17 @@ get_vpn_data_item (NMConnection *connection, enum VpnDataItem vpn_data_item)
 
 static void
 info_dialog_add_page_for_vpn (GtkNotebook *notebook,
+                              InfoPage *page,
                               NMConnection *connection,
                               NMActiveConnection *active,
                               NMConnection *parent_con)
 {
 	GtkGrid *grid;
+	GtkWidget *box;
 	char *str;
 	int row = 0;
-	NMIPConfig *ip4_config;
-	NMIPConfig *ip6_config;
-	const char * const *dns;
-	const char * const *dns6;
-	NMIPAddress *def_addr = NULL;
-	NMIPAddress *def6_addr = NULL;
-	GPtrArray *addresses;
-	NMSettingIPConfig *s_ip6;
-	const char *method = NULL;
 
-	grid = GTK_GRID (gtk_grid_new ());
-	gtk_grid_set_column_spacing (grid, 12);
-	gtk_grid_set_row_spacing (grid, 6);
-	gtk_container_set_border_width (GTK_CONTAINER (grid), 12);
+	grid = info_page_grid_new ();
 
 	/*--- General ---*/
 	gtk_grid_attach (grid, create_info_group_label (_("General"), FALSE), 0, row, 2, 1);
@@ -883,57 +1333,17 @@ info_dialog_add_page_for_vpn (GtkNotebook *notebook,
 	gtk_grid_attach (grid, create_info_value (parent_con ? nm_connection_get_id (parent_con) : _("Unknown")), 1, row, 1, 1);
 	row++;
 
-	/* Empty line */
-	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
-	row++;
-
-	/*--- IPv4 ---*/
-	gtk_grid_attach (grid, create_info_group_label (_("IPv4"), FALSE), 0, row, 2, 1);
-	row++;
-
-	ip4_config = nm_active_connection_get_ip4_config (active);
-	addresses = nm_ip_config_get_addresses (ip4_config);
-	if (addresses && addresses->len > 0)
-		def_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
+	box = info_page_box_new (page, grid);
+	info_page_bind (page, box, NULL);
 
-	display_ip4_info (def_addr, addresses, grid, &row);
-
-	/* DNS */
-	dns = def_addr ? nm_ip_config_get_nameservers (ip4_config) : NULL;
-	display_dns_info (dns, grid, &row);
-
-	/* Empty line */
-	gtk_grid_attach (grid, gtk_label_new (""), 0, row, 2, 1);
-	row++;
-
-	/*--- IPv6 ---*/
-	ip6_config = nm_active_connection_get_ip6_config (active);
-	if (ip6_config) {
-		s_ip6 = nm_connection_get_setting_ip6_config (connection);
-		if (s_ip6)
-			 method = nm_setting_ip_config_get_method (s_ip6);
-	}
-
-	if (method && strcmp (method, NM_SETTING_IP6_CONFIG_METHOD_IGNORE) != 0) {
-		gtk_grid_attach (grid, create_info_group_label (_("IPv6"), FALSE), 0, row, 2, 1);
-		row++;
-
-		addresses = nm_ip_config_get_addresses (ip6_config);
-		if (addresses && addresses->len > 0)
-			def6_addr = (NMIPAddress *) g_ptr_array_index (addresses, 0);
-
-		/* IPv6 Address */
-		display_ip6_info (def6_addr, addresses, method, grid, &row);
-
-		/* DNS */
-		dns6 = def6_addr ? nm_ip_config_get_nameservers (ip6_config) : NULL;
-		display_dns_info (dns6, grid, &row);
-	}
+	/*--- IPv4 and IPv6, rebuilt on changes ---*/
+	info_page_fill_ip4 (page, GTK_GRID (page->ip4_grid));
+	info_page_fill_ip6 (page, GTK_GRID (page->ip6_grid));
 
-	gtk_notebook_append_page (notebook, GTK_WIDGET (grid),
+	gtk_notebook_append_page (notebook, box,
 	                          gtk_label_new (nm_connection_get_id (connection)));
 
-	gtk_widget_show_all (GTK_WIDGET (grid));
+	gtk_widget_show_all (box);
 }
 
 #ifndef NM_REMOTE_CONNECTION_FLAGS
@@ -1018,8 +1428,73 @@ _compare_active_connections (gconstpointer a, gconstpointer b)
 	return cmp;
 }
 
-static GtkWidget *
-info_dialog_update (NMApplet *applet)
+static GtkNotebook *
+info_dialog_get_notebook (NMApplet *applet)
+{
+	return GTK_NOTEBOOK (gtk_builder_get_object (applet->info_dialog_ui, "info_notebook"));
+}
+
+static gboolean
+info_dialog_is_visible (NMApplet *applet)
+{
+	return gtk_widget_get_visible (GTK_WIDGET (gtk_builder_get_object (applet->info_dialog_ui, "info_dialog")));
+}
+
+static void
+info_page_free (gpointer user_data)
+{
+	InfoPage *page = user_data;
+
+	info_page_unbind (page);
+	g_signal_handlers_disconnect_by_data (page->active, page);
+	g_object_unref (page->active);
+	g_slice_free (InfoPage, page);
+}
+
+static void
+info_page_state_changed (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	InfoPage *page = user_data;
+
+	info_dialog_schedule_sync (page->data);
+}
+
+static gboolean
+info_page_build (InfoPage *page, GtkNotebook *notebook)
+{
+	NMActiveConnection *active = page->active;
+	NMConnection *connection;
+	const GPtrArray *devices;
+
+	if (nm_active_connection_get_state (active) != NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
+		return FALSE;
+
+	connection = (NMConnection *) nm_active_connection_get_connection (active);
+	if (!connection)
+		return FALSE;
+
+	devices = nm_active_connection_get_devices (active);
+	if (NM_IS_VPN_CONNECTION (active)) {
+		const char *spec_object = nm_active_connection_get_specific_object_path (active);
+		NMConnection *parent_con = get_connection_for_active_path (page->data->applet, spec_object);
+
+		info_dialog_add_page_for_vpn (notebook, page, connection, active, parent_con);
+	} else if (devices && devices->len > 0) {
+		info_dialog_add_page (notebook,
+		                      page,
+		                      connection,
+		                      g_ptr_array_index (devices, 0));
+	} else
+		return FALSE;
+
+	return TRUE;
+}
+
+/* Adds, removes, refreshes and orders the pages as the active connections
+ * are now. Returns the number of pages.
+ */
+static int
+info_dialog_sync (InfoDialogData *data)
 {
 	GtkNotebook *notebook;
 	const GPtrArray *connections;
@@ -1027,14 +1502,8 @@ info_dialog_update (NMApplet *applet)
 	int i;
 	int pages = 0;
 
-	notebook = GTK_NOTEBOOK (GTK_WIDGET (gtk_builder_get_object (applet->info_dialog_ui, "info_notebook")));
-
-	/* Remove old pages */
-	for (i = gtk_notebook_get_n_pages (notebook); i > 0; i--)
-		gtk_notebook_remove_page (notebook, -1);
-
-	/* Add new pages */
-	connections = nm_client_get_active_connections (applet->nm_client);
+	notebook = info_dialog_get_notebook (data->applet);
+	connections = nm_client_get_active_connections (data->applet->nm_client);
 
 	sorted_connections = g_ptr_array_new_full (connections->len, NULL);
 	memcpy (sorted_connections->pdata, connections->pdata,
@@ -1044,60 +1513,137 @@ info_dialog_update (NMApplet *applet)
 
 	for (i = 0; i < sorted_connections->len; i++) {
 		NMActiveConnection *active_connection = g_ptr_array_index (sorted_connections, i);
-		NMConnection *connection;
-		const GPtrArray *devices;
-
-		if (nm_active_connection_get_state (active_connection) != NM_ACTIVE_CONNECTION_STATE_ACTIVATED)
-			continue;
-
-		connection = (NMConnection *) nm_active_connection_get_connection (active_connection);
-		if (!connection) {
-			g_warning ("%s: couldn't find the default active connection's NMConnection!", __func__);
-			continue;
+		InfoPage *page;
+
+		page = g_hash_table_lookup (data->pages, active_connection);
+		if (!page) {
+			page = g_slice_new0 (InfoPage);
+			page->data = data;
+			page->active = g_object_ref (active_connection);
+			g_signal_connect (active_connection, "notify::" NM_ACTIVE_CONNECTION_STATE,
+			                  G_CALLBACK (info_page_state_changed), page);
+			g_hash_table_insert (data->pages, active_connection, page);
 		}
 
-		devices = nm_active_connection_get_devices (active_connection);
-		if (NM_IS_VPN_CONNECTION (active_connection)) {
-			const char *spec_object = nm_active_connection_get_specific_object_path (active_connection);
-			NMConnection *parent_con = get_connection_for_active_path (applet, spec_object);
-
-			info_dialog_add_page_for_vpn (notebook, connection, active_connection, parent_con);
-		} else if (devices && devices->len > 0) {
-				info_dialog_add_page (notebook,
-				                      connection,
-				                      g_ptr_array_index (devices, 0));
-		} else {
-			g_warning ("Active connection %s had no devices and was not a VPN!",
-			           nm_object_get_path (NM_OBJECT (active_connection)));
+		if (nm_active_connection_get_state (active_connection) != NM_ACTIVE_CONNECTION_STATE_ACTIVATED) {
+			info_page_unbind (page);
 			continue;
 		}
 
-		pages++;
-	}
+		if (!page->page) {
+			if (!info_page_build (page, notebook))
+				continue;
+		} else if (page->dirty)
+			info_page_refresh (page);
 
-	if (pages == 0) {
-		/* Shouldn't really happen but ... */
-		info_dialog_show_error (_("No valid active connections found!"));
-		return NULL;
+		gtk_notebook_reorder_child (notebook, page->page, pages++);
 	}
 
-	return GTK_WIDGET (gtk_builder_get_object (applet->info_dialog_ui, "info_dialog"));
+	return pages;
+}
+
+static gboolean
+info_dialog_sync_cb (gpointer user_data)
+{
+	InfoDialogData *data = user_data;
+
+	data->sync_id = 0;
+	info_dialog_sync (data);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+info_dialog_schedule_sync (InfoDialogData *data)
+{
+	/* Catch up when shown again */
+	if (!info_dialog_is_visible (data->applet))
+		return;
+
+	if (!data->sync_id)
+		data->sync_id = g_idle_add (info_dialog_sync_cb, data);
+}
+
+static void
+info_dialog_ac_added (NMClient *client, NMActiveConnection *active, gpointer user_data)
+{
+	info_dialog_schedule_sync (user_data);
+}
+
+static void
+info_dialog_ac_removed (NMClient *client, NMActiveConnection *active, gpointer user_data)
+{
+	InfoDialogData *data = user_data;
+
+	g_hash_table_remove (data->pages, active);
+}
+
+static InfoDialogData *
+info_dialog_data_get (NMApplet *applet)
+{
+	InfoDialogData *data = applet->info_dialog_data;
+	GtkNotebook *notebook;
+
+	if (data)
+		return data;
+
+	/* Drop the placeholder page of the UI file */
+	notebook = info_dialog_get_notebook (applet);
+	while (gtk_notebook_get_n_pages (notebook))
+		gtk_notebook_remove_page (notebook, -1);
+
+	data = g_slice_new0 (InfoDialogData);
+	data->applet = applet;
+	data->pages = g_hash_table_new_full (NULL, NULL, NULL, info_page_free);
+	data->ac_added_id = g_signal_connect (applet->nm_client, NM_CLIENT_ACTIVE_CONNECTION_ADDED,
+	                                      G_CALLBACK (info_dialog_ac_added), data);
+	data->ac_removed_id = g_signal_connect (applet->nm_client, NM_CLIENT_ACTIVE_CONNECTION_REMOVED,
+	                                        G_CALLBACK (info_dialog_ac_removed), data);
+
+	applet->info_dialog_data = data;
+	return data;
+}
+
+void
+applet_info_dialog_free (NMApplet *applet)
+{
+	InfoDialogData *data = applet->info_dialog_data;
+
+	if (!data)
+		return;
+
+	nm_clear_g_source (&data->sync_id);
+	g_signal_handler_disconnect (applet->nm_client, data->ac_added_id);
+	g_signal_handler_disconnect (applet->nm_client, data->ac_removed_id);
+	g_hash_table_destroy (data->pages);
+	g_slice_free (InfoDialogData, data);
+	applet->info_dialog_data = NULL;
 }
 
 void
 applet_info_dialog_show (NMApplet *applet)
 {
 	GtkWidget *dialog;
+	InfoDialogData *data;
 
-	dialog = info_dialog_update (applet);
-	if (!dialog)
+	data = info_dialog_data_get (applet);
+	nm_clear_g_source (&data->sync_id);
+	if (info_dialog_sync (data) == 0) {
+		/* Shouldn't really happen but ... */
+		info_dialog_show_error (_("No valid active connections found!"));
 		return;
+	}
 
-	g_signal_connect (dialog, "delete-event", G_CALLBACK (gtk_widget_hide_on_delete), dialog);
-	g_signal_connect_swapped (dialog, "response", G_CALLBACK (gtk_widget_hide), dialog);
+	dialog = GTK_WIDGET (gtk_builder_get_object (applet->info_dialog_ui, "info_dialog"));
+	if (!g_object_get_data (G_OBJECT (dialog), "info-dialog-setup")) {
+		g_signal_connect (dialog, "delete-event", G_CALLBACK (gtk_widget_hide_on_delete), dialog);
+		g_signal_connect_swapped (dialog, "response", G_CALLBACK (gtk_widget_hide), dialog);
+		g_object_set_data (G_OBJECT (dialog), "info-dialog-setup", GUINT_TO_POINTER (TRUE));
+	}
 	gtk_widget_realize (dialog);
 	gtk_window_set_position (GTK_WINDOW(dialog), GTK_WIN_POS_CENTER_ALWAYS);
 	gtk_window_present (GTK_WINDOW (dialog));
+
+	info_stats_start (applet);
 }
 
 void
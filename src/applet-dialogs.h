@@ -15,6 +15,8 @@
 
 void applet_info_dialog_show (NMApplet *applet);
 
+void applet_info_dialog_free (NMApplet *applet);
+
 void applet_about_dialog_show (NMApplet *applet);
 
 GtkWidget *applet_missing_ui_warning_dialog_show (void);
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#ifndef APPLET_PROBES_H
+#define APPLET_PROBES_H
+
+/* USDT probes of the "nm_applet" provider, for tracing with bpftrace or
+ * SystemTap (see contrib/bpftrace). A probe is a single nop unless it's
+ * traced. Without -Dusdt=true the arguments are not evaluated at all.
+ *
+ *  get_secrets (id, connection path, setting name)
+ *  get_secrets_reply (id, failed)
+ *  secrets_request_complete (id, setting name, failed)
+ *  menu_activate (connection UUID, interface)
+ *  activate_done (connection UUID, failed)
+ *  vpn_state_changed (connection UUID, NMActiveConnectionState, reason)
+ *
+ * Missing strings are passed as NULL.
+ */
+
+#if WITH_USDT
+
+#include <sys/sdt.h>
+
+#define NMA_PROBE2(name, a1, a2)     DTRACE_PROBE2 (nm_applet, name, a1, a2)
+#define NMA_PROBE3(name, a1, a2, a3) DTRACE_PROBE3 (nm_applet, name, a1, a2, a3)
+
+#else
+
+#define NMA_PROBE2(name, a1, a2)     G_STMT_START { } G_STMT_END
+#define NMA_PROBE3(name, a1, a2, a3) G_STMT_START { } G_STMT_END
+
+#endif
+
+#endif /* APPLET_PROBES_H */
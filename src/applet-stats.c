@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#include "nm-default.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "applet-stats.h"
+
+/* Runtime statistics of the applet, for finding leaks and slow paths in
+ * long running sessions. Only exported with --stats, on the session bus
+ * next to the GApplication object; "nm-applet --dump-stats" prints them.
+ */
+
+#define STATS_BUS_NAME    "org.freedesktop.network-manager-applet"
+#define STATS_OBJECT_PATH "/org/freedesktop/network_manager_applet"
+#define STATS_INTERFACE   "org.freedesktop.NetworkManagerApplet.Statistics"
+
+static const char introspection_xml[] =
+	"<node>"
+	"  <interface name='" STATS_INTERFACE "'>"
+	"    <method name='GetStatistics'>"
+	"      <arg type='a{sv}' name='statistics' direction='out'/>"
+	"    </method>"
+	"  </interface>"
+	"</node>";
+
+static guint64
+get_rss (void)
+{
+	gs_free char *contents = NULL;
+	guint64 size, resident;
+
+	if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+		return 0;
+	if (sscanf (contents, "%" G_GUINT64_FORMAT " %" G_GUINT64_FORMAT, &size, &resident) != 2)
+		return 0;
+
+	return resident * sysconf (_SC_PAGESIZE);
+}
+
+static GVariant *
+stats_collect (NMApplet *applet)
+{
+	GVariantBuilder builder;
+	GPtrArray *timers;
+	GHashTableIter iter;
+	gpointer object;
+	guint n_aps = 0, n_devices = 0;
+	guint pending = 0, get_total = 0, get_coalesced = 0;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+#define ADD(key, type, value) \
+	g_variant_builder_add (&builder, "{sv}", key, g_variant_new (type, value))
+
+	/* Not created in the agent-only mode */
+	ADD ("icon-cache", "u", applet->icon_cache ? g_hash_table_size (applet->icon_cache) : 0);
+	ADD ("icon-cache-tray", "u", applet->icon_cache_tray ? g_hash_table_size (applet->icon_cache_tray) : 0);
+
+	ADD ("secrets-requests", "u", g_slist_length (applet->secrets_reqs));
+	if (applet->agent)
+		applet_agent_get_statistics (applet->agent, &pending, &get_total, &get_coalesced);
+	ADD ("agent-requests", "u", pending);
+	ADD ("agent-get-secrets-total", "u", get_total);
+	ADD ("agent-get-secrets-coalesced", "u", get_coalesced);
+
+	timers = g_ptr_array_new ();
+#define ADD_TIMER(field) \
+	G_STMT_START { \
+		if (applet->field) \
+			g_ptr_array_add (timers, (gpointer) #field); \
+	} G_STMT_END
+	ADD_TIMER (animation_id);
+	ADD_TIMER (wifi_scan_id);
+	ADD_TIMER (update_icon_id);
+	ADD_TIMER (update_menu_id);
+	ADD_TIMER (prewarm_id);
+	ADD_TIMER (flap_timeout_id);
+	ADD_TIMER (info_stats_id);
+#undef ADD_TIMER
+	g_variant_builder_add (&builder, "{sv}", "active-timers",
+	                       g_variant_new_strv ((const char *const *) timers->pdata, timers->len));
+	g_ptr_array_free (timers, TRUE);
+
+	ADD ("menu-rebuilds", "u", applet->menu_rebuilds);
+	ADD ("menu-rebuild-usec-total", "x", applet->menu_rebuild_usec);
+	ADD ("menu-rebuild-usec-max", "x", applet->menu_rebuild_max_usec);
+	ADD ("menus-alive", "u", applet->menus_alive);
+
+	g_hash_table_iter_init (&iter, applet->object_data);
+	while (g_hash_table_iter_next (&iter, &object, NULL)) {
+		if (NM_IS_ACCESS_POINT (object))
+			n_aps++;
+		else if (NM_IS_DEVICE (object))
+			n_devices++;
+	}
+	ADD ("tracked-objects", "u", g_hash_table_size (applet->object_data));
+	ADD ("tracked-access-points", "u", n_aps);
+	ADD ("tracked-devices", "u", n_devices);
+
+	ADD ("notifications-dropped", "u", applet->notify_dropped);
+	ADD ("notifications-merged", "u", applet->notify_merged);
+
+	ADD ("rss", "t", get_rss ());
+#undef ADD
+
+	return g_variant_builder_end (&builder);
+}
+
+static void
+method_call (GDBusConnection *connection,
+             const char *sender,
+             const char *object_path,
+             const char *interface_name,
+             const char *method_name,
+             GVariant *parameters,
+             GDBusMethodInvocation *invocation,
+             gpointer user_data)
+{
+	NMApplet *applet = NM_APPLET (user_data);
+
+	if (nm_streq (method_name, "GetStatistics")) {
+		g_dbus_method_invocation_return_value (invocation,
+		                                       g_variant_new ("(@a{sv})", stats_collect (applet)));
+	} else {
+		g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                       "Unknown method %s", method_name);
+	}
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+	method_call,
+	NULL,
+	NULL,
+};
+
+/**
+ * applet_stats_register:
+ * @applet: the applet
+ * @connection: the connection the #GApplication is exported on
+ * @object_path: the object path of the #GApplication
+ * @error: location for the error
+ *
+ * Exports the statistics interface next to the #GApplication object.
+ *
+ * Returns: the registration id to unregister with, or 0 on error
+ */
+guint
+applet_stats_register (NMApplet *applet,
+                       GDBusConnection *connection,
+                       const char *object_path,
+                       GError **error)
+{
+	static GDBusNodeInfo *introspection_data;
+
+	if (!introspection_data)
+		introspection_data = g_dbus_node_info_new_for_xml (introspection_xml, NULL);
+
+	return g_dbus_connection_register_object (connection,
+	                                          object_path,
+	                                          introspection_data->interfaces[0],
+	                                          &interface_vtable,
+	                                          applet,
+	                                          NULL,
+	                                          error);
+}
+
+/**
+ * applet_stats_dump:
+ *
+ * Asks the running applet for its statistics and prints them to stdout,
+ * one "key value" pair per line.
+ *
+ * Returns: the exit status
+ */
+int
+applet_stats_dump (void)
+{
+	gs_free_error GError *error = NULL;
+	gs_unref_object GDBusConnection *bus = NULL;
+	gs_unref_variant GVariant *reply = NULL;
+	gs_unref_variant GVariant *stats = NULL;
+	GVariantIter iter;
+	const char *key;
+	GVariant *value;
+
+	bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+	if (bus) {
+		reply = g_dbus_connection_call_sync (bus,
+		                                     STATS_BUS_NAME,
+		                                     STATS_OBJECT_PATH,
+		                                     STATS_INTERFACE,
+		                                     "GetStatistics",
+		                                     NULL,
+		                                     G_VARIANT_TYPE ("(a{sv})"),
+		                                     G_DBUS_CALL_FLAGS_NO_AUTO_START,
+		                                     -1,
+		                                     NULL,
+		                                     &error);
+	}
+	if (!reply) {
+		fprintf (stderr, _("Could not get the statistics of the running applet (was it started with --stats?): %s\n"),
+		         error->message);
+		return 1;
+	}
+
+	stats = g_variant_get_child_value (reply, 0);
+	g_variant_iter_init (&iter, stats);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		gs_free char *str = NULL;
+
+		if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING_ARRAY)) {
+			gs_free const char **strv = g_variant_get_strv (value, NULL);
+
+			str = g_strjoinv (",", (char **) strv);
+		} else
+			str = g_variant_print (value, FALSE);
+
+		printf ("%s %s\n", key, str);
+		g_variant_unref (value);
+	}
+
+	return 0;
+}
@@ -0,0 +1,16 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#ifndef __APPLET_STATS_H__
+#define __APPLET_STATS_H__
+
+#include "applet.h"
+
+guint applet_stats_register (NMApplet *applet,
+                             GDBusConnection *connection,
+                             const char *object_path,
+                             GError **error);
+
+int applet_stats_dump (void);
+
+#endif /* __APPLET_STATS_H__ */
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -22,6 +23,7 @@
 #include "nma-vpn-password-dialog.h"
 #include "nm-utils/nm-compat.h"
 #include "nm-utils/nm-shared-utils.h"
+#include "profile.h"
 
 /*****************************************************************************/
 
@@ -40,6 +42,8 @@ typedef struct {
 
 	guint watch_id;
 	GPid pid;
+	/* nma_profile_now() when the auth dialog was spawned */
+	gint64 spawn_time;
 
 	int child_stdout;
 	GString *child_response;
@@ -48,6 +52,10 @@ typedef struct {
 	GVariantBuilder secrets_builder;
 	gboolean external_ui_mode;
 
+	/* Answering from the secrets cache */
+	guint cache_idle_id;
+	gboolean from_cache;
+
 	/* These are just for the external UI mode */
 	EuiSecret *eui_secrets;
 	GtkDialog *dialog;
@@ -72,6 +80,370 @@ applet_vpn_request_get_secrets_size (void)
 
 /*****************************************************************************/
 
+/* Secrets that auth dialogs returned for connections whose secrets are
+ * never saved, so that a VPN that quickly reconnects doesn't spawn the
+ * auth dialog (and ask the user) again. The values live in mlock()ed
+ * memory, are wiped when dropped, and dropped when they expire, when the
+ * screen gets locked or when the session ends.
+ */
+
+typedef struct {
+	gint64 timestamp;
+	/* "key\0value\0" pairs, in locked pages of their own */
+	char *data;
+	gsize len;
+} CachedSecrets;
+
+typedef struct {
+	/* uuid => CachedSecrets */
+	GHashTable *entries;
+	GDBusConnection *session_bus;
+	GDBusConnection *system_bus;
+	guint screensaver_ids[2];
+	guint login1_lock_id;
+	guint login1_removed_id;
+	guint expire_id;
+	gulong timeout_changed_id;
+} SecretsCache;
+
+static void
+secure_clear (char *data, gsize len)
+{
+	volatile char *p = data;
+
+	while (len--)
+		*p++ = '\0';
+}
+
+static void
+cached_secrets_free (gpointer data)
+{
+	CachedSecrets *cached = data;
+
+	secure_clear (cached->data, cached->len);
+	munlock (cached->data, cached->len);
+	munmap (cached->data, cached->len);
+	g_slice_free (CachedSecrets, cached);
+}
+
+void
+applet_vpn_request_cache_clear (NMApplet *applet)
+{
+	SecretsCache *cache = applet->vpn_secrets_cache;
+
+	if (!cache)
+		return;
+
+	nm_clear_g_source (&cache->expire_id);
+	if (g_hash_table_size (cache->entries)) {
+		g_debug ("Forgetting the secrets of %u VPN connections", g_hash_table_size (cache->entries));
+		g_hash_table_remove_all (cache->entries);
+	}
+}
+
+static void
+screensaver_active_changed (GDBusConnection *connection,
+                            const char *sender_name,
+                            const char *object_path,
+                            const char *interface_name,
+                            const char *signal_name,
+                            GVariant *parameters,
+                            gpointer user_data)
+{
+	gboolean active = FALSE;
+
+	if (g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(b)")))
+		g_variant_get (parameters, "(b)", &active);
+	if (active)
+		applet_vpn_request_cache_clear (user_data);
+}
+
+static void
+login1_session_lock (GDBusConnection *connection,
+                     const char *sender_name,
+                     const char *object_path,
+                     const char *interface_name,
+                     const char *signal_name,
+                     GVariant *parameters,
+                     gpointer user_data)
+{
+	/* Any session being locked will do, rather than finding out our own */
+	applet_vpn_request_cache_clear (user_data);
+}
+
+static void
+login1_session_removed (GDBusConnection *connection,
+                        const char *sender_name,
+                        const char *object_path,
+                        const char *interface_name,
+                        const char *signal_name,
+                        GVariant *parameters,
+                        gpointer user_data)
+{
+	const char *session_id = NULL;
+
+	if (g_variant_is_of_type (parameters, G_VARIANT_TYPE ("(so)")))
+		g_variant_get (parameters, "(&s&o)", &session_id, NULL);
+	if (nm_streq0 (session_id, g_getenv ("XDG_SESSION_ID")))
+		applet_vpn_request_cache_clear (user_data);
+}
+
+static gint64
+secrets_cache_timeout (NMApplet *applet)
+{
+	return MAX (0, g_settings_get_int (applet->gsettings, PREF_VPN_SECRETS_CACHE_TIMEOUT));
+}
+
+static gboolean secrets_cache_expire (gpointer user_data);
+
+/* Drops the expired entries and arms a timeout for the next one to expire */
+static void
+secrets_cache_schedule_expiry (NMApplet *applet)
+{
+	SecretsCache *cache = applet->vpn_secrets_cache;
+	GHashTableIter iter;
+	CachedSecrets *cached;
+	gint64 timeout, now, next = G_MAXINT64;
+
+	nm_clear_g_source (&cache->expire_id);
+
+	timeout = secrets_cache_timeout (applet) * G_USEC_PER_SEC;
+	if (!timeout) {
+		applet_vpn_request_cache_clear (applet);
+		return;
+	}
+
+	now = g_get_monotonic_time ();
+	g_hash_table_iter_init (&iter, cache->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &cached)) {
+		if (now - cached->timestamp >= timeout)
+			g_hash_table_iter_remove (&iter);
+		else
+			next = MIN (next, cached->timestamp + timeout);
+	}
+
+	if (next != G_MAXINT64) {
+		cache->expire_id = g_timeout_add_seconds ((next - now + G_USEC_PER_SEC - 1) / G_USEC_PER_SEC,
+		                                          secrets_cache_expire,
+		                                          applet);
+	}
+}
+
+static gboolean
+secrets_cache_expire (gpointer user_data)
+{
+	NMApplet *applet = user_data;
+	SecretsCache *cache = applet->vpn_secrets_cache;
+
+	cache->expire_id = 0;
+	secrets_cache_schedule_expiry (applet);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+secrets_cache_timeout_changed (GSettings *settings, const char *key, gpointer user_data)
+{
+	secrets_cache_schedule_expiry (user_data);
+}
+
+static SecretsCache *
+secrets_cache_ensure (NMApplet *applet)
+{
+	SecretsCache *cache = applet->vpn_secrets_cache;
+
+	if (cache)
+		return cache;
+
+	cache = g_slice_new0 (SecretsCache);
+	cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, cached_secrets_free);
+
+	/* Watch for the screen being locked and the session ending */
+	cache->session_bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
+	if (cache->session_bus) {
+		cache->screensaver_ids[0] =
+			g_dbus_connection_signal_subscribe (cache->session_bus, NULL,
+			                                    "org.freedesktop.ScreenSaver", "ActiveChanged",
+			                                    NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+			                                    screensaver_active_changed, applet, NULL);
+		cache->screensaver_ids[1] =
+			g_dbus_connection_signal_subscribe (cache->session_bus, NULL,
+			                                    "org.gnome.ScreenSaver", "ActiveChanged",
+			                                    NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+			                                    screensaver_active_changed, applet, NULL);
+	}
+	cache->system_bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
+	if (cache->system_bus) {
+		cache->login1_lock_id =
+			g_dbus_connection_signal_subscribe (cache->system_bus, "org.freedesktop.login1",
+			                                    "org.freedesktop.login1.Session", "Lock",
+			                                    NULL, NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+			                                    login1_session_lock, applet, NULL);
+		cache->login1_removed_id =
+			g_dbus_connection_signal_subscribe (cache->system_bus, "org.freedesktop.login1",
+			                                    "org.freedesktop.login1.Manager", "SessionRemoved",
+			                                    "/org/freedesktop/login1", NULL, G_DBUS_SIGNAL_FLAGS_NONE,
+			                                    login1_session_removed, applet, NULL);
+	}
+
+	cache->timeout_changed_id =
+		g_signal_connect (applet->gsettings, "changed::" PREF_VPN_SECRETS_CACHE_TIMEOUT,
+		                  G_CALLBACK (secrets_cache_timeout_changed), applet);
+
+	applet->vpn_secrets_cache = cache;
+	return cache;
+}
+
+void
+applet_vpn_request_cache_free (NMApplet *applet)
+{
+	SecretsCache *cache = applet->vpn_secrets_cache;
+	guint i;
+
+	if (!cache)
+		return;
+
+	nm_clear_g_source (&cache->expire_id);
+	nm_clear_g_signal_handler (applet->gsettings, &cache->timeout_changed_id);
+
+	if (cache->session_bus) {
+		for (i = 0; i < G_N_ELEMENTS (cache->screensaver_ids); i++)
+			g_dbus_connection_signal_unsubscribe (cache->session_bus, cache->screensaver_ids[i]);
+		g_object_unref (cache->session_bus);
+	}
+	if (cache->system_bus) {
+		g_dbus_connection_signal_unsubscribe (cache->system_bus, cache->login1_lock_id);
+		g_dbus_connection_signal_unsubscribe (cache->system_bus, cache->login1_removed_id);
+		g_object_unref (cache->system_bus);
+	}
+
+	g_hash_table_destroy (cache->entries);
+	g_slice_free (SecretsCache, cache);
+	applet->vpn_secrets_cache = NULL;
+}
+
+/* Only secrets that would otherwise be asked for again are remembered */
+static gboolean
+secrets_are_not_saved (NMConnection *connection, GVariant *secrets)
+{
+	NMSettingVpn *s_vpn = nm_connection_get_setting_vpn (connection);
+	NMSettingSecretFlags flags;
+	GVariantIter iter;
+	const char *key;
+
+	if (!s_vpn || g_variant_n_children (secrets) == 0)
+		return FALSE;
+
+	g_variant_iter_init (&iter, secrets);
+	while (g_variant_iter_next (&iter, "{&s&s}", &key, NULL)) {
+		flags = NM_SETTING_SECRET_FLAG_NONE;
+		if (!nm_setting_get_secret_flags (NM_SETTING (s_vpn), key, &flags, NULL))
+			return FALSE;
+		if (!(flags & NM_SETTING_SECRET_FLAG_NOT_SAVED))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static void
+secrets_cache_store (SecretsRequest *req, GVariant *secrets)
+{
+	const char *uuid = nm_connection_get_uuid (req->connection);
+	SecretsCache *cache;
+	CachedSecrets *cached;
+	GVariantIter iter;
+	const char *key, *value;
+	gsize len = 0, pos = 0;
+	char *data;
+
+	if (!uuid || !secrets_cache_timeout (req->applet))
+		return;
+	if (!secrets_are_not_saved (req->connection, secrets))
+		return;
+
+	g_variant_iter_init (&iter, secrets);
+	while (g_variant_iter_next (&iter, "{&s&s}", &key, &value))
+		len += strlen (key) + strlen (value) + 2;
+
+	/* Pages of their own, as unlocking works on whole pages */
+	data = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (data == MAP_FAILED)
+		return;
+	if (mlock (data, len) != 0) {
+		g_debug ("Not remembering VPN secrets: can't lock memory (%s)", g_strerror (errno));
+		munmap (data, len);
+		return;
+	}
+
+	cached = g_slice_new0 (CachedSecrets);
+	cached->timestamp = g_get_monotonic_time ();
+	cached->len = len;
+	cached->data = data;
+
+	g_variant_iter_init (&iter, secrets);
+	while (g_variant_iter_next (&iter, "{&s&s}", &key, &value)) {
+		memcpy (cached->data + pos, key, strlen (key) + 1);
+		pos += strlen (key) + 1;
+		memcpy (cached->data + pos, value, strlen (value) + 1);
+		pos += strlen (value) + 1;
+	}
+
+	cache = secrets_cache_ensure (req->applet);
+	g_hash_table_insert (cache->entries, g_strdup (uuid), cached);
+	secrets_cache_schedule_expiry (req->applet);
+}
+
+/* Adds the remembered secrets of the request's connection to the
+ * request's secrets builder. Requests for new secrets, or with hints
+ * (eg a challenge from the server), always go to the auth dialog.
+ */
+static gboolean
+secrets_cache_lookup (SecretsRequest *req, GVariantBuilder *builder)
+{
+	SecretsCache *cache = req->applet->vpn_secrets_cache;
+	const char *uuid = nm_connection_get_uuid (req->connection);
+	CachedSecrets *cached;
+	gint64 timeout;
+	gsize pos;
+
+	if (!cache || !uuid)
+		return FALSE;
+	if (req->flags & NM_SECRET_AGENT_GET_SECRETS_FLAG_REQUEST_NEW)
+		return FALSE;
+	if (req->hints && req->hints[0])
+		return FALSE;
+
+	cached = g_hash_table_lookup (cache->entries, uuid);
+	if (!cached)
+		return FALSE;
+
+	timeout = secrets_cache_timeout (req->applet);
+	if (g_get_monotonic_time () - cached->timestamp > timeout * G_USEC_PER_SEC) {
+		g_hash_table_remove (cache->entries, uuid);
+		return FALSE;
+	}
+
+	for (pos = 0; pos < cached->len; ) {
+		const char *key = cached->data + pos;
+		const char *value = key + strlen (key) + 1;
+
+		g_variant_builder_add (builder, "{ss}", key, value);
+		pos = (value - cached->data) + strlen (value) + 1;
+	}
+	return TRUE;
+}
+
+static gboolean
+complete_from_cache (gpointer user_data)
+{
+	VpnSecretsInfo *info = user_data;
+
+	info->req_data->cache_idle_id = 0;
+	complete_request (info);
+	return G_SOURCE_REMOVE;
+}
+
+/*****************************************************************************/
+
 static void
 external_ui_add_secrets (VpnSecretsInfo *info)
 {
@@ -272,13 +644,18 @@ complete_request (VpnSecretsInfo *info)
 	RequestData *req_data = info->req_data;
 	GVariantBuilder settings_builder, vpn_builder;
 	gs_unref_variant GVariant *settings = NULL;
+	gs_unref_variant GVariant *secrets = NULL;
+
+	secrets = g_variant_ref_sink (g_variant_builder_end (&req_data->secrets_builder));
+	if (!req_data->from_cache)
+		secrets_cache_store (req, secrets);
 
 	g_variant_builder_init (&settings_builder, NM_VARIANT_TYPE_CONNECTION);
 	g_variant_builder_init (&vpn_builder, NM_VARIANT_TYPE_SETTING);
 
 	g_variant_builder_add (&vpn_builder, "{sv}",
 	                       NM_SETTING_VPN_SECRETS,
-	                       g_variant_builder_end (&req_data->secrets_builder));
+	                       secrets);
 	g_variant_builder_add (&settings_builder, "{sa{sv}}",
 	                       NM_SETTING_VPN_SETTING_NAME,
 	                       &vpn_builder);
@@ -295,6 +672,9 @@ process_child_response (VpnSecretsInfo *info)
 	RequestData *req_data = info->req_data;
 	gs_free_error GError *error = NULL;
 
+	nma_profile_mark_message (req_data->spawn_time, "vpn", "auth-dialog response",
+	                          "%s", nm_connection_get_id (req->connection));
+
 	if (req_data->external_ui_mode) {
 		if (!external_ui_from_child_response (info, &error)) {
 			applet_secrets_request_complete (req, NULL, error);
@@ -327,6 +707,8 @@ child_finished_cb (GPid pid, int status, gpointer user_data)
 	req_data->watch_id = 0;
 
 	if (status) {
+		nma_profile_mark_message (req_data->spawn_time, "vpn", "auth-dialog response",
+		                          "%s (canceled)", nm_connection_get_id (req->connection));
 		error = g_error_new (NM_SECRET_AGENT_ERROR,
 		                     NM_SECRET_AGENT_ERROR_USER_CANCELED,
 		                     "%s.%d (%s): canceled", __FILE__, __LINE__, __func__);
@@ -617,6 +999,7 @@ free_vpn_secrets_info (SecretsRequest *req)
 	g_free (req_data->service_type);
 
 	nm_clear_g_source (&req_data->watch_id);
+	nm_clear_g_source (&req_data->cache_idle_id);
 
 	nm_clear_g_source (&req_data->channel_eventid);
 	if (req_data->channel)
@@ -683,17 +1066,6 @@ applet_vpn_request_get_secrets (SecretsRequest *req, GError **error)
 	service_type = nm_setting_vpn_get_service_type (s_vpn);
 	g_return_val_if_fail (service_type, FALSE);
 
-	plugin = nm_vpn_plugin_info_new_search_file (NULL, service_type);
-	auth_dialog = plugin ? nm_vpn_plugin_info_get_auth_dialog (plugin) : NULL;
-	if (!auth_dialog) {
-		g_set_error (error,
-		             NM_SECRET_AGENT_ERROR,
-		             NM_SECRET_AGENT_ERROR_FAILED,
-		             "Could not find the authentication dialog for VPN connection type '%s'",
-		             service_type);
-		return FALSE;
-	}
-
 	info->req_data = g_slice_new0 (RequestData);
 	if (!info->req_data) {
 		g_set_error_literal (error,
@@ -706,12 +1078,36 @@ applet_vpn_request_get_secrets (SecretsRequest *req, GError **error)
 
 	g_variant_builder_init (&req_data->secrets_builder, G_VARIANT_TYPE ("a{ss}"));
 
+	/* A quick reconnect may not need the auth dialog; complete from an
+	 * idle handler as the caller isn't done setting up the request yet.
+	 */
+	if (   secrets_cache_timeout (req->applet)
+	    && secrets_cache_lookup (req, &req_data->secrets_builder)) {
+		g_debug ("Reusing the recent secrets of VPN connection %s",
+		         nm_setting_connection_get_id (s_con));
+		req_data->from_cache = TRUE;
+		req_data->cache_idle_id = g_idle_add (complete_from_cache, info);
+		return TRUE;
+	}
+
+	plugin = nm_vpn_plugin_info_new_search_file (NULL, service_type);
+	auth_dialog = plugin ? nm_vpn_plugin_info_get_auth_dialog (plugin) : NULL;
+	if (!auth_dialog) {
+		g_set_error (error,
+		             NM_SECRET_AGENT_ERROR,
+		             NM_SECRET_AGENT_ERROR_FAILED,
+		             "Could not find the authentication dialog for VPN connection type '%s'",
+		             service_type);
+		return FALSE;
+	}
+
 	req_data->external_ui_mode = _nm_utils_ascii_str_to_bool (
 		nm_vpn_plugin_info_lookup_property (plugin,
 		                                    "GNOME",
 		                                    "supports-external-ui-mode"),
 		FALSE);
 
+	req_data->spawn_time = nma_profile_now ();
 	if (!auth_dialog_spawn (nm_setting_connection_get_id (s_con),
 	                        nm_setting_connection_get_uuid (s_con),
 	                        (const char *const*) req->hints,
@@ -725,6 +1121,8 @@ applet_vpn_request_get_secrets (SecretsRequest *req, GError **error)
 	                        &req_data->child_stdout,
 	                        error))
 		return FALSE;
+	nma_profile_mark_message (req_data->spawn_time, "vpn", "auth-dialog spawn",
+	                          "%s", auth_dialog);
 
 	/* catch when child is reaped */
 	req_data->watch_id = g_child_watch_add (req_data->pid, child_finished_cb, info);
@@ -15,5 +15,8 @@ size_t applet_vpn_request_get_secrets_size (void);
 
 gboolean applet_vpn_request_get_secrets (SecretsRequest *req, GError **error);
 
+void applet_vpn_request_cache_clear (NMApplet *applet);
+void applet_vpn_request_cache_free (NMApplet *applet);
+
 #endif  /* APPLET_VPN_REQUEST_H */
 
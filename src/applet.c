@@ -29,7 +29,11 @@
 #include "applet-dialogs.h"
 #include "nma-wifi-dialog.h"
 #include "applet-vpn-request.h"
+#include "icon-atlas.h"
 #include "utils.h"
+#include "profile.h"
+#include "applet-probes.h"
+#include "applet-stats.h"
 
 #if WITH_WWAN
 # include "applet-device-broadband.h"
@@ -40,11 +44,165 @@
 extern gboolean shell_debug;
 extern gboolean with_agent;
 extern gboolean with_appindicator;
+extern gboolean with_stats;
+extern gboolean agent_only;
 
 G_DEFINE_TYPE (NMApplet, nma, G_TYPE_APPLICATION)
 
 /********************************************************************/
 
+static void
+object_data_unlink_active_ap (AppletObjectData *data)
+{
+	if (!data->active_ap_data)
+		return;
+
+	if (data->active_ap_strength_id)
+		g_signal_handler_disconnect (data->active_ap, data->active_ap_strength_id);
+	data->active_ap_strength_id = 0;
+	data->active_ap_data->active_on = NULL;
+	data->active_ap_data = NULL;
+	data->active_ap = NULL;
+}
+
+static void
+object_data_free (AppletObjectData *data)
+{
+	if (data->active_on)
+		object_data_unlink_active_ap (data->active_on);
+	object_data_unlink_active_ap (data);
+
+	if (data->device_data && data->device_data_free)
+		data->device_data_free (data->device_data);
+	g_free (data->ap_hash);
+	g_slice_free (AppletObjectData, data);
+}
+
+static void
+object_data_weak_notify (gpointer user_data, GObject *where_the_object_was)
+{
+	NMApplet *applet = user_data;
+	AppletObjectData *data;
+
+	data = g_hash_table_lookup (applet->object_data, where_the_object_was);
+	g_return_if_fail (data);
+	g_hash_table_steal (applet->object_data, where_the_object_was);
+
+	if (data->active_on) {
+		/* The strength handler went away with the access point */
+		data->active_on->active_ap_strength_id = 0;
+	}
+	if (data->active_on || data->active_ap)
+		applet_schedule_update_icon (applet);
+
+	object_data_free (data);
+}
+
+static void
+object_data_destroy (gpointer user_data)
+{
+	AppletObjectData *data = user_data;
+
+	g_object_weak_unref (data->object, object_data_weak_notify, data->applet);
+	object_data_free (data);
+}
+
+/**
+ * applet_object_data_lookup:
+ * @applet: the applet
+ * @object: a libnm object
+ *
+ * Returns: the data kept for @object, or %NULL if there is none yet.
+ */
+AppletObjectData *
+applet_object_data_lookup (NMApplet *applet, gpointer object)
+{
+	return g_hash_table_lookup (applet->object_data, object);
+}
+
+/**
+ * applet_object_data_get:
+ * @applet: the applet
+ * @object: a libnm object
+ *
+ * Returns: the data kept for @object, created if needed. This replaces
+ * g_object_set_data() for objects the menu and the signal handlers look
+ * at often: it's a single pointer lookup, and the data is freed when
+ * @object is.
+ */
+AppletObjectData *
+applet_object_data_get (NMApplet *applet, gpointer object)
+{
+	AppletObjectData *data;
+
+	g_return_val_if_fail (G_IS_OBJECT (object), NULL);
+
+	data = g_hash_table_lookup (applet->object_data, object);
+	if (!data) {
+		data = g_slice_new0 (AppletObjectData);
+		data->applet = applet;
+		data->object = object;
+		g_object_weak_ref (object, object_data_weak_notify, applet);
+		g_hash_table_insert (applet->object_data, object, data);
+	}
+	return data;
+}
+
+void
+applet_object_data_set_device_data (AppletObjectData *data,
+                                    gpointer device_data,
+                                    GDestroyNotify device_data_free)
+{
+	gpointer old_data = data->device_data;
+	GDestroyNotify old_free = data->device_data_free;
+
+	data->device_data = device_data;
+	data->device_data_free = device_data_free;
+	if (old_data && old_free)
+		old_free (old_data);
+}
+
+/**
+ * applet_object_data_set_active_ap:
+ * @applet: the applet
+ * @device: a Wi-Fi device
+ * @ap: (allow-none): its active access point
+ *
+ * Remembers @ap as the active access point of @device, and updates the
+ * icon when its strength changes. It's not referenced and is forgotten
+ * when it goes away.
+ */
+void
+applet_object_data_set_active_ap (NMApplet *applet, NMDevice *device, NMAccessPoint *ap)
+{
+	AppletObjectData *data, *ap_data;
+
+	if (ap)
+		data = applet_object_data_get (applet, device);
+	else
+		data = applet_object_data_lookup (applet, device);
+	if (!data || data->active_ap == ap)
+		return;
+
+	object_data_unlink_active_ap (data);
+	if (!ap)
+		return;
+
+	ap_data = applet_object_data_get (applet, ap);
+	if (ap_data->active_on)
+		object_data_unlink_active_ap (ap_data->active_on);
+
+	data->active_ap = ap;
+	data->active_ap_data = ap_data;
+	ap_data->active_on = data;
+	data->active_ap_strength_id = g_signal_connect_swapped (ap,
+	                                                        "notify::" NM_ACCESS_POINT_STRENGTH,
+	                                                        G_CALLBACK (applet_schedule_update_icon),
+	                                                        applet);
+}
+
+/********************************************************************/
+
 static gboolean
 applet_request_wifi_scan (NMApplet *applet)
 {
@@ -488,6 +646,7 @@ activate_connection_cb (GObject *client,
 	NMActiveConnection *active;
 
 	active = nm_client_activate_connection_finish (NM_CLIENT (client), result, &error);
+	NMA_PROBE2 (activate_done, active ? nm_active_connection_get_uuid (active) : NULL, error != NULL);
 	g_clear_object (&active);
 
 	if (error) {
@@ -511,6 +670,10 @@ applet_menu_item_activate_helper (NMDevice *device,
 	AppletItemActivateInfo *info;
 	NMADeviceClass *dclass;
 
+	NMA_PROBE2 (menu_activate,
+	            connection ? nm_connection_get_uuid (connection) : NULL,
+	            device ? nm_device_get_iface (device) : NULL);
+
 	if (connection) {
 		/* If the menu item had an associated connection already, just tell
 		 * NM to activate that connection.
@@ -716,18 +879,163 @@ typedef enum {
     VPN_NOTIFICATIONS          = 2,
 } BaseNotificationTypes;
 
-static gboolean 
-is_vpn_notification_pref(const char *pref) 
+/* Flags of the entries of applet->notify_prefs */
+#define NOTIFY_PREF_SET   (1 << 0)
+#define NOTIFY_PREF_VPN   (1 << 1)
+#define NOTIFY_PREF_LINK  (1 << 2)
+
+/* Link up/down notifications beyond NOTIFY_FLAP_MAX within
+ * NOTIFY_FLAP_WINDOW seconds get merged into one at the end of the window.
+ */
+#define NOTIFY_FLAP_WINDOW 30
+#define NOTIFY_FLAP_MAX    2
+
+static void
+notify_pref_changed (GSettings *settings, const char *key, gpointer user_data)
 {
-	g_return_val_if_fail(pref != NULL, FALSE);
+	NMApplet *applet = NM_APPLET (user_data);
+	gpointer orig_key, value;
+	guint flags;
 
-	for (int i = 0; i < G_N_ELEMENTS (vpn_reasons_prefs); i++) {
-		if(!strcmp(pref, vpn_reasons_prefs[i])) {
-			return TRUE;
+	if (!g_hash_table_lookup_extended (applet->notify_prefs, key, &orig_key, &value))
+		return;
+
+	flags = GPOINTER_TO_UINT (value) & ~NOTIFY_PREF_SET;
+	if (g_settings_get_boolean (settings, key))
+		flags |= NOTIFY_PREF_SET;
+	g_hash_table_insert (applet->notify_prefs, orig_key, GUINT_TO_POINTER (flags));
+}
+
+static void
+notify_prefs_add (NMApplet *applet, const char *key, guint flags)
+{
+	char *signal;
+
+	g_hash_table_insert (applet->notify_prefs, (gpointer) key, GUINT_TO_POINTER (flags));
+	notify_pref_changed (applet->gsettings, key, applet);
+
+	signal = g_strdup_printf ("changed::%s", key);
+	g_signal_connect (applet->gsettings, signal, G_CALLBACK (notify_pref_changed), applet);
+	g_free (signal);
+}
+
+static void
+notify_prefs_init (NMApplet *applet)
+{
+	guint i;
+
+	applet->notify_prefs = g_hash_table_new (g_str_hash, g_str_equal);
+
+	notify_prefs_add (applet, PREF_DISABLE_CONNECTED_NOTIFICATIONS, NOTIFY_PREF_LINK);
+	notify_prefs_add (applet, PREF_DISABLE_DISCONNECTED_NOTIFICATIONS, NOTIFY_PREF_LINK);
+	notify_prefs_add (applet, PREF_DISABLE_VPN_NOTIFICATIONS, 0);
+	notify_prefs_add (applet, PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE, 0);
+	for (i = 0; i < G_N_ELEMENTS (vpn_reasons_prefs); i++)
+		notify_prefs_add (applet, vpn_reasons_prefs[i], NOTIFY_PREF_VPN);
+}
+
+/**
+ * applet_notification_pref_get:
+ * @applet: the #NMApplet
+ * @pref: a boolean preference key
+ *
+ * Returns: the value of @pref; cached for the notification preferences.
+ */
+gboolean
+applet_notification_pref_get (NMApplet *applet, const char *pref)
+{
+	gpointer value;
+
+	if (   applet->notify_prefs
+	    && g_hash_table_lookup_extended (applet->notify_prefs, pref, NULL, &value))
+		return !!(GPOINTER_TO_UINT (value) & NOTIFY_PREF_SET);
+
+	return g_settings_get_boolean (applet->gsettings, pref);
+}
+
+static void
+send_notification (NMApplet *applet,
+                   const char *id,
+                   const char *title,
+                   const char *body,
+                   const char *icon_name,
+                   const char *pref)
+{
+	gs_unref_object GNotification *notify = NULL;
+	GIcon *icon;
+	char *escaped;
+
+	notify = g_notification_new (title);
+
+	escaped = utils_escape_notify_body (body);
+	g_notification_set_body (notify, escaped);
+	g_free (escaped);
+
+	icon = g_themed_icon_new (icon_name ?: "network-workgroup");
+	g_notification_set_icon (notify, icon);
+	g_object_unref (icon);
+
+	if (pref) {
+		g_notification_add_button_with_target (notify,
+						       _("Don’t show this message again"),
+						       "app.enable-pref", "s", pref);
+	}
+
+	/* A new notification replaces the previous one with the same ID */
+	g_application_send_notification (G_APPLICATION (applet), id, notify);
+}
+
+static gboolean
+flap_summary_cb (gpointer user_data)
+{
+	NMApplet *applet = NM_APPLET (user_data);
+	gs_free char *body = NULL;
+
+	applet->flap_timeout_id = 0;
+
+	body = g_strdup_printf (ngettext ("%s\nThe network connection changed %u time in the last %u seconds.",
+	                                  "%s\nThe network connection changed %u times in the last %u seconds.",
+	                                  applet->flap_count),
+	                        applet->flap_body, applet->flap_count, NOTIFY_FLAP_WINDOW);
+	send_notification (applet, "nm-applet-link",
+	                   _("Unstable network connection"), body, "nm-no-connection", NULL);
+
+	/* Keep merging while the link keeps flapping */
+	applet->flap_window_start = g_get_monotonic_time ();
+	applet->flap_count = NOTIFY_FLAP_MAX;
+	g_clear_pointer (&applet->flap_body, g_free);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* Returns whether the link notification got merged into a later summary */
+static gboolean
+flap_merge (NMApplet *applet, const char *body)
+{
+	gint64 now = g_get_monotonic_time ();
+
+	if (applet->flap_timeout_id)
+		applet->flap_count++;
+	else {
+		if (now - applet->flap_window_start > NOTIFY_FLAP_WINDOW * G_USEC_PER_SEC) {
+			applet->flap_window_start = now;
+			applet->flap_count = 0;
 		}
+		if (++applet->flap_count <= NOTIFY_FLAP_MAX)
+			return FALSE;
+
+		/* From now on count the merged notifications only */
+		applet->flap_timeout_id = g_timeout_add_seconds (NOTIFY_FLAP_WINDOW, flap_summary_cb, applet);
+		applet->flap_count = 1;
 	}
 
-    return FALSE;
+	g_free (applet->flap_body);
+	applet->flap_body = g_strdup (body);
+
+	applet->notify_merged++;
+	g_debug ("Merging link notification (%u merged, %u dropped so far)",
+	         applet->notify_merged, applet->notify_dropped);
+	return TRUE;
 }
 
 void
@@ -737,55 +1045,56 @@ applet_do_notify (NMApplet *applet,
                   const char *icon_name,
                   const char *pref)
 {
-	gs_unref_object GNotification *notify = NULL;
-	GIcon *icon;
-	char *escaped;
+	const char *id = "nm-applet";
+	gpointer value = NULL;
+	guint flags;
 
 	g_return_if_fail (applet != NULL);
 	g_return_if_fail (title != NULL);
 	g_return_if_fail (body != NULL);
 
-	if(pref && is_vpn_notification_pref(pref)) {
-		if (g_settings_get_boolean (applet->gsettings, PREF_DISABLE_VPN_NOTIFICATIONS)) {
-			return;
-		}
-	}
+	if (   pref
+	    && !g_hash_table_lookup_extended (applet->notify_prefs, pref, NULL, &value)
+	    && g_settings_get_boolean (applet->gsettings, pref))
+		goto drop;
+	flags = GPOINTER_TO_UINT (value);
 
-	if (pref && g_settings_get_boolean (applet->gsettings, pref))
-		return;
+	if (   (flags & NOTIFY_PREF_SET)
+	    || (   (flags & NOTIFY_PREF_VPN)
+	        && applet_notification_pref_get (applet, PREF_DISABLE_VPN_NOTIFICATIONS)))
+		goto drop;
+
+	/* No tray icon to attach the notifications to */
+	if (agent_only)
+		goto drop;
 
 	if (INDICATOR_ENABLED (applet)) {
 #ifdef WITH_APPINDICATOR
 		if (app_indicator_get_status (applet->app_indicator) == APP_INDICATOR_STATUS_PASSIVE)
-			return;
+			goto drop;
 #endif  /* WITH_APPINDICATOR */
 	} else {
 		if (!gtk_status_icon_is_embedded (applet->status_icon))
-			return;
+			goto drop;
 	}
 
 	/* if we're not acting as a secret agent, don't notify either */
 	if (!applet->agent)
-		return;
-
-	notify = g_notification_new (title);
+		goto drop;
 
-	escaped = utils_escape_notify_body (body);
-	g_notification_set_body (notify, escaped);
-	g_free (escaped);
-
-	icon = g_themed_icon_new (icon_name ?: "network-workgroup");
-	g_notification_set_icon (notify, icon);
-	g_object_unref (icon);
-
-	if (pref) {
-		g_notification_add_button_with_target (notify,
-						       _("Don’t show this message again"),
-						       "app.enable-pref", "s", pref);
+	if (flags & NOTIFY_PREF_LINK) {
+		id = "nm-applet-link";
+		if (flap_merge (applet, body))
+			return;
+	} else if (   (flags & NOTIFY_PREF_VPN)
+	           || nm_streq0 (pref, PREF_DISABLE_VPN_NOTIFICATIONS))
+		id = "nm-applet-vpn";
 
-	}
+	send_notification (applet, id, title, body, icon_name, pref);
+	return;
 
-	g_application_send_notification (G_APPLICATION (applet), "nm-applet", notify);
+drop:
+	applet->notify_dropped++;
 }
 
 static gboolean
@@ -927,6 +1236,10 @@ vpn_active_connection_state_changed (NMVpnConnection *vpn,
 	char *title = NULL, *msg, *pref;
 	gboolean device_activating, vpn_activating;
 
+	NMA_PROBE3 (vpn_state_changed,
+	            nm_active_connection_get_uuid (NM_ACTIVE_CONNECTION (vpn)),
+	            state, reason);
+
 	device_activating = applet_is_any_device_activating (applet);
 	vpn_activating = applet_is_any_vpn_activating (applet);
 
@@ -1017,21 +1330,30 @@ activate_vpn_cb (GObject *client,
 	g_free (info);
 }
 
+typedef struct {
+	NMApplet *applet;
+	NMConnection *connection;
+} VPNMenuItemInfo;
+
+static void
+vpn_menu_item_info_free (gpointer data, GClosure *closure)
+{
+	VPNMenuItemInfo *item_info = data;
+
+	g_object_unref (item_info->connection);
+	g_slice_free (VPNMenuItemInfo, item_info);
+}
+
 static void
 nma_menu_vpn_item_clicked (GtkMenuItem *item, gpointer user_data)
 {
-	NMApplet *applet = NM_APPLET (user_data);
+	VPNMenuItemInfo *item_info = user_data;
+	NMApplet *applet = item_info->applet;
+	NMConnection *connection = item_info->connection;
 	VPNActivateInfo *info;
-	NMConnection *connection;
 	NMActiveConnection *active;
 	NMDevice *device = NULL;
 
-	connection = NM_CONNECTION (g_object_get_data (G_OBJECT (item), "connection"));
-	if (!connection) {
-		g_warning ("%s: no connection associated with menu item!", __func__);
-		return;
-	}
-
 	active = applet_get_active_for_connection (applet, connection);
 	if (active) {
 		/* Connection already active; disconnect it */
@@ -1386,6 +1708,7 @@ add_device_items (NMDeviceType type, const GPtrArray *all_devices,
 		NMConnection *active;
 		GPtrArray *connections;
 		gboolean added;
+		gint64 begin;
 
 		dclass = get_device_class (device, applet);
 		if (!dclass)
@@ -1394,7 +1717,10 @@ add_device_items (NMDeviceType type, const GPtrArray *all_devices,
 		connections = nm_device_filter_connections (device, all_connections);
 		active = applet_find_active_connection_for_device (device, applet, NULL);
 
+		begin = nma_profile_now ();
 		added = dclass->add_menu_item (device, n_devices > 1, connections, active, menu, applet);
+		nma_profile_mark_message (begin, "applet", "add-menu-item",
+		                          "%s", nm_device_get_iface (device));
 
 		g_ptr_array_unref (connections);
 
@@ -1484,6 +1810,7 @@ nma_menu_add_vpn_submenu (GtkWidget *menu, NMApplet *applet)
 	for (i = 0; i < list->len; i++) {
 		NMConnection *connection = NM_CONNECTION (list->pdata[i]);
 		NMActiveConnection *active;
+		VPNMenuItemInfo *item_info;
 		const char *name;
 		NMState state;
 
@@ -1507,11 +1834,14 @@ nma_menu_add_vpn_submenu (GtkWidget *menu, NMApplet *applet)
 
 		gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (item), !!active);
 
-		g_object_set_data_full (G_OBJECT (item), "connection",
-		                        g_object_ref (connection),
-		                        (GDestroyNotify) g_object_unref);
-
-		g_signal_connect (item, "activate", G_CALLBACK (nma_menu_vpn_item_clicked), applet);
+		item_info = g_slice_new (VPNMenuItemInfo);
+		item_info->applet = applet;
+		item_info->connection = g_object_ref (connection);
+		g_signal_connect_data (item, "activate",
+		                       G_CALLBACK (nma_menu_vpn_item_clicked),
+		                       item_info,
+		                       vpn_menu_item_info_free,
+		                       0);
 		gtk_menu_shell_append (GTK_MENU_SHELL (vpn_menu), GTK_WIDGET (item));
 		gtk_widget_show (GTK_WIDGET (item));
 	}
@@ -1634,17 +1964,9 @@ has_usable_wifi (NMApplet *applet)
 	return FALSE;
 }
 
-/*
- * nma_menu_show_cb
- *
- * Pop up the wifi networks menu
- *
- */
-static void nma_menu_show_cb (GtkWidget *menu, NMApplet *applet)
+static void
+nma_menu_fill (GtkWidget *menu, NMApplet *applet)
 {
-	g_return_if_fail (menu != NULL);
-	g_return_if_fail (applet != NULL);
-
 	if (applet->status_icon)
 		gtk_status_icon_set_tooltip_text (applet->status_icon, NULL);
 
@@ -1672,6 +1994,28 @@ static void nma_menu_show_cb (GtkWidget *menu, NMApplet *applet)
 		gtk_widget_show_all (menu);
 }
 
+/*
+ * nma_menu_show_cb
+ *
+ * Pop up the wifi networks menu
+ *
+ */
+static void nma_menu_show_cb (GtkWidget *menu, NMApplet *applet)
+{
+	gint64 start, elapsed;
+
+	g_return_if_fail (menu != NULL);
+	g_return_if_fail (applet != NULL);
+
+	start = g_get_monotonic_time ();
+	nma_menu_fill (menu, applet);
+	elapsed = g_get_monotonic_time () - start;
+
+	applet->menu_rebuilds++;
+	applet->menu_rebuild_usec += elapsed;
+	applet->menu_rebuild_max_usec = MAX (applet->menu_rebuild_max_usec, elapsed);
+}
+
 static gboolean
 destroy_old_menu (gpointer user_data)
 {
@@ -1770,10 +2114,10 @@ nma_context_menu_update (NMApplet *applet)
 		/* Enabled notifications */
 		g_signal_handler_block (G_OBJECT (applet->notifications_enabled_item),
 			                    applet->notifications_enabled_toggled_id);
-		if (   g_settings_get_boolean (applet->gsettings, PREF_DISABLE_CONNECTED_NOTIFICATIONS)
-			&& g_settings_get_boolean (applet->gsettings, PREF_DISABLE_DISCONNECTED_NOTIFICATIONS)
-			&& g_settings_get_boolean (applet->gsettings, PREF_DISABLE_VPN_NOTIFICATIONS)
-			&& g_settings_get_boolean (applet->gsettings, PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE))
+		if (   applet_notification_pref_get (applet, PREF_DISABLE_CONNECTED_NOTIFICATIONS)
+			&& applet_notification_pref_get (applet, PREF_DISABLE_DISCONNECTED_NOTIFICATIONS)
+			&& applet_notification_pref_get (applet, PREF_DISABLE_VPN_NOTIFICATIONS)
+			&& applet_notification_pref_get (applet, PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE))
 			notifications_enabled = FALSE;
 		gtk_check_menu_item_set_active (GTK_CHECK_MENU_ITEM (applet->notifications_enabled_item), notifications_enabled);
 		g_signal_handler_unblock (G_OBJECT (applet->notifications_enabled_item),
@@ -2217,6 +2561,7 @@ applet_update_menu (gpointer user_data)
 	NMApplet *applet = NM_APPLET (user_data);
 	GList *children, *elt;
 	GtkMenu *menu;
+	gint64 begin = nma_profile_now ();
 
 	if (INDICATOR_ENABLED (applet)) {
 #ifdef WITH_APPINDICATOR
@@ -2256,6 +2601,8 @@ applet_update_menu (gpointer user_data)
 	} else
 		nma_menu_show_cb (GTK_WIDGET (menu), applet);
 
+	nma_profile_mark (begin, "applet", "update-menu");
+
 out:
 	applet->update_menu_id = 0;
 	return G_SOURCE_REMOVE;
@@ -2264,6 +2611,8 @@ out:
 void
 applet_schedule_update_menu (NMApplet *applet)
 {
+	if (agent_only)
+		return;
 	if (!applet->update_menu_id)
 		applet->update_menu_id = g_idle_add (applet_update_menu, applet);
 }
@@ -2358,6 +2707,104 @@ applet_get_exported_connection_for_device (NMDevice *device, NMApplet *applet)
 	return NULL;
 }
 
+static void
+prewarmed_dialog_clear (NMApplet *applet)
+{
+	if (applet->prewarmed_dialog) {
+		gtk_widget_destroy (applet->prewarmed_dialog);
+		applet->prewarmed_dialog = NULL;
+	}
+	g_clear_object (&applet->prewarmed_connection);
+	g_clear_pointer (&applet->prewarmed_setting, g_free);
+}
+
+static const char *
+prewarm_setting_name (NMConnection *connection)
+{
+	/* The setting NM asks secrets for when it has to authenticate again */
+	if (nm_connection_get_setting_802_1x (connection))
+		return NM_SETTING_802_1X_SETTING_NAME;
+	if (nm_connection_get_setting_wireless_security (connection))
+		return NM_SETTING_WIRELESS_SECURITY_SETTING_NAME;
+	return NULL;
+}
+
+static gboolean
+prewarm_secrets_dialog (gpointer user_data)
+{
+	NMApplet *applet = NM_APPLET (user_data);
+	const GPtrArray *devices;
+	int i;
+
+	applet->prewarm_id = 0;
+
+	if (!g_settings_get_boolean (applet->gsettings, PREF_PREWARM_SECRETS_DIALOGS)) {
+		prewarmed_dialog_clear (applet);
+		return G_SOURCE_REMOVE;
+	}
+
+	devices = nm_client_get_devices (applet->nm_client);
+	for (i = 0; devices && i < devices->len; i++) {
+		NMDevice *device = g_ptr_array_index (devices, i);
+		NMADeviceClass *dclass;
+		NMConnection *connection;
+		const char *setting_name;
+		GtkWidget *dialog;
+		gint64 start_time;
+
+		/* Keep the dialog while NM authenticates again */
+		if (   nm_device_get_state (device) < NM_DEVICE_STATE_PREPARE
+		    || nm_device_get_state (device) > NM_DEVICE_STATE_ACTIVATED)
+			continue;
+
+		dclass = get_device_class (device, applet);
+		if (!dclass || !dclass->new_secrets_dialog)
+			continue;
+
+		connection = applet_find_active_connection_for_device (device, applet, NULL);
+		if (!connection)
+			continue;
+		setting_name = prewarm_setting_name (connection);
+		if (!setting_name)
+			continue;
+
+		/* Still up to date? */
+		if (   applet->prewarmed_connection
+		    && nm_streq0 (applet->prewarmed_setting, setting_name)
+		    && nm_connection_compare (applet->prewarmed_connection, connection, NM_SETTING_COMPARE_FLAG_EXACT))
+			return G_SOURCE_REMOVE;
+
+		prewarmed_dialog_clear (applet);
+
+		start_time = g_get_monotonic_time ();
+		connection = nm_simple_connection_new_clone (connection);
+		dialog = dclass->new_secrets_dialog (connection, setting_name, applet);
+		if (!dialog) {
+			g_object_unref (connection);
+			continue;
+		}
+
+		applet->prewarmed_dialog = dialog;
+		applet->prewarmed_connection = connection;
+		applet->prewarmed_setting = g_strdup (setting_name);
+		g_debug ("Prepared the %s secrets dialog of “%s” in %" G_GINT64_FORMAT " ms",
+		         setting_name, nm_connection_get_id (connection),
+		         (g_get_monotonic_time () - start_time) / 1000);
+		return G_SOURCE_REMOVE;
+	}
+
+	/* Nothing active that might ask for secrets */
+	prewarmed_dialog_clear (applet);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+applet_schedule_prewarm_secrets_dialog (NMApplet *applet)
+{
+	if (!applet->prewarm_id)
+		applet->prewarm_id = g_idle_add_full (G_PRIORITY_LOW, prewarm_secrets_dialog, applet, NULL);
+}
+
 static void
 applet_common_device_state_changed (NMDevice *device,
                                     NMDeviceState new_state,
@@ -2417,7 +2864,7 @@ foo_device_state_changed_cb (NMDevice *device,
 
 	if (   dclass
 	    && new_state == NM_DEVICE_STATE_ACTIVATED
-	    && !g_settings_get_boolean (applet->gsettings, PREF_DISABLE_CONNECTED_NOTIFICATIONS)) {
+	    && !applet_notification_pref_get (applet, PREF_DISABLE_CONNECTED_NOTIFICATIONS)) {
 		NMConnection *connection;
 		char *str = NULL;
 
@@ -2431,6 +2878,14 @@ foo_device_state_changed_cb (NMDevice *device,
 		g_free (str);
 	}
 
+	if (   new_state == NM_DEVICE_STATE_ACTIVATED
+	    || new_state <= NM_DEVICE_STATE_DISCONNECTED
+	    || new_state >= NM_DEVICE_STATE_DEACTIVATING) {
+		if (   applet->prewarmed_dialog
+		    || g_settings_get_boolean (applet->gsettings, PREF_PREWARM_SECRETS_DIALOGS))
+			applet_schedule_prewarm_secrets_dialog (applet);
+	}
+
 	applet_schedule_update_icon (applet);
 	applet_schedule_update_menu (applet);
 }
@@ -2525,8 +2980,6 @@ vpn_state_changed (NMActiveConnection *connection,
 	applet_schedule_update_menu (applet);
 }
 
-#define VPN_STATE_ID_TAG "vpn-state-id"
-
 static void
 foo_active_connections_changed_cb (NMClient *client,
                                    GParamSpec *pspec,
@@ -2540,20 +2993,21 @@ foo_active_connections_changed_cb (NMClient *client,
 	active_list = nm_client_get_active_connections (client);
 	for (i = 0; active_list && (i < active_list->len); i++) {
 		NMActiveConnection *candidate = NM_ACTIVE_CONNECTION (g_ptr_array_index (active_list, i));
-		guint id;
+		AppletObjectData *data;
 
-		if (   !NM_IS_VPN_CONNECTION (candidate)
-		    || g_object_get_data (G_OBJECT (candidate), VPN_STATE_ID_TAG))
+		if (!NM_IS_VPN_CONNECTION (candidate))
+			continue;
+
+		data = applet_object_data_get (applet, candidate);
+		if (data->vpn_state_id)
 			continue;
 
 		/* Start/stop animation when the AC state changes ... */
-		id = g_signal_connect (G_OBJECT (candidate), "state-changed",
-		                       G_CALLBACK (vpn_active_connection_state_changed), applet);
+		data->vpn_state_id = g_signal_connect (G_OBJECT (candidate), "state-changed",
+		                                       G_CALLBACK (vpn_active_connection_state_changed), applet);
 		/* ... and also update icon/tooltip when the VPN state changes */
 		g_signal_connect (G_OBJECT (candidate), "notify::vpn-state",
 		                  G_CALLBACK (vpn_state_changed), applet);
-
-		g_object_set_data (G_OBJECT (candidate), VPN_STATE_ID_TAG, GUINT_TO_POINTER (id));
 	}
 
 	applet_schedule_update_icon (applet);
@@ -2892,6 +3346,7 @@ applet_update_icon (gpointer user_data)
 	NMVpnConnectionState vpn_state = NM_VPN_CONNECTION_STATE_UNKNOWN;
 	gboolean nm_running;
 	NMActiveConnection *active_vpn = NULL;
+	gint64 begin = nma_profile_now ();
 
 	applet->update_icon_id = 0;
 
@@ -2988,12 +3443,15 @@ applet_update_icon (gpointer user_data)
 			gtk_status_icon_set_title (applet->status_icon, applet->tip);
 	}
 
+	nma_profile_mark (begin, "applet", "update-icon");
 	return FALSE;
 }
 
 void
 applet_schedule_update_icon (NMApplet *applet)
 {
+	if (agent_only)
+		return;
 	if (!applet->update_icon_id)
 		applet->update_icon_id = g_idle_add (applet_update_icon, applet);
 }
@@ -3026,6 +3484,7 @@ applet_secrets_request_new (size_t totsize,
 	req->callback = callback;
 	req->callback_data = callback_data;
 	req->applet = applet;
+	req->start_time = g_get_monotonic_time ();
 	return req;
 }
 
@@ -3041,6 +3500,8 @@ applet_secrets_request_complete (SecretsRequest *req,
                                  GVariant *settings,
                                  GError *error)
 {
+	NMA_PROBE3 (secrets_request_complete, GPOINTER_TO_UINT (req->reqid),
+	            req->setting_name, error != NULL);
 	req->callback (req->applet->agent, error ? NULL : settings, error, req->callback_data);
 }
 
@@ -3092,6 +3553,48 @@ applet_secrets_request_free (SecretsRequest *req)
 	g_free (req);
 }
 
+/*****************************************************************************/
+
+/**
+ * applet_secrets_request_take_prewarmed_dialog:
+ * @req: the secrets request
+ *
+ * Returns: (transfer full): the secrets dialog that was built ahead of time
+ * for the request's connection and setting, or %NULL if there is none or
+ * the request's connection (with the existing secrets) differs from the
+ * one the dialog was built for.
+ */
+GtkWidget *
+applet_secrets_request_take_prewarmed_dialog (SecretsRequest *req)
+{
+	NMApplet *applet = req->applet;
+	GtkWidget *dialog;
+
+	if (   !applet->prewarmed_dialog
+	    || !nm_streq0 (applet->prewarmed_setting, req->setting_name)
+	    || (req->hints && req->hints[0])
+	    || !nm_connection_compare (applet->prewarmed_connection, req->connection, NM_SETTING_COMPARE_FLAG_EXACT))
+		return NULL;
+
+	/* The dialog can't be reset once used; prepare a new one for next time */
+	dialog = g_steal_pointer (&applet->prewarmed_dialog);
+	prewarmed_dialog_clear (applet);
+	applet_schedule_prewarm_secrets_dialog (applet);
+
+	return dialog;
+}
+
+void
+applet_secrets_request_dialog_shown (SecretsRequest *req, gboolean prewarmed)
+{
+	g_debug ("Secrets dialog for %s/%s shown %" G_GINT64_FORMAT " ms after the request%s",
+	         nm_connection_get_id (req->connection), req->setting_name,
+	         (g_get_monotonic_time () - req->start_time) / 1000,
+	         prewarmed ? " (prepared ahead of time)" : "");
+}
+
+/*****************************************************************************/
+
 static void
 get_existing_secrets_cb (NMSecretAgentOld *agent,
                          NMConnection *connection,
@@ -3121,6 +3624,32 @@ get_existing_secrets_cb (NMSecretAgentOld *agent,
 	/* Otherwise success; wait for the secrets callback */
 }
 
+/* In the agent-only mode GTK is not initialized until the first secrets
+ * request or SIM unlock dialog, since most of the time there's nothing to
+ * ask the user.
+ */
+gboolean
+applet_ensure_gtk (NMApplet *applet, GError **error)
+{
+	gint64 begin;
+
+	if (gdk_display_get_default ())
+		return TRUE;
+
+	begin = nma_profile_now ();
+	if (!gtk_init_check (NULL, NULL)) {
+		g_set_error_literal (error,
+		                     NM_SECRET_AGENT_ERROR,
+		                     NM_SECRET_AGENT_ERROR_FAILED,
+		                     "Could not initialize GTK to ask for secrets");
+		return FALSE;
+	}
+	gtk_window_set_default_icon_name ("network-workgroup");
+	nma_profile_mark (begin, "applet", "gtk init");
+
+	return TRUE;
+}
+
 static void
 applet_agent_get_secrets_cb (AppletAgent *agent,
                              gpointer request_id,
@@ -3141,6 +3670,9 @@ applet_agent_get_secrets_cb (AppletAgent *agent,
 	s_con = nm_connection_get_setting_connection (connection);
 	g_return_if_fail (s_con != NULL);
 
+	if (!applet_ensure_gtk (applet, &error))
+		goto error;
+
 	/* VPN secrets get handled a bit differently */
 	if (!strcmp (nm_setting_connection_get_connection_type (s_con), NM_SETTING_VPN_SETTING_NAME)) {
 		req = applet_secrets_request_new (applet_vpn_request_get_secrets_size (),
@@ -3301,6 +3833,235 @@ nma_icon_check_and_load (const char *name, NMApplet *applet)
 	return icon;
 }
 
+/* Loading an icon the first time it's needed means reading and rasterizing
+ * it right when the menu opens or the state changes. Instead, all the icons
+ * the applet may show are loaded in the background after startup and after
+ * the theme changes, one after the other, by GTK's loader thread. The result
+ * is kept in an icon atlas (see icon-atlas.c) that the next start maps
+ * instead of loading anything from the theme. The atlas is rewritten when
+ * the prefetch finds icons that were not in it.
+ */
+static const char *prefetch_icon_names[] = {
+	"nm-no-connection",
+	"nm-device-wired",
+	"nm-device-wireless",
+	"nm-device-wwan",
+	"nm-adhoc",
+	"nm-secure-lock",
+	"nm-insecure-warn",
+	"nm-vpn-active-lock",
+	"nm-signal-00",
+	"nm-signal-25",
+	"nm-signal-50",
+	"nm-signal-75",
+	"nm-signal-100",
+	"nm-wwan-tower",
+	"nm-mb-roam",
+	"nm-tech-cdma-1x",
+	"nm-tech-evdo",
+	"nm-tech-gprs",
+	"nm-tech-edge",
+	"nm-tech-umts",
+	"nm-tech-hspa",
+	"nm-tech-lte",
+};
+
+typedef struct {
+	NMApplet *applet;
+	GCancellable *cancellable;
+	GPtrArray *names;
+	guint next;
+	guint idle_id;
+
+	/* The icon atlases, written once done if they miss icons */
+	char *atlas_path;
+	char *tray_atlas_path;
+	gboolean atlas_dirty;
+	gboolean tray_atlas_dirty;
+} IconPrefetch;
+
+static void icon_prefetch_next (IconPrefetch *prefetch);
+
+static void
+icon_prefetch_free (IconPrefetch *prefetch)
+{
+	nm_clear_g_source (&prefetch->idle_id);
+	g_free (prefetch->atlas_path);
+	g_free (prefetch->tray_atlas_path);
+	g_object_unref (prefetch->cancellable);
+	g_ptr_array_unref (prefetch->names);
+	g_slice_free (IconPrefetch, prefetch);
+}
+
+/* The names are prefetched for the menu icon cache first, then for the tray */
+static gboolean
+icon_prefetch_target (IconPrefetch *prefetch,
+                      const char **out_name,
+                      GtkIconTheme **out_theme,
+                      GHashTable **out_cache,
+                      int *out_scale)
+{
+	NMApplet *applet = prefetch->applet;
+	guint n = prefetch->names->len;
+
+	if (prefetch->next < n) {
+		*out_name = prefetch->names->pdata[prefetch->next];
+		*out_theme = applet->icon_theme;
+		*out_cache = applet->icon_cache;
+		*out_scale = gdk_window_get_scale_factor (gdk_get_default_root_window ());
+		return TRUE;
+	}
+	if (prefetch->next < 2 * n && applet->icon_theme_tray) {
+		*out_name = prefetch->names->pdata[prefetch->next - n];
+		*out_theme = applet->icon_theme_tray;
+		*out_cache = applet->icon_cache_tray;
+		*out_scale = 1;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+icon_prefetch_loaded (GObject *source, GAsyncResult *result, gpointer user_data)
+{
+	IconPrefetch *prefetch = user_data;
+	gs_unref_object GdkPixbuf *icon = NULL;
+	gs_free_error GError *error = NULL;
+	const char *name;
+	GtkIconTheme *theme;
+	GHashTable *cache;
+	int scale;
+
+	icon = gtk_icon_info_load_icon_finish (GTK_ICON_INFO (source), result, &error);
+	if (g_cancellable_is_cancelled (prefetch->cancellable)) {
+		icon_prefetch_free (prefetch);
+		return;
+	}
+
+	/* Failures get reported by the synchronous load on first use */
+	if (   icon
+	    && icon_prefetch_target (prefetch, &name, &theme, &cache, &scale)
+	    && !g_hash_table_contains (cache, name)) {
+		g_hash_table_insert (cache, g_strdup (name), g_steal_pointer (&icon));
+		if (cache == prefetch->applet->icon_cache)
+			prefetch->atlas_dirty = TRUE;
+		else
+			prefetch->tray_atlas_dirty = TRUE;
+	}
+
+	prefetch->next++;
+	icon_prefetch_next (prefetch);
+}
+
+static void
+icon_prefetch_next (IconPrefetch *prefetch)
+{
+	const char *name;
+	GtkIconTheme *theme;
+	GHashTable *cache;
+	GtkIconInfo *info;
+	int scale;
+
+	for (; icon_prefetch_target (prefetch, &name, &theme, &cache, &scale); prefetch->next++) {
+		if (g_hash_table_contains (cache, name))
+			continue;
+
+		info = gtk_icon_theme_lookup_icon_for_scale (theme, name, prefetch->applet->icon_size,
+		                                             scale, GTK_ICON_LOOKUP_FORCE_SIZE);
+		if (!info)
+			continue;
+
+		gtk_icon_info_load_icon_async (info, prefetch->cancellable, icon_prefetch_loaded, prefetch);
+		g_object_unref (info);
+		return;
+	}
+
+	g_debug ("Prefetched %u icons", prefetch->names->len);
+	if (prefetch->atlas_path) {
+		if (prefetch->atlas_dirty) {
+			icon_atlas_save (prefetch->atlas_path, prefetch->applet->icon_cache,
+			                 prefetch->names, prefetch->applet->fallback_icon);
+		}
+		icon_atlas_prune (prefetch->atlas_path);
+	}
+	if (prefetch->tray_atlas_path) {
+		if (prefetch->tray_atlas_dirty) {
+			icon_atlas_save (prefetch->tray_atlas_path, prefetch->applet->icon_cache_tray,
+			                 prefetch->names, NULL);
+		}
+		icon_atlas_prune (prefetch->tray_atlas_path);
+	}
+	prefetch->applet->icon_prefetch = NULL;
+	icon_prefetch_free (prefetch);
+}
+
+static gboolean
+icon_prefetch_start (gpointer user_data)
+{
+	IconPrefetch *prefetch = user_data;
+
+	prefetch->idle_id = 0;
+	icon_prefetch_next (prefetch);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+nma_icons_prefetch_cancel (NMApplet *applet)
+{
+	IconPrefetch *prefetch = applet->icon_prefetch;
+
+	if (!prefetch)
+		return;
+
+	applet->icon_prefetch = NULL;
+	if (prefetch->idle_id) {
+		icon_prefetch_free (prefetch);
+		return;
+	}
+
+	/* Freed by the pending load's callback */
+	g_cancellable_cancel (prefetch->cancellable);
+}
+
+static void
+nma_icons_prefetch (NMApplet *applet)
+{
+	IconPrefetch *prefetch;
+	gs_free char *theme_name = NULL;
+	guint i, j;
+
+	nma_icons_prefetch_cancel (applet);
+
+	prefetch = g_slice_new0 (IconPrefetch);
+	prefetch->applet = applet;
+	prefetch->cancellable = g_cancellable_new ();
+	prefetch->names = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; i < G_N_ELEMENTS (prefetch_icon_names); i++)
+		g_ptr_array_add (prefetch->names, g_strdup (prefetch_icon_names[i]));
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < NUM_CONNECTING_FRAMES; j++)
+			g_ptr_array_add (prefetch->names, g_strdup_printf ("nm-stage%02d-connecting%02d", i + 1, j + 1));
+	}
+	for (j = 0; j < NUM_VPN_CONNECTING_FRAMES; j++)
+		g_ptr_array_add (prefetch->names, g_strdup_printf ("nm-vpn-connecting%02d", j + 1));
+
+	/* Start with the icons rendered by a previous run, if the theme is unchanged */
+	g_object_get (gtk_settings_get_default (), "gtk-icon-theme-name", &theme_name, NULL);
+	if (theme_name) {
+		prefetch->atlas_path = icon_atlas_get_path (applet->icon_theme, theme_name, applet->icon_size,
+		                                            gdk_window_get_scale_factor (gdk_get_default_root_window ()));
+		prefetch->atlas_dirty = !icon_atlas_load (prefetch->atlas_path, applet->icon_cache);
+	}
+	if (applet->icon_theme_tray && applet->icon_theme_tray_name) {
+		prefetch->tray_atlas_path = icon_atlas_get_path (applet->icon_theme_tray, applet->icon_theme_tray_name,
+		                                                 applet->icon_size, 1);
+		prefetch->tray_atlas_dirty = !icon_atlas_load (prefetch->tray_atlas_path, applet->icon_cache_tray);
+	}
+
+	prefetch->idle_id = g_idle_add_full (G_PRIORITY_LOW, icon_prefetch_start, prefetch, NULL);
+	applet->icon_prefetch = prefetch;
+}
+
 #include "fallback-icon.h"
 
 static void
@@ -3313,6 +4074,7 @@ nma_icons_reload (NMApplet *applet)
 
 	g_hash_table_remove_all (applet->icon_cache_tray); //alex
 	nma_icons_free (applet);
+	nma_icons_prefetch (applet);
 
 	if (applet->fallback_icon)
 		return;
@@ -3489,6 +4251,14 @@ status_icon_size_changed_cb (GtkStatusIcon *icon,
 	return TRUE;
 }
 
+static void
+menu_finalized (gpointer user_data, GObject *where_the_object_was)
+{
+	NMApplet *applet = user_data;
+
+	applet->menus_alive--;
+}
+
 static void
 status_icon_activate_cb (GtkStatusIcon *icon, NMApplet *applet)
 {
@@ -3507,6 +4277,8 @@ status_icon_activate_cb (GtkStatusIcon *icon, NMApplet *applet)
 	applet->menu = gtk_menu_new ();
 	/* Sink the ref so we can explicitly destroy the menu later */
 	g_object_ref_sink (G_OBJECT (applet->menu));
+	applet->menus_alive++;
+	g_object_weak_ref (G_OBJECT (applet->menu), menu_finalized, applet);
 
 	gtk_container_set_border_width (GTK_CONTAINER (applet->menu), 0);
 	g_signal_connect (applet->menu, "show", G_CALLBACK (nma_menu_show_cb), applet);
@@ -3587,6 +4359,43 @@ applet_embedded_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
 	         embedded ? "embedded in" : "removed from");
 }
 
+static void
+applet_device_classes_init (NMApplet *applet)
+{
+	applet->ethernet_class = applet_device_ethernet_get_class (applet);
+	g_assert (applet->ethernet_class);
+
+	applet->wifi_class = applet_device_wifi_get_class (applet);
+	g_assert (applet->wifi_class);
+
+#if WITH_WWAN
+	applet->broadband_class = applet_device_broadband_get_class (applet);
+	g_assert (applet->broadband_class);
+#endif
+
+	applet->bt_class = applet_device_bt_get_class (applet);
+	g_assert (applet->bt_class);
+}
+
+#if WITH_WWAN
+/* The broadband secrets and SIM unlock need the ModemManager object of
+ * the modem, which is otherwise set up from foo_device_added_cb().
+ */
+static void
+agent_only_device_added_cb (NMClient *client, NMDevice *device, gpointer user_data)
+{
+	NMApplet *applet = NM_APPLET (user_data);
+	NMADeviceClass *dclass;
+
+	if (!NM_IS_DEVICE_MODEM (device))
+		return;
+
+	dclass = get_device_class (device, applet);
+	if (dclass && dclass->device_added)
+		dclass->device_added (device, applet);
+}
+#endif
+
 static void
 register_agent (NMApplet *applet)
 {
@@ -3605,6 +4414,7 @@ register_agent (NMApplet *applet)
 		return;
 	}
 	g_assert (applet->agent);
+	applet_agent_set_client (applet->agent, applet->nm_client);
 	g_signal_connect (applet->agent, APPLET_AGENT_GET_SECRETS,
 	                  G_CALLBACK (applet_agent_get_secrets_cb), applet);
 	g_signal_connect (applet->agent, APPLET_AGENT_CANCEL_SECRETS,
@@ -3660,13 +4470,52 @@ applet_startup (GApplication *app, gpointer user_data)
 {
 	NMApplet *applet = NM_APPLET (app);
 	gs_free_error GError *error = NULL;
+	gint64 begin, phase;
+
+	begin = phase = nma_profile_now ();
 
 	g_set_application_name (_("NetworkManager Applet"));
-	gtk_window_set_default_icon_name ("network-workgroup");
 
 	g_action_map_add_action_entries (G_ACTION_MAP (app), app_entries,
 	                                 G_N_ELEMENTS (app_entries), app);
 
+	phase = nma_profile_now ();
+	applet->gsettings = g_settings_new (APPLET_PREFS_SCHEMA);
+	applet->visible = g_settings_get_boolean (applet->gsettings, PREF_SHOW_APPLET);
+	g_signal_connect (applet->gsettings, "changed::show-applet",
+	                  G_CALLBACK (applet_gsettings_show_changed), applet);
+	notify_prefs_init (applet);
+	nma_profile_mark (phase, "applet", "startup: settings");
+
+	if (agent_only) {
+		/* Just the secret agent and the modems' SIM unlock: no tray
+		 * icon, menus, icons or notifications, and GTK only once a
+		 * dialog is needed.
+		 */
+		phase = nma_profile_now ();
+		applet->nm_client = nm_client_new (NULL, &error);
+		if (!applet->nm_client)
+			g_warning ("Could not connect to NetworkManager: %s", error->message);
+		applet_device_classes_init (applet);
+#if WITH_WWAN
+		if (applet->nm_client) {
+			g_signal_connect (applet->nm_client, "device-added",
+			                  G_CALLBACK (agent_only_device_added_cb),
+			                  applet);
+		}
+		mm1_client_setup (applet);
+#endif
+		register_agent (applet);
+		nma_profile_mark (phase, "applet", "startup: agent");
+
+		g_application_hold (G_APPLICATION (applet));
+		nma_profile_mark (begin, "applet", "startup");
+		return;
+	}
+
+	phase = nma_profile_now ();
+	gtk_window_set_default_icon_name ("network-workgroup");
+
 	applet->info_dialog_ui = gtk_builder_new ();
 
 	if (!gtk_builder_add_from_resource (applet->info_dialog_ui, "/org/freedesktop/network-manager-applet/info.ui", &error)) {
@@ -3674,22 +4523,23 @@ applet_startup (GApplication *app, gpointer user_data)
 		g_application_quit (app);
 		return;
 	}
+	nma_profile_mark (phase, "applet", "startup: ui");
 
-	applet->gsettings = g_settings_new (APPLET_PREFS_SCHEMA);
-	applet->visible = g_settings_get_boolean (applet->gsettings, PREF_SHOW_APPLET);
-	g_signal_connect (applet->gsettings, "changed::show-applet",
-	                  G_CALLBACK (applet_gsettings_show_changed), applet);
-
+	phase = nma_profile_now ();
 	foo_client_setup (applet);
+	nma_profile_mark (phase, "applet", "startup: client");
 
 	/* Load pixmaps and create applet widgets */
+	phase = nma_profile_now ();
 	if (!setup_widgets (applet)) {
 		g_warning ("Could not initialize applet widgets.");
 		g_application_quit (app);
 		return;
 	}
 	g_assert (INDICATOR_ENABLED (applet) || applet->status_icon);
+	nma_profile_mark (phase, "applet", "startup: widgets");
 
+	phase = nma_profile_now ();
 	applet->icon_cache = g_hash_table_new_full (g_str_hash,
 	                                            g_str_equal,
 	                                            g_free,
@@ -3705,25 +4555,16 @@ applet_startup (GApplication *app, gpointer user_data)
 
 
 	nma_icons_init (applet);
+	nma_profile_mark (phase, "applet", "startup: icons");
 
 	/* Initialize device classes */
-	applet->ethernet_class = applet_device_ethernet_get_class (applet);
-	g_assert (applet->ethernet_class);
-
-	applet->wifi_class = applet_device_wifi_get_class (applet);
-	g_assert (applet->wifi_class);
-
-#if WITH_WWAN
-	applet->broadband_class = applet_device_broadband_get_class (applet);
-	g_assert (applet->broadband_class);
-#endif
-
-	applet->bt_class = applet_device_bt_get_class (applet);
-	g_assert (applet->bt_class);
+	phase = nma_profile_now ();
+	applet_device_classes_init (applet);
 
 #if WITH_WWAN
 	mm1_client_setup (applet);
 #endif
+	nma_profile_mark (phase, "applet", "startup: device classes");
 
 	if (applet->status_icon) {
 		/* Track embedding to help debug issues where user has removed the
@@ -3734,10 +4575,14 @@ applet_startup (GApplication *app, gpointer user_data)
 		applet_embedded_cb (G_OBJECT (applet->status_icon), NULL, NULL);
 	}
 
-	if (with_agent)
+	if (with_agent) {
+		phase = nma_profile_now ();
 		register_agent (applet);
+		nma_profile_mark (phase, "applet", "startup: agent");
+	}
 
 	g_application_hold (G_APPLICATION (applet));
+	nma_profile_mark (begin, "applet", "startup");
 }
 
 static void finalize (GObject *object)
@@ -3753,6 +4598,12 @@ static void finalize (GObject *object)
 
 	nm_clear_g_source (&applet->update_icon_id);
 	nm_clear_g_source (&applet->wifi_scan_id);
+	nm_clear_g_source (&applet->prewarm_id);
+	prewarmed_dialog_clear (applet);
+	applet_vpn_request_cache_free (applet);
+	nm_clear_g_source (&applet->flap_timeout_id);
+	g_clear_pointer (&applet->flap_body, g_free);
+	g_clear_pointer (&applet->object_data, g_hash_table_destroy);
 
 #ifdef WITH_APPINDICATOR
 	g_clear_object (&applet->app_indicator);
@@ -3761,6 +4612,7 @@ static void finalize (GObject *object)
 
 	g_clear_object (&applet->status_icon);
 	g_clear_object (&applet->menu);
+	nma_icons_prefetch_cancel (applet);
 	g_clear_pointer (&applet->icon_cache, g_hash_table_destroy);
 
 	//alex: destoy tray icon theme and xsettings
@@ -3776,8 +4628,11 @@ static void finalize (GObject *object)
 	while (g_slist_length (applet->secrets_reqs))
 		applet_secrets_request_free ((SecretsRequest *) applet->secrets_reqs->data);
 
+	nm_clear_g_source (&applet->info_stats_id);
+	applet_info_dialog_free (applet);
 	g_clear_object (&applet->info_dialog_ui);
 	g_clear_object (&applet->gsettings);
+	g_clear_pointer (&applet->notify_prefs, g_hash_table_destroy);
 	g_clear_object (&applet->nm_client);
 
 #if WITH_WWAN
@@ -3792,14 +4647,53 @@ static void finalize (GObject *object)
 static void nma_init (NMApplet *applet)
 {
 	applet->icon_size = 16;
+	applet->object_data = g_hash_table_new_full (NULL, NULL, NULL, object_data_destroy);
 
 	g_signal_connect (applet, "startup", G_CALLBACK (applet_startup), NULL);
 	g_signal_connect (applet, "activate", G_CALLBACK (applet_activate), NULL);
 }
 
+static gboolean
+applet_dbus_register (GApplication *app,
+                      GDBusConnection *connection,
+                      const char *object_path,
+                      GError **error)
+{
+	NMApplet *applet = NM_APPLET (app);
+
+	if (!G_APPLICATION_CLASS (nma_parent_class)->dbus_register (app, connection, object_path, error))
+		return FALSE;
+
+	if (with_stats) {
+		applet->stats_registration_id = applet_stats_register (applet, connection, object_path, error);
+		if (!applet->stats_registration_id)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+applet_dbus_unregister (GApplication *app,
+                        GDBusConnection *connection,
+                        const char *object_path)
+{
+	NMApplet *applet = NM_APPLET (app);
+
+	if (applet->stats_registration_id) {
+		g_dbus_connection_unregister_object (connection, applet->stats_registration_id);
+		applet->stats_registration_id = 0;
+	}
+
+	G_APPLICATION_CLASS (nma_parent_class)->dbus_unregister (app, connection, object_path);
+}
+
 static void nma_class_init (NMAppletClass *klass)
 {
 	GObjectClass *oclass = G_OBJECT_CLASS (klass);
+	GApplicationClass *app_class = G_APPLICATION_CLASS (klass);
 
 	oclass->finalize = finalize;
+	app_class->dbus_register = applet_dbus_register;
+	app_class->dbus_unregister = applet_dbus_unregister;
 }
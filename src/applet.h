@@ -58,6 +58,9 @@ typedef struct {
 #define PREF_DISABLE_WIFI_CREATE                  "disable-wifi-create"
 #define PREF_SUPPRESS_WIFI_NETWORKS_AVAILABLE     "suppress-wireless-networks-available"
 #define PREF_SHOW_APPLET                          "show-applet"
+#define PREF_PREWARM_SECRETS_DIALOGS              "prewarm-secrets-dialogs"
+#define PREF_VPN_SECRETS_CACHE_TIMEOUT            "vpn-secrets-cache-timeout"
+#define PREF_BROADBAND_SIGNAL_HYSTERESIS          "broadband-signal-hysteresis"
 
 #define PREF_DISABLE_REASON_DEVICE_DISCONNECTED     "disable-device-disconnected-notification"
 #define PREF_DISABLE_REASON_SERVICE_STOPPED         "disable-service-stopped-notification"
@@ -123,6 +126,7 @@ typedef struct {
 	char * icon_theme_tray_name; //alex
  	GHashTable *    icon_cache;
 	GHashTable *    icon_cache_tray; //alex
+	gpointer        icon_prefetch;
  	GdkPixbuf *     fallback_icon;
  	int             icon_size;
 
@@ -138,6 +142,13 @@ typedef struct {
 #endif
 	guint           update_menu_id;
 
+	/* Menu statistics, see applet-stats.c */
+	guint           menu_rebuilds;
+	gint64          menu_rebuild_usec;
+	gint64          menu_rebuild_max_usec;
+	guint           menus_alive;
+	guint           stats_registration_id;
+
 	GtkStatusIcon * status_icon;
 
 	GtkWidget *     menu;
@@ -158,10 +169,35 @@ typedef struct {
 	GtkWidget *     connections_menu_item;
 
 	GtkBuilder *    info_dialog_ui;
+	guint           info_stats_id;
+	gpointer        info_dialog_data;
 
 	/* Tracker objects for secrets requests */
 	GSList *        secrets_reqs;
 
+	/* Secrets dialog built ahead of time for the active connection */
+	guint           prewarm_id;
+	GtkWidget *     prewarmed_dialog;
+	NMConnection *  prewarmed_connection;
+	char *          prewarmed_setting;
+
+	/* Recent VPN auth-dialog secrets, see applet-vpn-request.c */
+	gpointer        vpn_secrets_cache;
+
+	/* AppletObjectData by libnm object, see applet_object_data_get() */
+	GHashTable *    object_data;
+
+	/* Notifications: the notification preferences by key, kept up to
+	 * date with GSettings, and the merging of link up/down flapping.
+	 */
+	GHashTable *    notify_prefs;
+	guint           notify_dropped;
+	guint           notify_merged;
+	gint64          flap_window_start;
+	guint           flap_count;
+	guint           flap_timeout_id;
+	char *          flap_body;
+
 	guint           wifi_scan_id;
 } NMApplet;
 
@@ -185,6 +221,9 @@ struct _SecretsRequest {
 
 	NMConnection *connection;
 
+	/* When the request was received, for measuring the time to the dialog */
+	gint64 start_time;
+
 	/* Class-specific stuff */
 	SecretsRequestFreeFunc free_func;
 };
@@ -198,6 +237,45 @@ void applet_secrets_request_complete_setting (SecretsRequest *req,
                                               const char *setting_name,
                                               GError *error);
 void applet_secrets_request_free (SecretsRequest *req);
+GtkWidget *applet_secrets_request_take_prewarmed_dialog (SecretsRequest *req);
+void applet_secrets_request_dialog_shown (SecretsRequest *req, gboolean prewarmed);
+
+/* What the applet keeps for a libnm object it tracks. It's freed when
+ * the object goes away.
+ */
+typedef struct _AppletObjectData AppletObjectData;
+
+struct _AppletObjectData {
+	NMApplet *applet;
+	GObject *object;
+
+	/* NMAccessPoint: utils_hash_ap() of its SSID and security */
+	char *ap_hash;
+
+	/* NMDevice: the active access point, see applet_object_data_set_active_ap() */
+	NMAccessPoint *active_ap;
+	AppletObjectData *active_ap_data;
+	gulong active_ap_strength_id;
+
+	/* NMAccessPoint: the data of the device it's the active AP of */
+	AppletObjectData *active_on;
+
+	/* NMDevice: the device class's per-device data */
+	gpointer device_data;
+	GDestroyNotify device_data_free;
+
+	/* NMVpnConnection: the "state-changed" handler, if watched */
+	gulong vpn_state_id;
+};
+
+AppletObjectData *applet_object_data_get (NMApplet *applet, gpointer object);
+AppletObjectData *applet_object_data_lookup (NMApplet *applet, gpointer object);
+void applet_object_data_set_device_data (AppletObjectData *data,
+                                         gpointer device_data,
+                                         GDestroyNotify device_data_free);
+void applet_object_data_set_active_ap (NMApplet *applet,
+                                       NMDevice *device,
+                                       NMAccessPoint *ap);
 
 struct NMADeviceClass {
 	gboolean       (*new_auto_connection)  (NMDevice *device,
@@ -238,6 +316,13 @@ struct NMADeviceClass {
 	size_t         secrets_request_size;
 	gboolean       (*get_secrets)          (SecretsRequest *req,
 	                                        GError **error);
+
+	/* Optional; builds the dialog get_secrets() would show for a request
+	 * for @setting_name without hints, or returns NULL.
+	 */
+	GtkWidget *    (*new_secrets_dialog)   (NMConnection *connection,
+	                                        const char *setting_name,
+	                                        NMApplet *applet);
 };
 
 GType nma_get_type (void);
@@ -247,6 +332,8 @@ NMApplet *nm_applet_new (void);
 void applet_schedule_update_icon (NMApplet *applet);
 void applet_schedule_update_menu (NMApplet *applet);
 
+gboolean applet_ensure_gtk (NMApplet *applet, GError **error);
+
 NMClient *applet_get_settings (NMApplet *applet);
 
 GPtrArray *applet_get_all_connections (NMApplet *applet);
@@ -285,6 +372,8 @@ void applet_do_notify (NMApplet *applet,
                        const char *icon_name,
                        const char *pref);
 
+gboolean applet_notification_pref_get (NMApplet *applet, const char *pref);
+
 GtkWidget * applet_new_menu_item_helper (NMConnection *connection,
                                          NMConnection *active,
                                          gboolean add_active);
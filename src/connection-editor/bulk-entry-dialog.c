@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Connection editor -- Connection editor for NetworkManager */
+
+#include "nm-default.h"
+
+#include <string.h>
+
+#include "bulk-entry-dialog.h"
+
+/* Entering a bulk of addresses or servers, one per line. Empty lines and
+ * lines starting with '#' are ignored. The whole text is validated in one
+ * pass shortly after the user stops typing; invalid lines are marked and
+ * the OK button is insensitive while there are any. Entries beyond the
+ * maximum, if one is set, are marked the same way.
+ */
+
+#define INFO_TAG "bulk-entry-info"
+
+typedef struct {
+	GtkTextBuffer *buffer;
+	GtkTextTag *error_tag;
+	GtkLabel *status;
+	GtkWidget *ok_button;
+	BulkEntryLineFunc line_func;
+	gpointer user_data;
+	guint max_entries;
+	guint validate_id;
+} BulkEntryInfo;
+
+static void
+info_free (gpointer data)
+{
+	BulkEntryInfo *info = data;
+
+	nm_clear_g_source (&info->validate_id);
+	g_slice_free (BulkEntryInfo, info);
+}
+
+static gboolean
+line_is_entry (const char *line)
+{
+	return line[0] && line[0] != '#';
+}
+
+static gboolean
+validate (gpointer user_data)
+{
+	BulkEntryInfo *info = user_data;
+	GtkTextIter start, end;
+	guint line_num, n_entries = 0, n_invalid = 0, n_excess = 0, first_invalid = 0;
+	gs_free char *first_invalid_text = NULL;
+	gs_free char *status = NULL;
+	gboolean more;
+
+	info->validate_id = 0;
+
+	gtk_text_buffer_get_bounds (info->buffer, &start, &end);
+	gtk_text_buffer_remove_tag (info->buffer, info->error_tag, &start, &end);
+
+	for (line_num = 1, more = TRUE; more; line_num++) {
+		gs_free char *line = NULL;
+
+		end = start;
+		if (!gtk_text_iter_ends_line (&end))
+			gtk_text_iter_forward_to_line_end (&end);
+
+		line = gtk_text_buffer_get_text (info->buffer, &start, &end, FALSE);
+		g_strstrip (line);
+
+		if (line_is_entry (line)) {
+			n_entries++;
+			if (info->max_entries && n_entries > info->max_entries) {
+				gtk_text_buffer_apply_tag (info->buffer, info->error_tag, &start, &end);
+				n_excess++;
+			} else if (!info->line_func (line, info->user_data)) {
+				gtk_text_buffer_apply_tag (info->buffer, info->error_tag, &start, &end);
+				if (!n_invalid++) {
+					first_invalid = line_num;
+					first_invalid_text = g_steal_pointer (&line);
+				}
+			}
+		}
+
+		more = gtk_text_iter_forward_line (&start);
+	}
+
+	if (n_invalid == 1)
+		status = g_strdup_printf (_("Line %u is not valid: “%s”"), first_invalid, first_invalid_text);
+	else if (n_invalid > 1) {
+		status = g_strdup_printf (ngettext ("Line %u is not valid: “%s” (and %u more line)",
+		                                    "Line %u is not valid: “%s” (and %u more lines)",
+		                                    n_invalid - 1),
+		                          first_invalid, first_invalid_text, n_invalid - 1);
+	} else if (n_excess) {
+		status = g_strdup_printf (ngettext ("Only %u entry is allowed",
+		                                    "Only %u entries are allowed",
+		                                    info->max_entries),
+		                          info->max_entries);
+	} else
+		status = g_strdup_printf (ngettext ("%u entry", "%u entries", n_entries), n_entries);
+
+	gtk_label_set_text (info->status, status);
+	gtk_widget_set_sensitive (info->ok_button, n_invalid == 0 && n_excess == 0);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+buffer_changed (GtkTextBuffer *buffer, gpointer user_data)
+{
+	BulkEntryInfo *info = user_data;
+
+	/* Don't re-validate hundreds of lines on each key press */
+	gtk_widget_set_sensitive (info->ok_button, FALSE);
+	nm_clear_g_source (&info->validate_id);
+	info->validate_id = g_timeout_add (200, validate, info);
+}
+
+/**
+ * bulk_entry_dialog_new:
+ * @parent: the parent window
+ * @title: the dialog title
+ * @hint: text describing the expected format of the lines
+ * @text: (allow-none): initial content
+ * @line_func: validates a single line
+ * @user_data: data for @line_func
+ *
+ * Returns: a modal dialog for editing a list of entries, one per line.
+ * Use bulk_entry_dialog_get_lines() to get them after %GTK_RESPONSE_OK.
+ */
+GtkWidget *
+bulk_entry_dialog_new (GtkWindow *parent,
+                       const char *title,
+                       const char *hint,
+                       const char *text,
+                       BulkEntryLineFunc line_func,
+                       gpointer user_data)
+{
+	GtkWidget *dialog, *content, *vbox, *label, *scrolled, *view;
+	BulkEntryInfo *info;
+
+	g_return_val_if_fail (line_func != NULL, NULL);
+
+	dialog = gtk_dialog_new_with_buttons (title,
+	                                      parent,
+	                                      GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+	                                      _("_Cancel"),
+	                                      GTK_RESPONSE_CANCEL,
+	                                      _("_OK"),
+	                                      GTK_RESPONSE_OK,
+	                                      NULL);
+	gtk_window_set_default_size (GTK_WINDOW (dialog), 450, 400);
+
+	content = gtk_dialog_get_content_area (GTK_DIALOG (dialog));
+
+	vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+	gtk_container_set_border_width (GTK_CONTAINER (vbox), 12);
+	gtk_box_pack_start (GTK_BOX (content), vbox, TRUE, TRUE, 0);
+
+	label = gtk_label_new (hint);
+	gtk_misc_set_alignment (GTK_MISC (label), 0, 0.5);
+	gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+	gtk_box_pack_start (GTK_BOX (vbox), label, FALSE, FALSE, 0);
+
+	scrolled = gtk_scrolled_window_new (NULL, NULL);
+	gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scrolled), GTK_SHADOW_IN);
+	gtk_box_pack_start (GTK_BOX (vbox), scrolled, TRUE, TRUE, 0);
+
+	view = gtk_text_view_new ();
+	gtk_container_add (GTK_CONTAINER (scrolled), view);
+
+	info = g_slice_new0 (BulkEntryInfo);
+	info->line_func = line_func;
+	info->user_data = user_data;
+	info->buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+	info->error_tag = gtk_text_buffer_create_tag (info->buffer, NULL,
+	                                              "underline", PANGO_UNDERLINE_ERROR,
+	                                              "foreground", "red",
+	                                              NULL);
+	info->ok_button = gtk_dialog_get_widget_for_response (GTK_DIALOG (dialog), GTK_RESPONSE_OK);
+
+	label = gtk_label_new (NULL);
+	gtk_misc_set_alignment (GTK_MISC (label), 0, 0.5);
+	gtk_label_set_ellipsize (GTK_LABEL (label), PANGO_ELLIPSIZE_END);
+	gtk_box_pack_start (GTK_BOX (vbox), label, FALSE, FALSE, 0);
+	info->status = GTK_LABEL (label);
+
+	g_object_set_data_full (G_OBJECT (dialog), INFO_TAG, info, info_free);
+
+	gtk_text_buffer_set_text (info->buffer, text ?: "", -1);
+	validate (info);
+	g_signal_connect (info->buffer, "changed", G_CALLBACK (buffer_changed), info);
+
+	gtk_widget_show_all (vbox);
+	gtk_widget_grab_focus (view);
+
+	return dialog;
+}
+
+/**
+ * bulk_entry_dialog_set_max_entries:
+ * @dialog: the dialog created by bulk_entry_dialog_new()
+ * @max_entries: the number of entries allowed, or 0 for no limit
+ *
+ * Marks the entries past @max_entries as invalid.
+ */
+void
+bulk_entry_dialog_set_max_entries (GtkWidget *dialog, guint max_entries)
+{
+	BulkEntryInfo *info;
+
+	info = g_object_get_data (G_OBJECT (dialog), INFO_TAG);
+	g_return_if_fail (info != NULL);
+
+	info->max_entries = max_entries;
+	nm_clear_g_source (&info->validate_id);
+	validate (info);
+}
+
+/**
+ * bulk_entry_dialog_get_lines:
+ * @dialog: the dialog created by bulk_entry_dialog_new()
+ *
+ * Returns: (transfer full): the stripped entries, skipping empty lines
+ * and comments.
+ */
+char **
+bulk_entry_dialog_get_lines (GtkWidget *dialog)
+{
+	BulkEntryInfo *info;
+	GtkTextIter start, end;
+	gs_free char *text = NULL;
+	gs_strfreev char **lines = NULL;
+	GPtrArray *entries;
+	guint i;
+
+	info = g_object_get_data (G_OBJECT (dialog), INFO_TAG);
+	g_return_val_if_fail (info != NULL, NULL);
+
+	gtk_text_buffer_get_bounds (info->buffer, &start, &end);
+	text = gtk_text_buffer_get_text (info->buffer, &start, &end, FALSE);
+
+	lines = g_strsplit (text, "\n", -1);
+	entries = g_ptr_array_sized_new (g_strv_length (lines) + 1);
+	for (i = 0; lines[i]; i++) {
+		g_strstrip (lines[i]);
+		if (line_is_entry (lines[i]))
+			g_ptr_array_add (entries, g_strdup (lines[i]));
+	}
+	g_ptr_array_add (entries, NULL);
+
+	return (char **) g_ptr_array_free (entries, FALSE);
+}
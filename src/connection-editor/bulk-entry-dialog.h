@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Connection editor -- Connection editor for NetworkManager */
+
+#ifndef BULK_ENTRY_DIALOG_H
+#define BULK_ENTRY_DIALOG_H
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+/* Returns whether @line (stripped, never empty) is a valid entry */
+typedef gboolean (*BulkEntryLineFunc) (const char *line, gpointer user_data);
+
+GtkWidget *bulk_entry_dialog_new (GtkWindow *parent,
+                                  const char *title,
+                                  const char *hint,
+                                  const char *text,
+                                  BulkEntryLineFunc line_func,
+                                  gpointer user_data);
+
+void bulk_entry_dialog_set_max_entries (GtkWidget *dialog, guint max_entries);
+
+char **bulk_entry_dialog_get_lines (GtkWidget *dialog);
+
+#endif /* BULK_ENTRY_DIALOG_H */
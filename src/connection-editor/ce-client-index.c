@@ -0,0 +1,511 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Connection editor -- Connection editor for NetworkManager */
+
+#include "nm-default.h"
+
+#include "ce-client-index.h"
+
+/* An index of the client's connections and devices, shared by all the pages
+ * of all the editors. It is kept up to date as connections and devices come
+ * and go, so that the pages don't need to scan the whole client each time
+ * they fill a combo box, and the combo boxes bound to its models stay
+ * current while an editor is open.
+ */
+
+#define INDEX_TAG "ce-client-index"
+
+enum {
+	DEVICE_COL_DEVICE,
+};
+
+struct _CEClientIndex {
+	NMClient *client;
+
+	/* connection type -> GPtrArray of NMRemoteConnection */
+	GHashTable *by_type;
+	/* master UUID or interface name -> GPtrArray of NMRemoteConnection */
+	GHashTable *by_master;
+	/* NMRemoteConnection -> ConnectionKeys it is filed under */
+	GHashTable *keys;
+
+	GtkListStore *vpn_store;
+	GtkListStore *device_store;
+};
+
+typedef struct {
+	char *type;
+	char *master;
+} ConnectionKeys;
+
+static void
+connection_keys_free (gpointer data)
+{
+	ConnectionKeys *keys = data;
+
+	g_free (keys->type);
+	g_free (keys->master);
+	g_slice_free (ConnectionKeys, keys);
+}
+
+static void
+bucket_add (GHashTable *table, const char *key, NMRemoteConnection *connection)
+{
+	GPtrArray *bucket;
+
+	bucket = g_hash_table_lookup (table, key);
+	if (!bucket) {
+		bucket = g_ptr_array_new_with_free_func (g_object_unref);
+		g_hash_table_insert (table, g_strdup (key), bucket);
+	}
+	g_ptr_array_add (bucket, g_object_ref (connection));
+}
+
+static void
+bucket_remove (GHashTable *table, const char *key, NMRemoteConnection *connection)
+{
+	GPtrArray *bucket;
+
+	bucket = g_hash_table_lookup (table, key);
+	if (!bucket)
+		return;
+
+	g_ptr_array_remove_fast (bucket, connection);
+	if (!bucket->len)
+		g_hash_table_remove (table, key);
+}
+
+static gboolean
+find_row (GtkListStore *store, int column, gpointer object, GtkTreeIter *iter)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (store);
+
+	if (!gtk_tree_model_get_iter_first (model, iter))
+		return FALSE;
+
+	do {
+		gs_unref_object GObject *candidate = NULL;
+
+		gtk_tree_model_get (model, iter, column, &candidate, -1);
+		if (candidate == object)
+			return TRUE;
+	} while (gtk_tree_model_iter_next (model, iter));
+
+	return FALSE;
+}
+
+static void
+file_connection (CEClientIndex *self, NMRemoteConnection *connection)
+{
+	NMSettingConnection *s_con;
+	ConnectionKeys *keys;
+	GtkTreeIter iter;
+
+	s_con = nm_connection_get_setting_connection (NM_CONNECTION (connection));
+	if (!s_con || !nm_setting_connection_get_connection_type (s_con))
+		return;
+
+	keys = g_slice_new0 (ConnectionKeys);
+	keys->type = g_strdup (nm_setting_connection_get_connection_type (s_con));
+	keys->master = g_strdup (nm_setting_connection_get_master (s_con));
+	g_hash_table_insert (self->keys, connection, keys);
+
+	bucket_add (self->by_type, keys->type, connection);
+	if (keys->master)
+		bucket_add (self->by_master, keys->master, connection);
+
+	if (nm_streq (keys->type, NM_SETTING_VPN_SETTING_NAME)) {
+		if (!find_row (self->vpn_store, CE_CLIENT_INDEX_VPN_COL_CONNECTION, connection, &iter))
+			gtk_list_store_append (self->vpn_store, &iter);
+		gtk_list_store_set (self->vpn_store, &iter,
+		                    CE_CLIENT_INDEX_VPN_COL_ID, nm_setting_connection_get_id (s_con),
+		                    CE_CLIENT_INDEX_VPN_COL_UUID, nm_setting_connection_get_uuid (s_con),
+		                    CE_CLIENT_INDEX_VPN_COL_CONNECTION, connection,
+		                    -1);
+	}
+}
+
+static void
+unfile_connection (CEClientIndex *self, NMRemoteConnection *connection, gboolean keep_row)
+{
+	ConnectionKeys *keys;
+	GtkTreeIter iter;
+
+	keys = g_hash_table_lookup (self->keys, connection);
+	if (!keys)
+		return;
+
+	bucket_remove (self->by_type, keys->type, connection);
+	if (keys->master)
+		bucket_remove (self->by_master, keys->master, connection);
+
+	if (   !keep_row
+	    && nm_streq (keys->type, NM_SETTING_VPN_SETTING_NAME)
+	    && find_row (self->vpn_store, CE_CLIENT_INDEX_VPN_COL_CONNECTION, connection, &iter))
+		gtk_list_store_remove (self->vpn_store, &iter);
+
+	g_hash_table_remove (self->keys, connection);
+}
+
+static void
+connection_changed (NMRemoteConnection *connection, gpointer user_data)
+{
+	CEClientIndex *self = user_data;
+	ConnectionKeys *keys;
+	NMSettingConnection *s_con;
+	gboolean same_type;
+
+	/* Keep the VPN row (and with it the combo box selection) if the
+	 * connection stays a VPN.
+	 */
+	keys = g_hash_table_lookup (self->keys, connection);
+	s_con = nm_connection_get_setting_connection (NM_CONNECTION (connection));
+	same_type =    keys
+	            && s_con
+	            && nm_streq0 (keys->type, nm_setting_connection_get_connection_type (s_con));
+
+	unfile_connection (self, connection, same_type);
+	file_connection (self, connection);
+}
+
+static void
+connection_added (NMClient *client, NMRemoteConnection *connection, gpointer user_data)
+{
+	CEClientIndex *self = user_data;
+
+	if (g_hash_table_contains (self->keys, connection))
+		return;
+
+	file_connection (self, connection);
+	g_signal_connect (connection, NM_CONNECTION_CHANGED,
+	                  G_CALLBACK (connection_changed), self);
+}
+
+static void
+connection_removed (NMClient *client, NMRemoteConnection *connection, gpointer user_data)
+{
+	CEClientIndex *self = user_data;
+
+	g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_changed), self);
+	unfile_connection (self, connection, FALSE);
+}
+
+static void
+device_added (NMClient *client, NMDevice *device, gpointer user_data)
+{
+	CEClientIndex *self = user_data;
+	GtkTreeIter iter;
+
+	if (find_row (self->device_store, DEVICE_COL_DEVICE, device, &iter))
+		return;
+
+	gtk_list_store_insert_with_values (self->device_store, NULL, -1,
+	                                   DEVICE_COL_DEVICE, device,
+	                                   -1);
+}
+
+static void
+device_removed (NMClient *client, NMDevice *device, gpointer user_data)
+{
+	CEClientIndex *self = user_data;
+	GtkTreeIter iter;
+
+	if (find_row (self->device_store, DEVICE_COL_DEVICE, device, &iter))
+		gtk_list_store_remove (self->device_store, &iter);
+}
+
+static void
+ce_client_index_free (gpointer data)
+{
+	CEClientIndex *self = data;
+	GHashTableIter iter;
+	gpointer connection;
+
+	/* The client is going away; its own signal handlers are gone already */
+	g_hash_table_iter_init (&iter, self->keys);
+	while (g_hash_table_iter_next (&iter, &connection, NULL))
+		g_signal_handlers_disconnect_by_func (connection, G_CALLBACK (connection_changed), self);
+
+	g_hash_table_destroy (self->keys);
+	g_hash_table_destroy (self->by_type);
+	g_hash_table_destroy (self->by_master);
+	g_object_unref (self->vpn_store);
+	g_object_unref (self->device_store);
+	g_slice_free (CEClientIndex, self);
+}
+
+/**
+ * ce_client_index_get:
+ * @client: the #NMClient
+ *
+ * Returns: (transfer none): the index for @client, creating it on first use.
+ */
+CEClientIndex *
+ce_client_index_get (NMClient *client)
+{
+	CEClientIndex *self;
+	const GPtrArray *array;
+	int i;
+
+	g_return_val_if_fail (NM_IS_CLIENT (client), NULL);
+
+	self = g_object_get_data (G_OBJECT (client), INDEX_TAG);
+	if (self)
+		return self;
+
+	self = g_slice_new0 (CEClientIndex);
+	self->client = client;
+	self->by_type = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                       g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->by_master = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                         g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->keys = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                    NULL, connection_keys_free);
+	self->vpn_store = gtk_list_store_new (3, G_TYPE_STRING, G_TYPE_STRING, NM_TYPE_REMOTE_CONNECTION);
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (self->vpn_store),
+	                                      CE_CLIENT_INDEX_VPN_COL_ID, GTK_SORT_ASCENDING);
+	self->device_store = gtk_list_store_new (1, NM_TYPE_DEVICE);
+
+	g_object_set_data_full (G_OBJECT (client), INDEX_TAG, self, ce_client_index_free);
+
+	array = nm_client_get_connections (client);
+	for (i = 0; i < array->len; i++)
+		connection_added (client, array->pdata[i], self);
+
+	array = nm_client_get_devices (client);
+	for (i = 0; i < array->len; i++)
+		device_added (client, array->pdata[i], self);
+
+	g_signal_connect (client, NM_CLIENT_CONNECTION_ADDED, G_CALLBACK (connection_added), self);
+	g_signal_connect (client, NM_CLIENT_CONNECTION_REMOVED, G_CALLBACK (connection_removed), self);
+	g_signal_connect (client, NM_CLIENT_DEVICE_ADDED, G_CALLBACK (device_added), self);
+	g_signal_connect (client, NM_CLIENT_DEVICE_REMOVED, G_CALLBACK (device_removed), self);
+
+	return self;
+}
+
+/**
+ * ce_client_index_get_connections_of_type:
+ * @self: the index
+ * @connection_type: a connection type, such as %NM_SETTING_BOND_SETTING_NAME
+ *
+ * Returns: (transfer none): the connections of @connection_type, possibly
+ *   empty. Only valid until the main loop next runs.
+ */
+const GPtrArray *
+ce_client_index_get_connections_of_type (CEClientIndex *self, const char *connection_type)
+{
+	static GPtrArray *empty;
+	GPtrArray *bucket;
+
+	bucket = g_hash_table_lookup (self->by_type, connection_type);
+	if (bucket)
+		return bucket;
+
+	if (!empty)
+		empty = g_ptr_array_new ();
+	return empty;
+}
+
+/**
+ * ce_client_index_get_ports:
+ * @self: the index
+ * @master: the UUID or the interface name of a controller
+ *
+ * Returns: (transfer none): the connections that have @master set as their
+ *   controller, possibly empty. Only valid until the main loop next runs.
+ */
+const GPtrArray *
+ce_client_index_get_ports (CEClientIndex *self, const char *master)
+{
+	static GPtrArray *empty;
+	GPtrArray *bucket = NULL;
+
+	if (master)
+		bucket = g_hash_table_lookup (self->by_master, master);
+	if (bucket)
+		return bucket;
+
+	if (!empty)
+		empty = g_ptr_array_new ();
+	return empty;
+}
+
+/**
+ * ce_client_index_get_parent_connections:
+ * @self: the index
+ * @virtual_type: the setting type of a virtual device, such as
+ *   %NM_TYPE_SETTING_VLAN
+ *
+ * Returns: (transfer container): the connections that are not ports and
+ *   whose type can be a parent of @virtual_type.
+ */
+GPtrArray *
+ce_client_index_get_parent_connections (CEClientIndex *self, GType virtual_type)
+{
+	GHashTableIter iter;
+	const char *type;
+	GPtrArray *bucket, *parents;
+	int i;
+
+	parents = g_ptr_array_new ();
+
+	g_hash_table_iter_init (&iter, self->by_type);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &type, (gpointer *) &bucket)) {
+		if (!nm_utils_check_virtual_device_compatibility (virtual_type,
+		                                                  nm_setting_lookup_type (type)))
+			continue;
+
+		for (i = 0; i < bucket->len; i++) {
+			ConnectionKeys *keys = g_hash_table_lookup (self->keys, bucket->pdata[i]);
+
+			if (!keys->master)
+				g_ptr_array_add (parents, bucket->pdata[i]);
+		}
+	}
+
+	return parents;
+}
+
+/**
+ * ce_client_index_get_vpn_model:
+ * @self: the index
+ *
+ * Returns: (transfer none): a model of the VPN connections, sorted by their
+ *   name. See CE_CLIENT_INDEX_VPN_COL_*.
+ */
+GtkTreeModel *
+ce_client_index_get_vpn_model (CEClientIndex *self)
+{
+	return GTK_TREE_MODEL (self->vpn_store);
+}
+
+typedef struct {
+	GType device_type;
+	char *mac_property;
+} DeviceFilter;
+
+static void
+device_filter_free (gpointer data)
+{
+	DeviceFilter *filter = data;
+
+	g_free (filter->mac_property);
+	g_slice_free (DeviceFilter, filter);
+}
+
+static gboolean
+device_visible (GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data)
+{
+	DeviceFilter *filter = user_data;
+	gs_unref_object NMDevice *device = NULL;
+
+	gtk_tree_model_get (model, iter, DEVICE_COL_DEVICE, &device, -1);
+	if (!device)
+		return FALSE;
+
+	return    filter->device_type == G_TYPE_NONE
+	       || G_TYPE_CHECK_INSTANCE_TYPE (device, filter->device_type);
+}
+
+static void
+device_modify (GtkTreeModel *model,
+               GtkTreeIter *iter,
+               GValue *value,
+               gint column,
+               gpointer user_data)
+{
+	DeviceFilter *filter = user_data;
+	GtkTreeModel *child_model;
+	GtkTreeIter child_iter;
+	gs_unref_object NMDevice *device = NULL;
+	gs_free char *mac = NULL;
+	const char *ifname;
+
+	child_model = gtk_tree_model_filter_get_model (GTK_TREE_MODEL_FILTER (model));
+	gtk_tree_model_filter_convert_iter_to_child_iter (GTK_TREE_MODEL_FILTER (model),
+	                                                  &child_iter, iter);
+	gtk_tree_model_get (child_model, &child_iter, DEVICE_COL_DEVICE, &device, -1);
+	if (!device)
+		return;
+
+	if (NM_IS_DEVICE_BT (device))
+		ifname = nm_device_bt_get_name (NM_DEVICE_BT (device));
+	else
+		ifname = nm_device_get_iface (device);
+
+	if (column == CE_CLIENT_INDEX_DEVICE_COL_IFNAME) {
+		g_value_set_string (value, ifname);
+		return;
+	}
+
+	if (filter->mac_property)
+		g_object_get (G_OBJECT (device), filter->mac_property, &mac, NULL);
+	if (mac && !mac[0])
+		nm_clear_g_free (&mac);
+
+	g_value_take_string (value,
+	                     g_strdup_printf ("%s%s%s%s", ifname ?: "",
+	                                      NM_PRINT_FMT_QUOTED (mac, " (", mac, ")", "")));
+}
+
+/**
+ * ce_client_index_new_device_model:
+ * @self: the index
+ * @device_type: the #NMDevice subtype to include, or %G_TYPE_NONE for all
+ * @mac_property: (allow-none): the device property holding the hardware
+ *   address to show next to the interface name
+ *
+ * Returns: (transfer full): a model of the devices, labeled "ifname (MAC)".
+ *   See CE_CLIENT_INDEX_DEVICE_COL_*.
+ */
+GtkTreeModel *
+ce_client_index_new_device_model (CEClientIndex *self,
+                                  GType device_type,
+                                  const char *mac_property)
+{
+	GtkTreeModel *model;
+	DeviceFilter *filter;
+	GType types[] = { G_TYPE_STRING, G_TYPE_STRING };
+
+	filter = g_slice_new0 (DeviceFilter);
+	filter->device_type = device_type;
+	filter->mac_property = g_strdup (mac_property);
+
+	model = gtk_tree_model_filter_new (GTK_TREE_MODEL (self->device_store), NULL);
+	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (model),
+	                                        device_visible, filter, NULL);
+	gtk_tree_model_filter_set_modify_func (GTK_TREE_MODEL_FILTER (model),
+	                                       G_N_ELEMENTS (types), types,
+	                                       device_modify, filter, device_filter_free);
+	return model;
+}
+
+/**
+ * ce_client_index_get_devices:
+ * @self: the index
+ * @device_type: the #NMDevice subtype to include, or %G_TYPE_NONE for all
+ *
+ * Returns: (transfer container): the devices of @device_type.
+ */
+GPtrArray *
+ce_client_index_get_devices (CEClientIndex *self, GType device_type)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (self->device_store);
+	GtkTreeIter iter;
+	GPtrArray *devices;
+
+	devices = g_ptr_array_new ();
+	if (!gtk_tree_model_get_iter_first (model, &iter))
+		return devices;
+
+	do {
+		gs_unref_object NMDevice *device = NULL;
+
+		gtk_tree_model_get (model, &iter, DEVICE_COL_DEVICE, &device, -1);
+		if (   device_type == G_TYPE_NONE
+		    || G_TYPE_CHECK_INSTANCE_TYPE (device, device_type))
+			g_ptr_array_add (devices, device);
+	} while (gtk_tree_model_iter_next (model, &iter));
+
+	return devices;
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Connection editor -- Connection editor for NetworkManager */
+
+#ifndef __CE_CLIENT_INDEX_H__
+#define __CE_CLIENT_INDEX_H__
+
+#include <gtk/gtk.h>
+
+#include <NetworkManager.h>
+
+/* Columns of the model returned by ce_client_index_get_vpn_model() */
+enum {
+	CE_CLIENT_INDEX_VPN_COL_ID,
+	CE_CLIENT_INDEX_VPN_COL_UUID,
+	CE_CLIENT_INDEX_VPN_COL_CONNECTION,
+};
+
+/* Columns of the models returned by ce_client_index_new_device_model() */
+enum {
+	CE_CLIENT_INDEX_DEVICE_COL_LABEL,
+	CE_CLIENT_INDEX_DEVICE_COL_IFNAME,
+};
+
+typedef struct _CEClientIndex CEClientIndex;
+
+CEClientIndex   *ce_client_index_get (NMClient *client);
+
+const GPtrArray *ce_client_index_get_connections_of_type (CEClientIndex *self,
+                                                          const char *connection_type);
+const GPtrArray *ce_client_index_get_ports (CEClientIndex *self,
+                                            const char *master);
+GPtrArray       *ce_client_index_get_parent_connections (CEClientIndex *self,
+                                                         GType virtual_type);
+
+GtkTreeModel    *ce_client_index_get_vpn_model (CEClientIndex *self);
+GtkTreeModel    *ce_client_index_new_device_model (CEClientIndex *self,
+                                                   GType device_type,
+                                                   const char *mac_property);
+GPtrArray       *ce_client_index_get_devices (CEClientIndex *self,
+                                              GType device_type);
+
+#endif  /* __CE_CLIENT_INDEX_H__ */
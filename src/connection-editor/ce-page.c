@@ -14,6 +14,8 @@
 #include <stdlib.h>
 
 #include "ce-page.h"
+#include "ce-client-index.h"
+#include "profile.h"
 
 G_DEFINE_ABSTRACT_TYPE (CEPage, ce_page, G_TYPE_OBJECT)
 
@@ -158,7 +160,12 @@ ce_page_validate (CEPage *self, NMConnection *connection, GError **error)
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), FALSE);
 
 	if (CE_PAGE_GET_CLASS (self)->ce_page_validate_v) {
-		if (!CE_PAGE_GET_CLASS (self)->ce_page_validate_v (self, connection, error)) {
+		gint64 begin = nma_profile_now ();
+		gboolean valid;
+
+		valid = CE_PAGE_GET_CLASS (self)->ce_page_validate_v (self, connection, error);
+		nma_profile_mark_message (begin, "editor", "validate", "%s", G_OBJECT_TYPE_NAME (self));
+		if (!valid) {
 			if (error && !*error)
 				g_set_error_literal (error, NMA_ERROR, NMA_ERROR_GENERIC, _("unspecified error"));
 			return FALSE;
@@ -183,19 +190,28 @@ ce_page_last_update (CEPage *self, NMConnection *connection, GError **error)
 gboolean
 ce_page_inter_page_change (CEPage *self)
 {
-	gboolean ret = FALSE;
-
 	g_return_val_if_fail (CE_IS_PAGE (self), FALSE);
 
-	if (self->inter_page_change_running)
-		return FALSE;
-
-	self->inter_page_change_running = TRUE;
 	if (CE_PAGE_GET_CLASS (self)->inter_page_change)
-		ret = CE_PAGE_GET_CLASS (self)->inter_page_change (self);
-	self->inter_page_change_running = FALSE;
+		return CE_PAGE_GET_CLASS (self)->inter_page_change (self);
+
+	return FALSE;
+}
+
+guint
+ce_page_get_inter_page_produces (CEPage *self)
+{
+	g_return_val_if_fail (CE_IS_PAGE (self), 0);
+
+	return CE_PAGE_GET_CLASS (self)->inter_page_produces;
+}
+
+guint
+ce_page_get_inter_page_consumes (CEPage *self)
+{
+	g_return_val_if_fail (CE_IS_PAGE (self), 0);
 
-	return ret;
+	return CE_PAGE_GET_CLASS (self)->inter_page_consumes;
 }
 
 static void
@@ -372,59 +388,6 @@ ce_page_interface_name_valid (const char *iface, const char *property_name, GErr
 	return TRUE;
 }
 
-static char **
-_get_device_list (CEPage *self,
-                  GType device_type,
-                  gboolean set_ifname,
-                  const char *mac_property)
-{
-	const GPtrArray *devices;
-	GPtrArray *interfaces;
-	int i;
-
-	g_return_val_if_fail (CE_IS_PAGE (self), NULL);
-	g_return_val_if_fail (set_ifname || mac_property, NULL);
-
-	if (!self->client)
-		return NULL;
-
-	interfaces = g_ptr_array_new ();
-	devices = nm_client_get_devices (self->client);
-	for (i = 0; i < devices->len; i++) {
-		NMDevice *dev = g_ptr_array_index (devices, i);
-		const char *ifname;
-		char *mac = NULL;
-		char *item;
-
-		if (   device_type != G_TYPE_NONE
-		    && !G_TYPE_CHECK_INSTANCE_TYPE (dev, device_type))
-			continue;
-
-		if (device_type == NM_TYPE_DEVICE_BT)
-			ifname = nm_device_bt_get_name (NM_DEVICE_BT (dev));
-		else
-			ifname = nm_device_get_iface (NM_DEVICE (dev));
-		if (mac_property)
-			g_object_get (G_OBJECT (dev), mac_property, &mac, NULL);
-
-		if (mac && !mac[0])
-			nm_clear_g_free (&mac);
-
-		if (set_ifname && mac_property)
-			item = g_strdup_printf ("%s%s%s%s", ifname, NM_PRINT_FMT_QUOTED (mac, " (", mac, ")", ""));
-		else
-			item = g_strdup (set_ifname ? ifname : mac);
-
-		if (item)
-			g_ptr_array_add (interfaces, item);
-
-		g_free (mac);
-	}
-	g_ptr_array_add (interfaces, NULL);
-
-	return (char **)g_ptr_array_free (interfaces, FALSE);
-}
-
 static gboolean
 _device_entry_parse (const char *entry_text, char **first, char **second)
 {
@@ -490,7 +453,9 @@ _device_entries_match (const char *ifname, const char *mac, const char *entry)
 	}
 }
 
-/* Combo box storing ifname and/or MAC */
+/* Combo box storing ifname and/or MAC. The combo box is bound to a model of
+ * the client's devices that is kept up to date while the page is shown.
+ */
 void
 ce_page_setup_device_combo (CEPage *self,
                             GtkComboBox *combo,
@@ -499,12 +464,19 @@ ce_page_setup_device_combo (CEPage *self,
                             const char *mac,
                             const char *mac_property)
 {
-	char **iter, *active_item = NULL;
-	int i, active_idx = -1;
-	char **device_list;
+	gs_unref_object GtkTreeModel *model = NULL;
+	GtkTreeIter iter;
+	GtkWidget *entry;
+	gboolean found = FALSE;
 	char *item;
 
-	device_list = _get_device_list (self, device_type, TRUE, mac_property);
+	g_return_if_fail (CE_IS_PAGE (self));
+
+	if (self->client) {
+		model = ce_client_index_new_device_model (ce_client_index_get (self->client),
+		                                          device_type, mac_property);
+		gtk_combo_box_set_model (combo, model);
+	}
 
 	if (ifname && mac)
 		item = g_strdup_printf ("%s (%s)", ifname, mac);
@@ -513,17 +485,29 @@ ce_page_setup_device_combo (CEPage *self,
 	else
 		item = g_strdup (ifname ? ifname : mac);
 
-	for (iter = device_list, i = 0; iter && *iter; iter++, i++) {
-		gtk_combo_box_text_append_text (GTK_COMBO_BOX_TEXT (combo), *iter);
-		if (_device_entries_match (ifname, mac, *iter)) {
-			active_item = *iter;
-			active_idx = i;
-		}
+	if (model && gtk_tree_model_get_iter_first (model, &iter)) {
+		do {
+			gs_free char *label = NULL;
+
+			gtk_tree_model_get (model, &iter, CE_CLIENT_INDEX_DEVICE_COL_LABEL, &label, -1);
+			if (_device_entries_match (ifname, mac, label)) {
+				gtk_combo_box_set_active_iter (combo, &iter);
+				found = TRUE;
+				break;
+			}
+		} while (gtk_tree_model_iter_next (model, &iter));
+	}
+
+	/* The shared model can't take extra rows; put a device that is not
+	 * present into the entry only.
+	 */
+	if (item && !found) {
+		entry = gtk_bin_get_child (GTK_BIN (combo));
+		if (entry)
+			gtk_entry_set_text (GTK_ENTRY (entry), item);
 	}
-	_set_active_combo_item (combo, item, active_item, active_idx);
 
 	g_free (item);
-	g_strfreev (device_list);
 }
 
 gboolean
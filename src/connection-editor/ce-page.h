@@ -62,7 +62,6 @@ typedef void (*PageNewConnectionFunc) (FUNC_TAG_PAGE_NEW_CONNECTION_IMPL,
 typedef struct {
 	GObject parent;
 
-	gboolean inter_page_change_running;
 	GtkBuilder *builder;
 	GtkWidget *page;
 	char *title;
@@ -82,6 +81,12 @@ typedef struct {
 	gboolean    (*ce_page_validate_v) (CEPage *self, NMConnection *connection, GError **error);
 	gboolean    (*last_update)  (CEPage *self, NMConnection *connection, GError **error);
 	gboolean    (*inter_page_change)  (CEPage *self);
+
+	/* INTER_PAGE_CHANGE_MASK()s of the inter-page values the page sets and
+	 * of those that its inter_page_change() looks at.
+	 */
+	guint inter_page_produces;
+	guint inter_page_consumes;
 } CEPageClass;
 
 typedef CEPage* (*CEPageNewFunc)(NMConnectionEditor *editor,
@@ -114,6 +119,8 @@ const char * ce_page_get_title (CEPage *self);
 gboolean ce_page_validate (CEPage *self, NMConnection *connection, GError **error);
 gboolean ce_page_last_update (CEPage *self, NMConnection *connection, GError **error);
 gboolean ce_page_inter_page_change (CEPage *self);
+guint ce_page_get_inter_page_produces (CEPage *self);
+guint ce_page_get_inter_page_consumes (CEPage *self);
 
 void ce_page_setup_mac_combo (CEPage *self, GtkComboBox *combo,
                               const char *mac, char **mac_list);
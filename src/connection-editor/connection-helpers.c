@@ -167,17 +167,33 @@ vpn_connection_from_file (const char *filename, GError **error)
 {
 	NMConnection *connection = NULL;
 	GSList *iter;
+	guint pass;
 
-	for (iter = vpn_get_plugin_infos (); !connection && iter; iter = iter->next) {
-		NMVpnEditorPlugin *plugin;
+	/* Try the plugins that are already loaded first; only then load the
+	 * others, one at a time, until one of them takes the file. */
+	for (pass = 0; !connection && pass < 2; pass++) {
+		for (iter = vpn_get_plugin_infos (); iter; iter = iter->next) {
+			NMVpnEditorPlugin *plugin;
 
-		plugin = nm_vpn_plugin_info_get_editor_plugin (iter->data);
-		g_clear_error (error);
-		connection = nm_vpn_editor_plugin_import (plugin, filename, error);
-		if (connection)
-			break;
+			plugin = vpn_peek_plugin (iter->data);
+			if ((pass == 0) != !!plugin)
+				continue;
+			if (!plugin)
+				plugin = vpn_get_plugin (iter->data);
+			if (!plugin)
+				continue;
+			if (!(nm_vpn_editor_plugin_get_capabilities (plugin) & NM_VPN_EDITOR_PLUGIN_CAPABILITY_IMPORT))
+				continue;
+			g_clear_error (error);
+			connection = nm_vpn_editor_plugin_import (plugin, filename, error);
+			if (connection)
+				break;
+		}
 	}
 
+	if (!connection && error && !*error)
+		g_set_error_literal (error, NMA_ERROR, NMA_ERROR_GENERIC, _("No VPN plugin could import the file."));
+
 	if (connection) {
 		NMSettingVpn *s_vpn;
 		const char *service_type;
@@ -387,11 +403,35 @@ set_up_connection_type_combo (GtkComboBox *combo,
 		const char *service_type;
 		gboolean is_alias = FALSE;
 
-		plugin = nm_vpn_plugin_info_get_editor_plugin (plugin_info);
-		if (!plugin)
+		service_type = nm_vpn_plugin_info_get_service (plugin_info);
+
+		/* Listing the types must not load every editor plugin. Only the ones
+		 * already loaded can describe their services and add-details; the
+		 * others are listed from their .name file, and loaded once a
+		 * connection of that type is created. */
+		plugin = vpn_peek_plugin (plugin_info);
+		if (!plugin) {
+			const char *name = nm_vpn_plugin_info_get_name (plugin_info);
+
+			if (show_headers)
+				markup = g_markup_printf_escaped ("    %s", name);
+			else
+				markup = g_markup_escape_text (name, -1);
+
+			gtk_list_store_append (model, &iter);
+			gtk_list_store_set (model, &iter,
+			                    COL_MARKUP, markup,
+			                    COL_SENSITIVE, TRUE,
+			                    COL_NEW_FUNC, list[vpn_index].new_connection_func,
+			                    COL_VPN_SERVICE_TYPE, service_type,
+			                    -1);
+			g_free (markup);
+
+			/* Whether it can import is only known once it's loaded. */
+			import_supported = TRUE;
 			continue;
+		}
 
-		service_type = nm_vpn_plugin_info_get_service (plugin_info);
 		aliases = nm_vpn_plugin_info_get_aliases (plugin_info);
 
 		for (;;) {
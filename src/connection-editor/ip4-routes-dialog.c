@@ -19,6 +19,7 @@
 #include <gdk/gdkkeysyms.h>
 
 #include "ip4-routes-dialog.h"
+#include "nm-connection-editor.h"
 #include "utils.h"
 #include "ce-utils.h"
 
@@ -27,6 +28,13 @@
 #define COL_NEXT_HOP 2
 #define COL_METRIC  3
 #define COL_LAST COL_METRIC
+/* The route parsed from the row, or NULL if the row is invalid */
+#define COL_ROUTE   4
+/* A mask of the (1 << column)s that are invalid */
+#define COL_ERRORS  5
+
+#define INVALID_ROWS_TAG "invalid-rows"
+#define IMPORT_CANCELLABLE_TAG "import-cancellable"
 
 /* Variables to temporarily save last edited cell value
  * from routes treeview (cancelling issues) */
@@ -34,14 +42,112 @@ static char *last_edited = NULL; /* cell text */
 static char *last_path = NULL;   /* row in treeview */
 static int last_column = -1;     /* column in treeview */
 
+static guint
+route_row_parse (GtkTreeModel *model, GtkTreeIter *iter, NMIPRoute **out_route)
+{
+	char *addr = NULL, *next_hop = NULL;
+	guint32 prefix = 0;
+	gint64 metric = -1;
+	guint errors = 0;
+
+	*out_route = NULL;
+
+	/* Address */
+	if (!utils_tree_model_get_address (model, iter, COL_ADDRESS, AF_INET, TRUE, &addr, NULL))
+		errors |= (1 << COL_ADDRESS);
+
+	/* Prefix */
+	if (!utils_tree_model_get_ip4_prefix (model, iter, COL_PREFIX, TRUE, &prefix, NULL))
+		errors |= (1 << COL_PREFIX);
+	/* Don't allow zero prefix for now - that's not supported in libnm-util */
+	else if (prefix == 0)
+		errors |= (1 << COL_PREFIX);
+
+	/* Next hop (optional) */
+	if (!utils_tree_model_get_address (model, iter, COL_NEXT_HOP, AF_INET, FALSE, &next_hop, NULL))
+		errors |= (1 << COL_NEXT_HOP);
+
+	/* Metric (optional) */
+	if (!utils_tree_model_get_int64 (model, iter, COL_METRIC, 0, G_MAXUINT32, FALSE, &metric, NULL))
+		errors |= (1 << COL_METRIC);
+
+	if (!errors) {
+		*out_route = nm_ip_route_new (AF_INET, addr, prefix, next_hop, metric, NULL);
+		if (!*out_route)
+			errors |= (1 << COL_ADDRESS);
+	}
+
+	g_free (addr);
+	g_free (next_hop);
+	return errors;
+}
+
+static void
+invalid_rows_adjust (GtkBuilder *builder, int delta)
+{
+	GObject *dialog = gtk_builder_get_object (builder, "ip4_routes_dialog");
+	int invalid_rows = GPOINTER_TO_INT (g_object_get_data (dialog, INVALID_ROWS_TAG));
+
+	g_object_set_data (dialog, INVALID_ROWS_TAG, GINT_TO_POINTER (invalid_rows + delta));
+}
+
+/* Re-parses a row after its text was changed; only that row is looked at,
+ * the dialog keeps count of the invalid ones.
+ */
+static void
+route_row_changed (GtkBuilder *builder, GtkListStore *store, GtkTreeIter *iter)
+{
+	NMIPRoute *route;
+	guint old_errors, errors;
+
+	gtk_tree_model_get (GTK_TREE_MODEL (store), iter, COL_ERRORS, &old_errors, -1);
+	errors = route_row_parse (GTK_TREE_MODEL (store), iter, &route);
+	gtk_list_store_set (store, iter,
+	                    COL_ROUTE, route,
+	                    COL_ERRORS, errors,
+	                    -1);
+	if (route)
+		nm_ip_route_unref (route);
+
+	invalid_rows_adjust (builder, (errors != 0) - (old_errors != 0));
+}
+
+static void
+route_row_append (GtkListStore *store, NMIPRoute *route)
+{
+	struct in_addr tmp_addr;
+	char netmask[INET_ADDRSTRLEN], metric[32];
+	gint64 metric_int;
+
+	tmp_addr.s_addr = nm_utils_ip4_prefix_to_netmask (nm_ip_route_get_prefix (route));
+	if (!inet_ntop (AF_INET, &tmp_addr, netmask, sizeof (netmask)))
+		*netmask = '\0';
+
+	metric_int = nm_ip_route_get_metric (route);
+	if (metric_int >= 0 && metric_int <= G_MAXUINT32)
+		g_snprintf (metric, sizeof (metric), "%lu", (unsigned long) metric_int);
+	else {
+		if (metric_int != -1)
+			g_warning ("invalid metric %lld", (long long int) metric_int);
+		metric[0] = 0;
+	}
+
+	gtk_list_store_insert_with_values (store, NULL, -1,
+	                                   COL_ADDRESS, nm_ip_route_get_dest (route),
+	                                   COL_PREFIX, netmask,
+	                                   COL_NEXT_HOP, nm_ip_route_get_next_hop (route),
+	                                   COL_METRIC, metric,
+	                                   COL_ROUTE, route,
+	                                   COL_ERRORS, 0,
+	                                   -1);
+}
+
 static void
 validate (GtkWidget *dialog)
 {
 	GtkBuilder *builder;
 	GtkWidget *widget;
-	GtkTreeModel *model;
-	GtkTreeIter tree_iter;
-	gboolean valid = FALSE, iter_valid = FALSE;
+	gboolean valid;
 
 	g_return_if_fail (dialog != NULL);
 
@@ -49,41 +155,8 @@ validate (GtkWidget *dialog)
 	g_return_if_fail (builder != NULL);
 	g_return_if_fail (GTK_IS_BUILDER (builder));
 
-	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_routes"));
-	model = gtk_tree_view_get_model (GTK_TREE_VIEW (widget));
-	iter_valid = gtk_tree_model_get_iter_first (model, &tree_iter);
+	valid = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (dialog), INVALID_ROWS_TAG)) == 0;
 
-	while (iter_valid) {
-		char *addr = NULL, *next_hop = NULL;
-		guint32 prefix = 0;
-		gint64 metric = -1;
-
-		/* Address */
-		if (!utils_tree_model_get_address (model, &tree_iter, COL_ADDRESS, AF_INET, TRUE, &addr, NULL))
-			goto done;
-		g_free (addr);
-
-		/* Prefix */
-		if (!utils_tree_model_get_ip4_prefix (model, &tree_iter, COL_PREFIX, TRUE, &prefix, NULL))
-			goto done;
-		/* Don't allow zero prefix for now - that's not supported in libnm-util */
-		if (prefix == 0)
-			goto done;
-
-		/* Next hop (optional) */
-		if (!utils_tree_model_get_address (model, &tree_iter, COL_NEXT_HOP, AF_INET, FALSE, &next_hop, NULL))
-			goto done;
-		g_free (next_hop);
-
-		/* Metric (optional) */
-		if (!utils_tree_model_get_int64 (model, &tree_iter, COL_METRIC, 0, G_MAXUINT32, FALSE, &metric, NULL))
-			goto done;
-
-		iter_valid = gtk_tree_model_iter_next (model, &tree_iter);
-	}
-	valid = TRUE;
-
-done:
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ok_button"));
 	gtk_widget_set_sensitive (widget, valid);
 }
@@ -104,6 +177,7 @@ route_add_clicked (GtkButton *button, gpointer user_data)
 	store = GTK_LIST_STORE (gtk_tree_view_get_model (GTK_TREE_VIEW (widget)));
 	gtk_list_store_append (store, &iter);
 	gtk_list_store_set (store, &iter, COL_ADDRESS, "", -1);
+	route_row_changed (builder, store, &iter);
 
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (widget));
 	gtk_tree_selection_select_iter (selection, &iter);
@@ -145,8 +219,14 @@ route_delete_clicked (GtkButton *button, gpointer user_data)
 	if (!selected_rows)
 		return;
 
-	if (gtk_tree_model_get_iter (model, &iter, (GtkTreePath *) selected_rows->data))
+	if (gtk_tree_model_get_iter (model, &iter, (GtkTreePath *) selected_rows->data)) {
+		guint errors;
+
+		gtk_tree_model_get (model, &iter, COL_ERRORS, &errors, -1);
+		if (errors)
+			invalid_rows_adjust (builder, -1);
 		gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+	}
 
 	g_list_free_full (selected_rows, (GDestroyNotify) gtk_tree_path_free);
 
@@ -186,6 +266,7 @@ cell_editing_canceled (GtkCellRenderer *renderer, gpointer user_data)
 		if (gtk_tree_selection_get_selected (selection, &model, &iter)) {
 			column = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (renderer), "column"));
 			gtk_list_store_set (GTK_LIST_STORE (model), &iter, column, last_edited, -1);
+			route_row_changed (builder, GTK_LIST_STORE (model), &iter);
 		}
 
 		g_free (last_edited);
@@ -233,6 +314,7 @@ cell_edited (GtkCellRendererText *cell,
 
 	gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, path);
 	gtk_list_store_set (store, &iter, column, new_text, -1);
+	route_row_changed (builder, store, &iter);
 
 	/* Move focus to the next/previous column */
 	can_cycle = g_object_get_data (G_OBJECT (cell), DO_NOT_CYCLE_TAG) == NULL;
@@ -534,6 +616,7 @@ tree_view_button_pressed_cb (GtkWidget *widget,
 
 		gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, last_treepath);
 		gtk_list_store_set (store, &iter, last_column, last_edited, -1);
+		route_row_changed (builder, store, &iter);
 		gtk_tree_path_free (last_treepath);
 
 		g_free (last_edited);
@@ -560,30 +643,186 @@ cell_error_data_func (GtkTreeViewColumn *tree_column,
                       gpointer data)
 {
 	guint32 col = GPOINTER_TO_UINT (data);
-	char *value = NULL;
-	char *addr, *next_hop;
-	guint32 prefix;
-	gint64 metric;
-	const char *color = "red";
-	gboolean invalid = FALSE;
-
-	if (col == COL_ADDRESS)
-		invalid = !utils_tree_model_get_address (tree_model, iter, COL_ADDRESS, AF_INET, TRUE, &addr, &value);
-	else if (col == COL_PREFIX)
-		invalid =    !utils_tree_model_get_ip4_prefix (tree_model, iter, COL_PREFIX, TRUE, &prefix, &value)
-		          || prefix == 0;
-	else if (col == COL_NEXT_HOP)
-		invalid = !utils_tree_model_get_address (tree_model, iter, COL_NEXT_HOP, AF_INET, FALSE, &next_hop, &value);
-	else if (col == COL_METRIC)
-		invalid = !utils_tree_model_get_int64 (tree_model, iter, COL_METRIC, 0, G_MAXUINT32, FALSE, &metric, &value);
-	else
-		g_warn_if_reached ();
+	gs_free char *value = NULL;
+	guint errors;
 
-	if (invalid)
-		utils_set_cell_background (cell, color, value);
-	else
+	gtk_tree_model_get (tree_model, iter, COL_ERRORS, &errors, -1);
+
+	if (errors & (1 << col)) {
+		gtk_tree_model_get (tree_model, iter, col, &value, -1);
+		utils_set_cell_background (cell, "red", value);
+	} else
 		utils_set_cell_background (cell, NULL, NULL);
-	g_free (value);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	char *filename;
+	char *text;
+	guint skipped;
+} ImportData;
+
+static void
+import_data_free (ImportData *data)
+{
+	g_free (data->filename);
+	g_free (data->text);
+	g_slice_free (ImportData, data);
+}
+
+static void
+import_thread (GTask *task,
+               gpointer source_object,
+               gpointer task_data,
+               GCancellable *cancellable)
+{
+	ImportData *data = task_data;
+	GError *error = NULL;
+
+	if (data->filename) {
+		if (!g_file_get_contents (data->filename, &data->text, NULL, &error)) {
+			g_task_return_error (task, error);
+			return;
+		}
+	}
+
+	g_task_return_pointer (task,
+	                       utils_parse_ip_routes (data->text, AF_INET, &data->skipped),
+	                       (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+import_done (GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+	GtkWidget *dialog = GTK_WIDGET (source_object);
+	ImportData *data = g_task_get_task_data (G_TASK (result));
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_free_error GError *error = NULL;
+	GtkBuilder *builder;
+	GtkTreeView *tree;
+	GtkListStore *store;
+	guint i;
+
+	routes = g_task_propagate_pointer (G_TASK (result), &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		return;
+
+	g_object_set_data (G_OBJECT (dialog), IMPORT_CANCELLABLE_TAG, NULL);
+
+	if (!routes) {
+		nm_connection_editor_error (GTK_WINDOW (dialog),
+		                            _("Cannot import routes"),
+		                            "%s", error->message);
+		return;
+	}
+
+	builder = g_object_get_data (G_OBJECT (dialog), "builder");
+	tree = GTK_TREE_VIEW (gtk_builder_get_object (builder, "ip4_routes"));
+	store = GTK_LIST_STORE (gtk_tree_view_get_model (tree));
+
+	/* Detach the model so the view doesn't follow each inserted row */
+	g_object_ref (store);
+	gtk_tree_view_set_model (tree, NULL);
+	for (i = 0; i < routes->len; i++)
+		route_row_append (store, routes->pdata[i]);
+	gtk_tree_view_set_model (tree, GTK_TREE_MODEL (store));
+	g_object_unref (store);
+
+	if (data->skipped) {
+		nm_connection_editor_warning (GTK_WINDOW (dialog),
+		                              _("Some routes were not imported"),
+		                              ngettext ("%u line was skipped because it is not a valid static IPv4 route.",
+		                                        "%u lines were skipped because they are not valid static IPv4 routes.",
+		                                        data->skipped),
+		                              data->skipped);
+	}
+
+	validate (dialog);
+}
+
+static void
+import_start (GtkBuilder *builder, char *filename, char *text)
+{
+	GtkWidget *dialog = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_routes_dialog"));
+	GCancellable *cancellable;
+	ImportData *data;
+	GTask *task;
+
+	/* A newer import supersedes a running one */
+	cancellable = g_object_get_data (G_OBJECT (dialog), IMPORT_CANCELLABLE_TAG);
+	if (cancellable)
+		g_cancellable_cancel (cancellable);
+	cancellable = g_cancellable_new ();
+	g_object_set_data_full (G_OBJECT (dialog), IMPORT_CANCELLABLE_TAG,
+	                        cancellable, g_object_unref);
+
+	data = g_slice_new0 (ImportData);
+	data->filename = filename;
+	data->text = text;
+
+	task = g_task_new (dialog, cancellable, import_done, NULL);
+	g_task_set_task_data (task, data, (GDestroyNotify) import_data_free);
+	g_task_run_in_thread (task, import_thread);
+	g_object_unref (task);
+}
+
+static void
+import_cancel (GtkWidget *dialog, gpointer user_data)
+{
+	GCancellable *cancellable;
+
+	cancellable = g_object_get_data (G_OBJECT (dialog), IMPORT_CANCELLABLE_TAG);
+	if (cancellable)
+		g_cancellable_cancel (cancellable);
+}
+
+static void
+route_import_clicked (GtkButton *button, gpointer user_data)
+{
+	GtkBuilder *builder = GTK_BUILDER (user_data);
+	GtkWidget *dialog, *parent;
+	char *filename = NULL;
+
+	parent = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_routes_dialog"));
+	dialog = gtk_file_chooser_dialog_new (_("Select file to import"),
+	                                      GTK_WINDOW (parent),
+	                                      GTK_FILE_CHOOSER_ACTION_OPEN,
+	                                      _("_Cancel"), GTK_RESPONSE_CANCEL,
+	                                      _("_Open"), GTK_RESPONSE_ACCEPT,
+	                                      NULL);
+	gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT)
+		filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+	gtk_widget_destroy (dialog);
+
+	if (filename)
+		import_start (builder, filename, NULL);
+}
+
+static void
+paste_received (GtkClipboard *clipboard, const char *text, gpointer user_data)
+{
+	GtkBuilder *builder = GTK_BUILDER (user_data);
+
+	if (text)
+		import_start (builder, NULL, g_strdup (text));
+	g_object_unref (builder);
+}
+
+static gboolean
+tree_view_key_pressed_cb (GtkWidget *widget, GdkEventKey *event, gpointer user_data)
+{
+	if (   (event->state & GDK_CONTROL_MASK)
+	    && (event->keyval == GDK_KEY_v || event->keyval == GDK_KEY_V)) {
+		gtk_clipboard_request_text (gtk_widget_get_clipboard (widget, GDK_SELECTION_CLIPBOARD),
+		                            paste_received,
+		                            g_object_ref (user_data));
+		return TRUE;
+	}
+
+	return FALSE;
 }
 
 GtkWidget *
@@ -592,7 +831,6 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	GtkBuilder *builder;
 	GtkWidget *dialog, *widget, *ok_button;
 	GtkListStore *store;
-	GtkTreeIter model_iter;
 	GtkTreeSelection *selection;
 	gint offset;
 	GtkTreeViewColumn *column;
@@ -630,40 +868,19 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 
 	ok_button = GTK_WIDGET (gtk_builder_get_object (builder, "ok_button"));
 
-	store = gtk_list_store_new (4, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+	store = gtk_list_store_new (6, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+	                            NM_TYPE_IP_ROUTE, G_TYPE_UINT);
 
 	/* Add existing routes */
 	for (i = 0; i < nm_setting_ip_config_get_num_routes (s_ip4); i++) {
 		NMIPRoute *route = nm_setting_ip_config_get_route (s_ip4, i);
-		struct in_addr tmp_addr;
-		char netmask[INET_ADDRSTRLEN], metric[32];
-		gint64 metric_int;
 
 		if (!route) {
 			g_warning ("%s: empty IP4 route structure!", __func__);
 			continue;
 		}
 
-		tmp_addr.s_addr = nm_utils_ip4_prefix_to_netmask (nm_ip_route_get_prefix (route));
-		if (!inet_ntop (AF_INET, &tmp_addr, netmask, sizeof (netmask)))
-			*netmask = '\0';
-
-		metric_int = nm_ip_route_get_metric (route);
-		if (metric_int >= 0 && metric_int <= G_MAXUINT32)
-			g_snprintf (metric, sizeof (metric), "%lu", (unsigned long) metric_int);
-		else {
-			if (metric_int != -1)
-				g_warning ("invalid metric %lld", (long long int) metric_int);
-			metric[0] = 0;
-		}
-
-		gtk_list_store_append (store, &model_iter);
-		gtk_list_store_set (store, &model_iter,
-		                    COL_ADDRESS, nm_ip_route_get_dest (route),
-		                    COL_PREFIX, netmask,
-		                    COL_NEXT_HOP, nm_ip_route_get_next_hop (route),
-		                    COL_METRIC, metric,
-		                    -1);
+		route_row_append (store, route);
 	}
 
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_routes"));
@@ -685,6 +902,8 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	                                                      NULL);
 	column = gtk_tree_view_get_column (GTK_TREE_VIEW (widget), offset - 1);
 	gtk_tree_view_column_set_expand (GTK_TREE_VIEW_COLUMN (column), TRUE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 100);
 	gtk_tree_view_column_set_clickable (GTK_TREE_VIEW_COLUMN (column), TRUE);
 	gtk_tree_view_column_set_cell_data_func (column, renderer, cell_error_data_func,
 	                                         GUINT_TO_POINTER (COL_ADDRESS), NULL);
@@ -704,6 +923,8 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	                                                      NULL);
 	column = gtk_tree_view_get_column (GTK_TREE_VIEW (widget), offset - 1);
 	gtk_tree_view_column_set_expand (GTK_TREE_VIEW_COLUMN (column), TRUE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 100);
 	gtk_tree_view_column_set_clickable (GTK_TREE_VIEW_COLUMN (column), TRUE);
 	gtk_tree_view_column_set_cell_data_func (column, renderer, cell_error_data_func,
 	                                         GUINT_TO_POINTER (COL_PREFIX), NULL);
@@ -723,6 +944,8 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	                                                      NULL);
 	column = gtk_tree_view_get_column (GTK_TREE_VIEW (widget), offset - 1);
 	gtk_tree_view_column_set_expand (GTK_TREE_VIEW_COLUMN (column), TRUE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 100);
 	gtk_tree_view_column_set_clickable (GTK_TREE_VIEW_COLUMN (column), TRUE);
 	gtk_tree_view_column_set_cell_data_func (column, renderer, cell_error_data_func,
 	                                         GUINT_TO_POINTER (COL_NEXT_HOP), NULL);
@@ -742,10 +965,16 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	                                                      NULL);
 	column = gtk_tree_view_get_column (GTK_TREE_VIEW (widget), offset - 1);
 	gtk_tree_view_column_set_expand (GTK_TREE_VIEW_COLUMN (column), TRUE);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 100);
 	gtk_tree_view_column_set_clickable (GTK_TREE_VIEW_COLUMN (column), TRUE);
 	gtk_tree_view_column_set_cell_data_func (column, renderer, cell_error_data_func,
 	                                         GUINT_TO_POINTER (COL_METRIC), NULL);
 
+	/* All rows are a single line of text; this spares measuring each
+	 * of them, which matters with full routing tables. */
+	gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (widget), TRUE);
+
 	g_object_set_data_full (G_OBJECT (dialog), "renderers", renderers, (GDestroyNotify) g_slist_free);
 
 	selection = gtk_tree_view_get_selection (GTK_TREE_VIEW (widget));
@@ -753,6 +982,7 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	                  G_CALLBACK (list_selection_changed),
 	                  GTK_WIDGET (gtk_builder_get_object (builder, "ip4_route_delete_button")));
 	g_signal_connect (widget, "button-press-event", G_CALLBACK (tree_view_button_pressed_cb), builder);
+	g_signal_connect (widget, "key-press-event", G_CALLBACK (tree_view_key_pressed_cb), builder);
 
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_route_add_button"));
 	gtk_widget_set_sensitive (widget, TRUE);
@@ -762,6 +992,11 @@ ip4_routes_dialog_new (NMSettingIPConfig *s_ip4, gboolean automatic)
 	gtk_widget_set_sensitive (widget, FALSE);
 	g_signal_connect (widget, "clicked", G_CALLBACK (route_delete_clicked), builder);
 
+	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_route_import_button"));
+	g_signal_connect (widget, "clicked", G_CALLBACK (route_import_clicked), builder);
+
+	g_signal_connect (dialog, "destroy", G_CALLBACK (import_cancel), NULL);
+
 	widget = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_ignore_auto_routes"));
 	gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (widget),
 	                              nm_setting_ip_config_get_ignore_auto_routes (s_ip4));
@@ -800,47 +1035,16 @@ ip4_routes_dialog_update_setting (GtkWidget *dialog, NMSettingIPConfig *s_ip4)
 	nm_setting_ip_config_clear_routes (s_ip4);
 
 	while (iter_valid) {
-		char *addr = NULL, *next_hop = NULL;
-		guint32 prefix = 0;
-		gint64 metric = -1;
 		NMIPRoute *route;
 
-		/* Address */
-		if (!utils_tree_model_get_address (model, &tree_iter, COL_ADDRESS, AF_INET, TRUE, &addr, NULL)) {
-			g_warning ("%s: IPv4 address missing or invalid!", __func__);
-			goto next;
-		}
-
-		/* Prefix */
-		if (!utils_tree_model_get_ip4_prefix (model, &tree_iter, COL_PREFIX, TRUE, &prefix, NULL)) {
-			g_warning ("%s: IPv4 prefix/netmask missing or invalid!", __func__);
-			g_free (addr);
-			goto next;
-		}
-
-		/* Next hop (optional) */
-		if (!utils_tree_model_get_address (model, &tree_iter, COL_NEXT_HOP, AF_INET, FALSE, &next_hop, NULL)) {
-			g_warning ("%s: IPv4 next hop invalid!", __func__);
-			g_free (addr);
-			goto next;
-		}
-
-		/* Metric (optional) */
-		if (!utils_tree_model_get_int64 (model, &tree_iter, COL_METRIC, 0, G_MAXUINT32, FALSE, &metric, NULL)) {
-			g_warning ("%s: IPv4 metric invalid!", __func__);
-			g_free (addr);
-			g_free (next_hop);
-			goto next;
-		}
-
-		route = nm_ip_route_new (AF_INET, addr, prefix, next_hop, metric, NULL);
-		nm_setting_ip_config_add_route (s_ip4, route);
-		nm_ip_route_unref (route);
-
-		g_free (addr);
-		g_free (next_hop);
+		/* Rows were parsed as they were edited */
+		gtk_tree_model_get (model, &tree_iter, COL_ROUTE, &route, -1);
+		if (route) {
+			nm_setting_ip_config_add_route (s_ip4, route);
+			nm_ip_route_unref (route);
+		} else
+			g_warning ("%s: IPv4 route missing or invalid!", __func__);
 
-	next:
 		iter_valid = gtk_tree_model_iter_next (model, &tree_iter);
 	}
 
@@ -18,10 +18,12 @@
 #include "nm-connection-editor.h"
 #include "connection-helpers.h"
 #include "vpn-helpers.h"
+#include "profile.h"
 
 #define CONNECTION_LIST_TAG "nm-connection-list"
 
 gboolean nm_ce_keep_above;
+gboolean nm_ce_prefetch_vpn_plugins;
 
 /*************************************************/
 
@@ -229,9 +231,11 @@ main (int argc, char *argv[])
 {
 	gs_unref_object GtkApplication *app = NULL;
 	GOptionContext *opt_ctx;
+	int status;
 	GOptionEntry entries[] = {
 		/* This is not passed over D-Bus. */
 		{ "keep-above", 0, G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &nm_ce_keep_above, NULL, NULL },
+		{ "prefetch-vpn-plugins", 0, 0, G_OPTION_ARG_NONE, &nm_ce_prefetch_vpn_plugins, "Load the VPN plugins of the existing connections in the background", NULL },
 		{ NULL }
 	};
 
@@ -249,6 +253,8 @@ main (int argc, char *argv[])
 	g_option_context_parse (opt_ctx, &argc, &argv, NULL);
 	g_option_context_free (opt_ctx);
 
+	nma_profile_init ();
+
 	g_signal_connect (app, "startup", G_CALLBACK (editor_startup), NULL);
 	g_signal_connect (app, "activate", G_CALLBACK (editor_activate), NULL);
 	g_signal_connect (app, "command-line", G_CALLBACK (editor_command_line), NULL);
@@ -256,5 +262,8 @@ main (int argc, char *argv[])
 	g_unix_signal_add (SIGTERM, signal_handler, app);
 	g_unix_signal_add (SIGINT, signal_handler, app);
 
-	return g_application_run (G_APPLICATION (app), argc, argv);
+	status = g_application_run (G_APPLICATION (app), argc, argv);
+	nma_profile_shutdown ();
+
+	return status;
 }
@@ -52,6 +52,7 @@
 #include "ce-polkit-button.h"
 #include "vpn-helpers.h"
 #include "eap-method.h"
+#include "profile.h"
 
 extern gboolean nm_ce_keep_above;
 
@@ -71,15 +72,57 @@ static gboolean nm_connection_editor_set_connection (NMConnectionEditor *editor,
                                                      NMConnection *connection,
                                                      GError **error);
 
+/* One secrets request, shared by all pages that need the setting */
 struct GetSecretsInfo {
 	NMConnectionEditor *self;
-	CEPage *page;
 	char *setting_name;
-	gboolean canceled;
+	GSList *pages;
+	gint64 start;
 };
 
 #define SECRETS_TAG "secrets-setting-name"
 #define ORDER_TAG "page-order"
+#define PLACEHOLDER_TAG "page-placeholder"
+
+/* Pages that are only constructed once their tab is first selected. None of
+ * them needs secrets, so an unrealized page never leaves its setting without
+ * the secrets that were stored for it. The pages consuming inter-page values
+ * get the most recent ones replayed once constructed, see page_initialized();
+ * if those values would change the page's setting, needed() says so and the
+ * page is constructed right away. The title must match the one the page
+ * constructor passes to ce_page_new().
+ */
+typedef struct {
+	CEPageNewFunc func;
+	const char *title;
+	const char *setting_name;
+	gboolean (*needed) (NMConnectionEditor *editor);
+} LazyPageInfo;
+
+/* The IP pages switch the method of Wi-Fi hotspots to Shared */
+static gboolean
+wifi_hotspot_pending (NMConnectionEditor *editor)
+{
+	gpointer wifi_mode_ap = NULL;
+
+	return    nm_connection_editor_inter_page_get_value (editor, INTER_PAGE_CHANGE_WIFI_MODE, &wifi_mode_ap)
+	       && GPOINTER_TO_UINT (wifi_mode_ap);
+}
+
+static const LazyPageInfo lazy_pages[] = {
+	{ ce_page_dcb_new,         N_("DCB"),           NM_SETTING_DCB_SETTING_NAME },
+	{ ce_page_team_port_new,   N_("Team Port"),     NM_SETTING_TEAM_PORT_SETTING_NAME },
+	{ ce_page_bridge_port_new, N_("Bridge Port"),   NM_SETTING_BRIDGE_PORT_SETTING_NAME },
+	{ ce_page_proxy_new,       N_("Proxy"),         NM_SETTING_PROXY_SETTING_NAME },
+	{ ce_page_ip4_new,         N_("IPv4 Settings"), NM_SETTING_IP4_CONFIG_SETTING_NAME, wifi_hotspot_pending },
+	{ ce_page_ip6_new,         N_("IPv6 Settings"), NM_SETTING_IP6_CONFIG_SETTING_NAME, wifi_hotspot_pending },
+};
+
+typedef struct {
+	const LazyPageInfo *info;
+	int order;
+	GtkWidget *placeholder;
+} DeferredPage;
 
 static void
 nm_connection_editor_update_title (NMConnectionEditor *editor)
@@ -366,6 +409,25 @@ connection_editor_validate (NMConnectionEditor *editor)
 		}
 	}
 
+	/* Pages that were not constructed yet haven't touched their setting;
+	 * verify it as it is in the connection.
+	 */
+	for (iter = editor->deferred_pages; iter; iter = g_slist_next (iter)) {
+		DeferredPage *deferred = iter->data;
+		NMSetting *setting;
+
+		setting = nm_connection_get_setting_by_name (editor->connection,
+		                                             deferred->info->setting_name);
+		if (setting && !nm_setting_verify (setting, editor->connection, &error)) {
+			if (!validation_error) {
+				validation_error = g_strdup_printf (_("Invalid setting %s: %s"),
+				                                    _(deferred->info->title),
+				                                    error->message);
+			}
+			g_clear_error (&error);
+		}
+	}
+
 done:
 	if (g_strcmp0 (validation_error, editor->last_validation_error) != 0) {
 		if (editor->last_validation_error && !validation_error)
@@ -456,12 +518,14 @@ nm_connection_editor_init (NMConnectionEditor *editor)
 	gtk_builder_connect_signals (editor->builder, editor);
 
 	editor->inter_page_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) destroy_inter_page_item);
+	editor->inter_page_last = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) destroy_inter_page_item);
 }
 
 static void
 get_secrets_info_free (GetSecretsInfo *info)
 {
 	g_free (info->setting_name);
+	g_slist_free (info->pages);
 	g_free (info);
 }
 
@@ -481,13 +545,13 @@ dispose (GObject *object)
 	g_slist_free_full (editor->pages, g_object_unref);
 	editor->pages = NULL;
 
-	/* Mark any in-progress secrets call as canceled; it will clean up after itself. */
-	if (editor->secrets_call)
-		editor->secrets_call->canceled = TRUE;
+	g_slist_free_full (editor->deferred_pages, g_free);
+	editor->deferred_pages = NULL;
 
-	while (editor->pending_secrets_calls) {
-		get_secrets_info_free ((GetSecretsInfo *) editor->pending_secrets_calls->data);
-		editor->pending_secrets_calls = g_slist_delete_link (editor->pending_secrets_calls, editor->pending_secrets_calls);
+	/* Cancel the in-progress secrets calls; they clean up after themselves. */
+	if (editor->secrets_cancellable) {
+		g_cancellable_cancel (editor->secrets_cancellable);
+		g_clear_object (&editor->secrets_cancellable);
 	}
 
 	nm_clear_g_source (&editor->validate_id);
@@ -511,6 +575,7 @@ dispose (GObject *object)
 		g_hash_table_destroy (editor->inter_page_hash);
 		editor->inter_page_hash = NULL;
 	}
+	g_clear_pointer (&editor->inter_page_last, g_hash_table_destroy);
 
 	g_slist_free_full (editor->unsupported_properties, g_free);
 	editor->unsupported_properties = NULL;
@@ -659,15 +724,131 @@ populate_connection_ui (NMConnectionEditor *editor)
 	connection_editor_validate (editor);
 }
 
+static gint
+page_order_cmp (gconstpointer a, gconstpointer b)
+{
+	int order_a = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (a), ORDER_TAG));
+	int order_b = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (b), ORDER_TAG));
+
+	return order_a - order_b;
+}
+
+static guint
+inter_page_pending_mask (NMConnectionEditor *editor)
+{
+	GHashTableIter iter;
+	gpointer key;
+	guint mask = 0;
+
+	g_hash_table_iter_init (&iter, editor->inter_page_hash);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		mask |= INTER_PAGE_CHANGE_MASK (GPOINTER_TO_UINT (key));
+	return mask;
+}
+
+/* Whether another page of @pages produces a value that @page consumes */
+static gboolean
+inter_page_has_producer (GSList *pages, CEPage *page)
+{
+	guint consumes = ce_page_get_inter_page_consumes (page);
+	GSList *iter;
+
+	for (iter = pages; iter; iter = g_slist_next (iter)) {
+		if (   iter->data != page
+		    && (ce_page_get_inter_page_produces (iter->data) & consumes))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* Sorts the pages so that the producers of inter-page values come before
+ * their consumers. Mutual dependencies, like the one between the MACsec
+ * and 802.1X pages, are broken in tab order. */
+static GSList *
+inter_page_sort (NMConnectionEditor *editor)
+{
+	GSList *remaining, *sorted = NULL, *iter;
+
+	remaining = g_slist_copy (editor->pages);
+	while (remaining) {
+		for (iter = remaining; iter; iter = g_slist_next (iter)) {
+			if (!inter_page_has_producer (remaining, iter->data))
+				break;
+		}
+		if (!iter)
+			iter = remaining;
+
+		sorted = g_slist_prepend (sorted, iter->data);
+		remaining = g_slist_delete_link (remaining, iter);
+	}
+	return g_slist_reverse (sorted);
+}
+
+static void page_changed (CEPage *page, gpointer user_data);
+static void realize_deferred_page (NMConnectionEditor *editor, DeferredPage *deferred);
+
+/* Lets @page react to the pending inter-page values. The changes it makes
+ * in response are part of the pass that notified it and don't start one
+ * of their own; the values it sets reach the pages after it. */
+static void
+inter_page_notify (NMConnectionEditor *editor, CEPage *page)
+{
+	g_signal_handlers_block_by_func (page, G_CALLBACK (page_changed), editor);
+	ce_page_inter_page_change (page);
+	g_signal_handlers_unblock_by_func (page, G_CALLBACK (page_changed), editor);
+}
+
+/* Notify the pages consuming pending inter-page values, in a single pass
+ * in dependency order. Only the pages consuming a value that is both
+ * pending and producible by @origin (or a page notified before them) are
+ * notified. */
+static void
+inter_page_propagate (NMConnectionEditor *editor, CEPage *origin, guint reachable)
+{
+	GSList *order, *iter;
+
+	if (!reachable || !g_hash_table_size (editor->inter_page_hash))
+		return;
+
+	order = inter_page_sort (editor);
+	for (iter = order; iter; iter = g_slist_next (iter)) {
+		CEPage *consumer = CE_PAGE (iter->data);
+
+		if (consumer == origin)
+			continue;
+		if (!(  ce_page_get_inter_page_consumes (consumer)
+		      & reachable
+		      & inter_page_pending_mask (editor)))
+			continue;
+		inter_page_notify (editor, consumer);
+		reachable |= ce_page_get_inter_page_produces (consumer);
+	}
+	g_slist_free (order);
+
+	/* Construct the deferred pages whose setting the values change; they
+	 * get the values replayed once initialized. */
+	order = NULL;
+	for (iter = editor->deferred_pages; iter; iter = g_slist_next (iter)) {
+		DeferredPage *deferred = iter->data;
+
+		if (   deferred->placeholder
+		    && deferred->info->needed
+		    && deferred->info->needed (editor))
+			order = g_slist_prepend (order, deferred);
+	}
+	order = g_slist_reverse (order);
+	for (iter = order; iter; iter = g_slist_next (iter))
+		realize_deferred_page (editor, iter->data);
+	g_slist_free (order);
+}
+
 static void
 page_changed (CEPage *page, gpointer user_data)
 {
 	NMConnectionEditor *editor = NM_CONNECTION_EDITOR (user_data);
-	GSList *iter;
 
 	/* Do page interdependent changes */
-	for (iter = editor->pages; iter; iter = g_slist_next (iter))
-		ce_page_inter_page_change (CE_PAGE (iter->data));
+	inter_page_propagate (editor, page, ce_page_get_inter_page_produces (page));
 
 	if (editor_is_initialized (editor))
 		nm_connection_editor_inter_page_clear_data (editor);
@@ -685,22 +866,89 @@ idle_validate (gpointer user_data)
 	return FALSE;
 }
 
+static void
+notebook_insert_ordered (NMConnectionEditor *editor,
+                         GtkWidget *widget,
+                         const char *title,
+                         gpointer order)
+{
+	GtkNotebook *notebook;
+	GList *children, *iter;
+	gpointer child_order;
+	int i;
+
+	notebook = GTK_NOTEBOOK (gtk_builder_get_object (editor->builder, "notebook"));
+
+	g_object_set_data (G_OBJECT (widget), ORDER_TAG, order);
+
+	children = gtk_container_get_children (GTK_CONTAINER (notebook));
+	for (iter = children, i = 0; iter; iter = iter->next, i++) {
+		child_order = g_object_get_data (G_OBJECT (iter->data), ORDER_TAG);
+		if (child_order > order)
+			break;
+	}
+	g_list_free (children);
+
+	gtk_notebook_insert_page (notebook, widget, gtk_label_new (title), i);
+}
+
+static void
+notebook_switch_page_cb (GtkNotebook *notebook,
+                         GtkWidget *child,
+                         guint page_num,
+                         gpointer user_data)
+{
+	NMConnectionEditor *editor = NM_CONNECTION_EDITOR (user_data);
+	GSList *iter;
+
+	for (iter = editor->deferred_pages; iter; iter = g_slist_next (iter)) {
+		DeferredPage *deferred = iter->data;
+
+		if (deferred->placeholder == child) {
+			realize_deferred_page (editor, deferred);
+			break;
+		}
+	}
+}
+
 static void
 recheck_initialization (NMConnectionEditor *editor)
 {
 	GtkNotebook *notebook;
 	GtkLabel *label;
+	GSList *iter;
 
 	if (!editor_is_initialized (editor) || editor->init_run)
 		return;
 
 	editor->init_run = TRUE;
 
+	g_debug ("editor: initialized in %" G_GINT64_FORMAT " ms",
+	         (g_get_monotonic_time () - editor->init_start) / 1000);
+
 	populate_connection_ui (editor);
 
+	/* Add empty tabs for the pages that are constructed on demand */
+	for (iter = editor->deferred_pages; iter; iter = g_slist_next (iter)) {
+		DeferredPage *deferred = iter->data;
+
+		deferred->placeholder = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+		gtk_widget_show (deferred->placeholder);
+		notebook_insert_ordered (editor,
+		                         deferred->placeholder,
+		                         _(deferred->info->title),
+		                         GINT_TO_POINTER (deferred->order));
+	}
+
+	/* Hand the values set while the pages were being initialized to the
+	 * pages that depend on them. */
+	inter_page_propagate (editor, NULL, ~0u);
+	nm_connection_editor_inter_page_clear_data (editor);
+
 	/* Show the second page (the connection-type-specific data) first */
 	notebook = GTK_NOTEBOOK (gtk_builder_get_object (editor->builder, "notebook"));
 	gtk_notebook_set_current_page (notebook, 1);
+	g_signal_connect (notebook, "switch-page", G_CALLBACK (notebook_switch_page_cb), editor);
 
 	/* When everything is initialized, re-present the window to ensure it's on top */
 	nm_connection_editor_present (editor);
@@ -738,14 +986,10 @@ static void
 page_initialized (CEPage *page, GError *error, gpointer user_data)
 {
 	NMConnectionEditor *editor = NM_CONNECTION_EDITOR (user_data);
-	GtkNotebook *notebook;
 	GtkWidget *parent;
 	GtkWidget *scrolled;
 	GtkWidget *widget;
-	GtkWidget *label;
-	GList *children, *iter;
-	gpointer order, child_order;
-	int i;
+	GtkWidget *placeholder;
 
 	if (error) {
 		gtk_widget_hide (editor->window);
@@ -757,9 +1001,6 @@ page_initialized (CEPage *page, GError *error, gpointer user_data)
 	}
 
 	/* Add the page to the UI */
-	notebook = GTK_NOTEBOOK (gtk_builder_get_object (editor->builder, "notebook"));
-	label = gtk_label_new (ce_page_get_title (page));
-
 	widget = ce_page_get_page (page);
 	parent = gtk_widget_get_parent (widget);
 	if (parent)
@@ -782,24 +1023,39 @@ page_initialized (CEPage *page, GError *error, gpointer user_data)
 #endif
 	}
 
-	order = g_object_get_data (G_OBJECT (page), ORDER_TAG);
-	g_object_set_data (G_OBJECT (widget), ORDER_TAG, order);
-
-	children = gtk_container_get_children (GTK_CONTAINER (notebook));
-	for (iter = children, i = 0; iter; iter = iter->next, i++) {
-		child_order = g_object_get_data (G_OBJECT (iter->data), ORDER_TAG);
-		if (child_order > order)
-			break;
+	placeholder = g_object_get_data (G_OBJECT (page), PLACEHOLDER_TAG);
+	if (placeholder) {
+		gtk_box_pack_start (GTK_BOX (placeholder), widget, TRUE, TRUE, 0);
+	} else {
+		notebook_insert_ordered (editor,
+		                         widget,
+		                         ce_page_get_title (page),
+		                         g_object_get_data (G_OBJECT (page), ORDER_TAG));
 	}
-	g_list_free (children);
-
-	gtk_notebook_insert_page (notebook, widget, label, i);
 
 	/* Move the page from the initializing list to the main page list */
 	editor->initializing_pages = g_slist_remove (editor->initializing_pages, page);
-	editor->pages = g_slist_append (editor->pages, page);
+	editor->pages = g_slist_insert_sorted (editor->pages, page, page_order_cmp);
+
+	if (placeholder) {
+		GHashTableIter iter;
+		gpointer key, value;
+
+		/* The page missed the inter-page changes made before it was
+		 * constructed; replay the most recent ones it depends on. */
+		g_hash_table_iter_init (&iter, editor->inter_page_last);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			if (ce_page_get_inter_page_consumes (page) & INTER_PAGE_CHANGE_MASK (GPOINTER_TO_UINT (key)))
+				g_hash_table_insert (editor->inter_page_hash, key, value);
+		}
+		if (g_hash_table_size (editor->inter_page_hash)) {
+			inter_page_notify (editor, page);
+			nm_connection_editor_inter_page_clear_data (editor);
+		}
 
-	recheck_initialization (editor);
+		connection_editor_validate (editor);
+	} else
+		recheck_initialization (editor);
 }
 
 static void
@@ -810,8 +1066,6 @@ page_new_editor (CEPage *page, NMConnectionEditor *new_editor, gpointer user_dat
 	g_signal_emit (self, editor_signals[NEW_EDITOR], 0, new_editor);
 }
 
-static void request_secrets (GetSecretsInfo *info);
-
 static void
 get_secrets_cb (GObject *object,
                 GAsyncResult *result,
@@ -822,92 +1076,139 @@ get_secrets_cb (GObject *object,
 	NMConnectionEditor *self;
 	GVariant *secrets;
 	GError *error = NULL;
+	GSList *iter;
+	gint64 now;
 
-	if (info->canceled) {
+	secrets = nm_remote_connection_get_secrets_finish (connection, result, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
 		get_secrets_info_free (info);
 		return;
 	}
 
-	secrets = nm_remote_connection_get_secrets_finish (connection, result, &error);
-
 	self = info->self;
+	now = g_get_monotonic_time ();
+	g_debug ("editor: secrets for '%s' fetched in %" G_GINT64_FORMAT " ms%s",
+	         info->setting_name,
+	         (now - info->start) / 1000,
+	         error ? " (failed)" : "");
+	if (--self->secrets_pending == 0) {
+		g_debug ("editor: secrets prefetch done in %" G_GINT64_FORMAT " ms",
+		         (now - self->secrets_start) / 1000);
+	}
 
-	/* Complete this secrets request; completion can actually dispose of the
-	 * dialog if there was an error.
-	 */
-	self->secrets_call = NULL;
-	ce_page_complete_init (info->page, info->setting_name, secrets, error);
-	get_secrets_info_free (info);
-
-	/* Kick off the next secrets request if there is one queued; if the dialog
-	 * was disposed of by the completion above we don't need to do anything.
+	/* Hand the secrets to the pages that asked for them; completion can
+	 * actually dispose of the dialog if there was an error.
 	 */
-	if (!self->disposed && self->pending_secrets_calls) {
-		self->secrets_call = g_slist_nth_data (self->pending_secrets_calls, 0);
-		self->pending_secrets_calls = g_slist_remove (self->pending_secrets_calls, self->secrets_call);
-
-		request_secrets (self->secrets_call);
+	for (iter = info->pages; iter && !self->disposed; iter = g_slist_next (iter)) {
+		ce_page_complete_init (CE_PAGE (iter->data),
+		                       info->setting_name,
+		                       secrets,
+		                       error ? g_error_copy (error) : NULL);
 	}
+
+	g_clear_error (&error);
+	if (secrets)
+		g_variant_unref (secrets);
+	get_secrets_info_free (info);
 }
 
+/* Kick off the secrets requests that the pages may need to make and let
+ * those that don't need any secrets finish initialization.
+ *
+ * Each secret setting is only requested once, and all requests are made
+ * at the same time. They used to be serialized, as PolicyKit didn't queue
+ * authorization requests, but PolicyKit-gnome 0.95 serializes them itself:
+ * http://git.gnome.org/cgit/PolicyKit-gnome/commit/?id=f32cb7faa7197b9db55b569677732742c3c7fdc1
+ */
 static void
-request_secrets (GetSecretsInfo *info)
+start_pages_init (NMConnectionEditor *editor, GSList *pages)
 {
-	g_return_if_fail (info != NULL);
+	gs_unref_hashtable GHashTable *by_setting = NULL;
+	GSList *requests = NULL;
+	GSList *ready = NULL;
+	GSList *iter;
 
-	nm_remote_connection_get_secrets_async (NM_REMOTE_CONNECTION (info->self->orig_connection),
-	                                        info->setting_name, NULL, get_secrets_cb, info);
-}
+	by_setting = g_hash_table_new (g_str_hash, g_str_equal);
 
-static void
-get_secrets_for_page (NMConnectionEditor *self,
-                      CEPage *page,
-                      const char *setting_name)
-{
-	GetSecretsInfo *info;
-
-	info = g_malloc0 (sizeof (GetSecretsInfo));
-	info->self = self;
-	info->page = page;
-	info->setting_name = g_strdup (setting_name);
-
-	/* PolicyKit doesn't queue up authorization requests internally.  Instead,
-	 * if there's a pending authorization request, subsequent requests for that
-	 * same authorization will return NotAuthorized+Challenge.  That's pretty
-	 * inconvenient and it would be a lot nicer if PK just queued up subsequent
-	 * authorization requests and executed them when the first one was finished.
-	 * But it since it doesn't do that, we have to serialize the authorization
-	 * requests ourselves to get the right authorization result.
-	 */
-	/* NOTE: PolicyKit-gnome 0.95 now serializes auth requests as of this commit:
-	 * http://git.gnome.org/cgit/PolicyKit-gnome/commit/?id=f32cb7faa7197b9db55b569677732742c3c7fdc1
-	 */
+	for (iter = pages; iter; iter = g_slist_next (iter)) {
+		CEPage *page = CE_PAGE (iter->data);
+		const char *setting_name = g_object_get_data (G_OBJECT (page), SECRETS_TAG);
+		GetSecretsInfo *info;
+
+		if (!setting_name || !NM_IS_REMOTE_CONNECTION (editor->orig_connection)) {
+			/* The page doesn't need any secrets, or we can't get them:
+			 * we want to get secrets using ->orig_connection, since that's
+			 * the remote connection which can actually respond to secrets
+			 * requests. ->connection is a plain NMConnection copy of
+			 * ->orig_connection which is what gets changed when users modify
+			 * anything.  But when creating or importing, ->orig_connection
+			 * will be an NMConnection since the new connection hasn't been
+			 * added to NetworkManager yet.
+			 */
+			ready = g_slist_prepend (ready, page);
+			continue;
+		}
 
-	/* If there's already an in-progress call, queue up the new one */
-	if (self->secrets_call)
-		self->pending_secrets_calls = g_slist_append (self->pending_secrets_calls, info);
-	else {
-		/* Request secrets for this page */
-		self->secrets_call = info;
-		request_secrets (info);
+		info = g_hash_table_lookup (by_setting, setting_name);
+		if (!info) {
+			info = g_malloc0 (sizeof (GetSecretsInfo));
+			info->self = editor;
+			info->setting_name = g_strdup (setting_name);
+			g_hash_table_insert (by_setting, info->setting_name, info);
+			requests = g_slist_prepend (requests, info);
+		}
+		info->pages = g_slist_append (info->pages, page);
 	}
+
+	for (iter = pages; iter; iter = g_slist_next (iter))
+		g_object_set_data (G_OBJECT (iter->data), SECRETS_TAG, NULL);
+
+	if (requests) {
+		if (!editor->secrets_cancellable)
+			editor->secrets_cancellable = g_cancellable_new ();
+		if (editor->secrets_pending == 0)
+			editor->secrets_start = g_get_monotonic_time ();
+
+		requests = g_slist_reverse (requests);
+		for (iter = requests; iter; iter = g_slist_next (iter)) {
+			GetSecretsInfo *info = iter->data;
+
+			g_debug ("editor: requesting secrets for '%s'", info->setting_name);
+			info->start = g_get_monotonic_time ();
+			editor->secrets_pending++;
+			nm_remote_connection_get_secrets_async (NM_REMOTE_CONNECTION (editor->orig_connection),
+			                                        info->setting_name,
+			                                        editor->secrets_cancellable,
+			                                        get_secrets_cb,
+			                                        info);
+		}
+		g_slist_free (requests);
+	}
+
+	/* The secrets requests are on their way; complete the other pages
+	 * meanwhile. */
+	ready = g_slist_reverse (ready);
+	for (iter = ready; iter && !editor->disposed; iter = g_slist_next (iter))
+		ce_page_complete_init (CE_PAGE (iter->data), NULL, NULL, NULL);
+	g_slist_free (ready);
 }
 
-static gboolean
-add_page (NMConnectionEditor *editor,
-          CEPageNewFunc func,
-          NMConnection *connection,
-          GError **error)
+static CEPage *
+construct_page (NMConnectionEditor *editor,
+                CEPageNewFunc func,
+                int order,
+                NMConnection *connection,
+                GError **error)
 {
 	CEPage *page;
 	const char *secrets_setting_name = NULL;
-
-	g_return_val_if_fail (editor != NULL, FALSE);
-	g_return_val_if_fail (func != NULL, FALSE);
-	g_return_val_if_fail (connection != NULL, FALSE);
+	gint64 begin = nma_profile_now ();
 
 	page = (*func) (editor, connection, GTK_WINDOW (editor->window), editor->client,
 	                &secrets_setting_name, error);
+	nma_profile_mark_message (begin, "editor", "construct-page", "%s",
+	                          page ? G_OBJECT_TYPE_NAME (page) : "(failed)");
 	if (page) {
 		g_object_set_data_full (G_OBJECT (page),
 		                        SECRETS_TAG,
@@ -915,14 +1216,94 @@ add_page (NMConnectionEditor *editor,
 		                        g_free);
 		g_object_set_data (G_OBJECT (page),
 		                   ORDER_TAG,
-		                   GINT_TO_POINTER (g_slist_length (editor->initializing_pages)));
+		                   GINT_TO_POINTER (order));
 
 		editor->initializing_pages = g_slist_append (editor->initializing_pages, page);
 		g_signal_connect (page, CE_PAGE_CHANGED, G_CALLBACK (page_changed), editor);
 		g_signal_connect (page, CE_PAGE_INITIALIZED, G_CALLBACK (page_initialized), editor);
 		g_signal_connect (page, CE_PAGE_NEW_EDITOR, G_CALLBACK (page_new_editor), editor);
 	}
-	return !!page;
+	return page;
+}
+
+static const LazyPageInfo *
+find_lazy_page (CEPageNewFunc func)
+{
+	int i;
+
+	for (i = 0; i < G_N_ELEMENTS (lazy_pages); i++) {
+		if (lazy_pages[i].func == func)
+			return &lazy_pages[i];
+	}
+
+	return NULL;
+}
+
+static gboolean
+add_page (NMConnectionEditor *editor,
+          CEPageNewFunc func,
+          NMConnection *connection,
+          GError **error)
+{
+	const LazyPageInfo *info;
+	NMSetting *setting;
+	int order;
+
+	g_return_val_if_fail (editor != NULL, FALSE);
+	g_return_val_if_fail (func != NULL, FALSE);
+	g_return_val_if_fail (connection != NULL, FALSE);
+
+	order = editor->n_pages++;
+
+	/* The General page and the first page specific to the connection type
+	 * are always built up front; others are built when they are first
+	 * shown, unless their setting needs the page to fix it up before the
+	 * connection validates.
+	 */
+	info = order >= 2 ? find_lazy_page (func) : NULL;
+	if (info) {
+		setting = nm_connection_get_setting_by_name (connection, info->setting_name);
+		if (!setting || nm_setting_verify (setting, connection, NULL)) {
+			DeferredPage *deferred;
+
+			deferred = g_new0 (DeferredPage, 1);
+			deferred->info = info;
+			deferred->order = order;
+			editor->deferred_pages = g_slist_append (editor->deferred_pages, deferred);
+			return TRUE;
+		}
+	}
+
+	return !!construct_page (editor, func, order, connection, error);
+}
+
+static void
+realize_deferred_page (NMConnectionEditor *editor, DeferredPage *deferred)
+{
+	CEPage *page;
+	GSList *pages;
+	GError *error = NULL;
+
+	editor->deferred_pages = g_slist_remove (editor->deferred_pages, deferred);
+
+	page = construct_page (editor, deferred->info->func, deferred->order,
+	                       editor->connection, &error);
+	if (!page) {
+		nm_connection_editor_error (GTK_WINDOW (editor->window),
+		                            _("Error initializing editor"),
+		                            "%s",
+		                            error ? error->message : _("Unknown error creating connection editor dialog."));
+		g_clear_error (&error);
+		g_free (deferred);
+		return;
+	}
+
+	g_object_set_data (G_OBJECT (page), PLACEHOLDER_TAG, deferred->placeholder);
+	g_free (deferred);
+
+	pages = g_slist_prepend (NULL, page);
+	start_pages_init (editor, pages);
+	g_slist_free (pages);
 }
 
 void
@@ -972,11 +1353,13 @@ nm_connection_editor_set_connection (NMConnectionEditor *editor,
 	const char *connection_type;
 	const char *slave_type;
 	gboolean success = FALSE;
-	GSList *iter, *copy;
+	GSList *copy;
 
 	g_return_val_if_fail (NM_IS_CONNECTION_EDITOR (editor), FALSE);
 	g_return_val_if_fail (NM_IS_CONNECTION (orig_connection), FALSE);
 
+	editor->init_start = g_get_monotonic_time ();
+
 	/* clean previous connection */
 	if (editor->connection)
 		g_object_unref (editor->connection);
@@ -1083,36 +1466,16 @@ nm_connection_editor_set_connection (NMConnectionEditor *editor,
 	    && !add_page (editor, ce_page_ip6_new, editor->connection, error))
 		goto out;
 
+	g_debug ("editor: %u pages constructed in %" G_GINT64_FORMAT " ms",
+	         g_slist_length (editor->initializing_pages),
+	         (g_get_monotonic_time () - editor->init_start) / 1000);
+
 	/* After all pages are created, then kick off secrets requests that any
-	 * the pages may need to make; if they don't need any secrets, then let
-	 * them finish initialization.  The list might get modified during the loop
+	 * the pages may need to make.  The list might get modified during the loop
 	 * which is why copy the list here.
 	 */
 	copy = g_slist_copy (editor->initializing_pages);
-	for (iter = copy; iter; iter = g_slist_next (iter)) {
-		CEPage *page = CE_PAGE (iter->data);
-		const char *setting_name = g_object_get_data (G_OBJECT (page), SECRETS_TAG);
-
-		if (!setting_name) {
-			/* page doesn't need any secrets */
-			ce_page_complete_init (page, NULL, NULL, NULL);
-		} else if (!NM_IS_REMOTE_CONNECTION (editor->orig_connection)) {
-			/* We want to get secrets using ->orig_connection, since that's the
-			 * remote connection which can actually respond to secrets requests.
-			 * ->connection is a plain NMConnection copy of ->orig_connection
-			 * which is what gets changed when users modify anything.  But when
-			 * creating or importing, ->orig_connection will be an NMConnection
-			 * since the new connection hasn't been added to NetworkManager yet.
-			 * So basically, skip requesting secrets if the connection can't
-			 * handle a secrets request.
-			 */
-			ce_page_complete_init (page, setting_name, NULL, NULL);
-		} else {
-			/* Page wants secrets, get them */
-			get_secrets_for_page (editor, page, setting_name);
-		}
-		g_object_set_data (G_OBJECT (page), SECRETS_TAG, NULL);
-	}
+	start_pages_init (editor, copy);
 	g_slist_free (copy);
 
 	/* set the UI */
@@ -1401,6 +1764,7 @@ void
 nm_connection_editor_inter_page_set_value (NMConnectionEditor *editor, InterPageChangeType type, gpointer value)
 {
 	g_hash_table_insert (editor->inter_page_hash, GUINT_TO_POINTER (type), value);
+	g_hash_table_insert (editor->inter_page_last, GUINT_TO_POINTER (type), value);
 }
 
 gboolean
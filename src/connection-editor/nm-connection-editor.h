@@ -36,14 +36,18 @@ typedef struct {
 	NMConnection *orig_connection;
 	gboolean is_new_connection;
 
-	GetSecretsInfo *secrets_call;
-	GSList *pending_secrets_calls;
+	GCancellable *secrets_cancellable;
+	guint secrets_pending;
+	gint64 secrets_start;
+	gint64 init_start;
 
 	GtkWidget *all_checkbutton;
 	NMClientPermissionResult can_modify;
 
 	GSList *initializing_pages;
 	GSList *pages;
+	GSList *deferred_pages;
+	guint n_pages;
 	GtkBuilder *builder;
 	GtkWidget *window;
 	GtkWidget *ok_button;
@@ -61,6 +65,7 @@ typedef struct {
 	char *last_validation_error;
 
 	GHashTable *inter_page_hash;
+	GHashTable *inter_page_last;
 	GSList *unsupported_properties;
 } NMConnectionEditor;
 
@@ -75,6 +80,9 @@ typedef enum {
 	INTER_PAGE_CHANGE_802_1X_ENABLE = 3,
 } InterPageChangeType;
 
+/* For CEPageClass:inter_page_produces and CEPageClass:inter_page_consumes */
+#define INTER_PAGE_CHANGE_MASK(type) (1u << (type))
+
 GType               nm_connection_editor_get_type (void);
 NMConnectionEditor *nm_connection_editor_new (GtkWindow *parent_window,
                                               NMConnection *connection,
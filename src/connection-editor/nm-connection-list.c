@@ -20,8 +20,10 @@
 #include "nm-connection-list.h"
 #include "ce-polkit.h"
 #include "connection-helpers.h"
+#include "vpn-helpers.h"
 
 extern gboolean nm_ce_keep_above;
+extern gboolean nm_ce_prefetch_vpn_plugins;
 
 enum {
 	NEW_EDITOR,
@@ -62,6 +64,12 @@ G_DEFINE_TYPE_WITH_CODE (NMConnectionList, nm_connection_list, GTK_TYPE_APPLICAT
 #define COL_GTYPE1     5
 #define COL_GTYPE2     6
 #define COL_ORDER      7
+#define COL_SORT_KEY   8
+
+/* Connection rows carry COL_ORDER_CONNECTION so that the sort functions can
+ * tell them apart from the connection type rows without fetching the
+ * connection object. */
+#define COL_ORDER_CONNECTION -1
 
 static NMRemoteConnection *
 get_active_connection (GtkTreeView *treeview)
@@ -202,23 +210,25 @@ update_connection_row (NMConnectionList *self,
 {
 	NMConnectionListPrivate *priv = NM_CONNECTION_LIST_GET_PRIVATE (self);
 	NMSettingConnection *s_con;
-	char *last_used, *id;
+	char *last_used, *id, *sort_key;
 
 	s_con = nm_connection_get_setting_connection (NM_CONNECTION (connection));
 	g_assert (s_con);
 
 	last_used = format_last_used (nm_setting_connection_get_timestamp (s_con));
 	id = g_markup_escape_text (nm_setting_connection_get_id (s_con), -1);
+	sort_key = g_utf8_collate_key (nm_setting_connection_get_id (s_con), -1);
 	gtk_tree_store_set (GTK_TREE_STORE (priv->model), iter,
 	                    COL_ID, id,
 	                    COL_LAST_USED, last_used,
 	                    COL_TIMESTAMP, nm_setting_connection_get_timestamp (s_con),
 	                    COL_CONNECTION, connection,
+	                    COL_ORDER, COL_ORDER_CONNECTION,
+	                    COL_SORT_KEY, sort_key,
 	                    -1);
 	g_free (last_used);
 	g_free (id);
-
-	gtk_tree_model_filter_refilter (priv->filter);
+	g_free (sort_key);
 }
 
 static void
@@ -363,8 +373,10 @@ edit_done_cb (NMConnectionEditor *editor, GtkResponseType response, gpointer use
 		NMRemoteConnection *connection = NM_REMOTE_CONNECTION (nm_connection_editor_get_connection (editor));
 		GtkTreeIter iter;
 
-		if (get_iter_for_connection (list, connection, &iter))
+		if (get_iter_for_connection (list, connection, &iter)) {
 			update_connection_row (list, &iter, connection);
+			gtk_tree_model_filter_refilter (NM_CONNECTION_LIST_GET_PRIVATE (list)->filter);
+		}
 	}
 
 	g_object_unref (editor);
@@ -570,15 +582,10 @@ column_header_clicked_cb (GtkTreeViewColumn *treeviewcolumn, gpointer user_data)
 }
 
 static gint
-sort_connection_types (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
+sort_connection_types (GtkTreeSortable *sortable, int order_a, int order_b)
 {
-	GtkTreeSortable *sortable = user_data;
-	int order_a, order_b;
 	GtkSortType order;
 
-	gtk_tree_model_get (model, a, COL_ORDER, &order_a, -1);
-	gtk_tree_model_get (model, b, COL_ORDER, &order_b, -1);
-
 	/* The connection types should stay in the same order regardless of whether
 	 * the table is sorted ascending or descending.
 	 */
@@ -589,51 +596,60 @@ sort_connection_types (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpoi
 		return order_b - order_a;
 }
 
+/* The sort functions below only look at plain columns that are filled in
+ * when a row is added or updated; fetching and reffing the connection objects
+ * on every comparison makes re-sorting large lists noticeably slow. */
+
 static gint
 id_sort_func (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
 {
-	NMConnection *conn_a, *conn_b;
-	gint ret;
+	gs_free char *key_a = NULL;
+	gs_free char *key_b = NULL;
+	int order_a, order_b;
 
-	gtk_tree_model_get (model, a, COL_CONNECTION, &conn_a, -1);
-	gtk_tree_model_get (model, b, COL_CONNECTION, &conn_b, -1);
+	gtk_tree_model_get (model, a,
+	                    COL_ORDER, &order_a,
+	                    COL_SORT_KEY, &key_a,
+	                    -1);
+	gtk_tree_model_get (model, b,
+	                    COL_ORDER, &order_b,
+	                    COL_SORT_KEY, &key_b,
+	                    -1);
 
-	if (!conn_a || !conn_b) {
-		g_assert (!conn_a && !conn_b);
-		return sort_connection_types (model, a, b, user_data);
+	if (order_a != COL_ORDER_CONNECTION || order_b != COL_ORDER_CONNECTION) {
+		g_assert (order_a != COL_ORDER_CONNECTION && order_b != COL_ORDER_CONNECTION);
+		return sort_connection_types (user_data, order_a, order_b);
 	}
 
-	ret = strcmp (nm_connection_get_id (conn_a), nm_connection_get_id (conn_b));
-	g_object_unref (conn_a);
-	g_object_unref (conn_b);
-
-	return ret;
+	return g_strcmp0 (key_a, key_b);
 }
 
 static gint
 timestamp_sort_func (GtkTreeModel *model, GtkTreeIter *a, GtkTreeIter *b, gpointer user_data)
 {
-	NMConnection *conn_a, *conn_b;
 	guint64 time_a, time_b;
+	int order_a, order_b;
 
 	gtk_tree_model_get (model, a,
-	                    COL_CONNECTION, &conn_a,
+	                    COL_ORDER, &order_a,
 	                    COL_TIMESTAMP, &time_a,
 	                    -1);
 	gtk_tree_model_get (model, b,
-	                    COL_CONNECTION, &conn_b,
+	                    COL_ORDER, &order_b,
 	                    COL_TIMESTAMP, &time_b,
 	                    -1);
 
-	if (!conn_a || !conn_b) {
-		g_assert (!conn_a && !conn_b);
-		return sort_connection_types (model, a, b, user_data);
+	if (order_a != COL_ORDER_CONNECTION || order_b != COL_ORDER_CONNECTION) {
+		g_assert (order_a != COL_ORDER_CONNECTION && order_b != COL_ORDER_CONNECTION);
+		return sort_connection_types (user_data, order_a, order_b);
 	}
 
-	g_object_unref (conn_a);
-	g_object_unref (conn_b);
-
-	return time_b - time_a;
+	/* Most recently used first */
+	if (time_a > time_b)
+		return -1;
+	if (time_a < time_b)
+		return 1;
+	return 0;
 }
 
 static gboolean
@@ -752,14 +768,15 @@ initialize_treeview (NMConnectionList *self)
 	int i;
 
 	/* Model */
-	priv->model = GTK_TREE_MODEL (gtk_tree_store_new (8, G_TYPE_STRING,
+	priv->model = GTK_TREE_MODEL (gtk_tree_store_new (9, G_TYPE_STRING,
 	                                                     G_TYPE_STRING,
 	                                                     G_TYPE_UINT64,
 	                                                     G_TYPE_OBJECT,
 	                                                     G_TYPE_GTYPE,
 	                                                     G_TYPE_GTYPE,
 	                                                     G_TYPE_GTYPE,
-	                                                     G_TYPE_INT));
+	                                                     G_TYPE_INT,
+	                                                     G_TYPE_STRING));
 
 	/* Filter */
 	priv->filter = GTK_TREE_MODEL_FILTER (gtk_tree_model_filter_new (priv->model, NULL));
@@ -872,8 +889,10 @@ connection_changed (NMRemoteConnection *connection, gpointer user_data)
 		return;
 	}
 
-	if (get_iter_for_connection (self, connection, &iter))
+	if (get_iter_for_connection (self, connection, &iter)) {
 		update_connection_row (self, &iter, connection);
+		gtk_tree_model_filter_refilter (NM_CONNECTION_LIST_GET_PRIVATE (self)->filter);
+	}
 }
 
 static gboolean
@@ -919,29 +938,13 @@ connection_added (NMClient *client,
 	NMConnectionList *self = NM_CONNECTION_LIST (user_data);
 	NMConnectionListPrivate *priv = NM_CONNECTION_LIST_GET_PRIVATE (self);
 	GtkTreeIter parent_iter, iter;
-	NMSettingConnection *s_con;
-	char *last_used, *id;
 	gboolean expand = TRUE;
 
 	if (!get_parent_iter_for_connection (self, connection, &parent_iter))
 		return;
 
-	s_con = nm_connection_get_setting_connection (NM_CONNECTION (connection));
-
-	last_used = format_last_used (nm_setting_connection_get_timestamp (s_con));
-
-	id = g_markup_escape_text (nm_setting_connection_get_id (s_con), -1);
-
 	gtk_tree_store_append (GTK_TREE_STORE (priv->model), &iter, &parent_iter);
-	gtk_tree_store_set (GTK_TREE_STORE (priv->model), &iter,
-	                    COL_ID, id,
-	                    COL_LAST_USED, last_used,
-	                    COL_TIMESTAMP, nm_setting_connection_get_timestamp (s_con),
-	                    COL_CONNECTION, connection,
-	                    -1);
-
-	g_free (id);
-	g_free (last_used);
+	update_connection_row (self, &iter, connection);
 
 	if (priv->displayed_type) {
 		GType added_type0, added_type1, added_type2;
@@ -1004,6 +1007,9 @@ nm_connection_list_new (void)
 	add_connection_buttons (list);
 	initialize_treeview (list);
 
+	if (nm_ce_prefetch_vpn_plugins)
+		vpn_prefetch_editor_plugins (priv->client);
+
 	if (nm_ce_keep_above)
 		gtk_window_set_keep_above (GTK_WINDOW (list), TRUE);
 
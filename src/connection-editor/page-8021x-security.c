@@ -207,4 +207,6 @@ ce_page_8021x_security_class_init (CEPage8021xSecurityClass *security_class)
 
 	parent_class->ce_page_validate_v = ce_page_validate_v;
 	parent_class->inter_page_change = inter_page_change;
+	parent_class->inter_page_produces = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_802_1X_ENABLE);
+	parent_class->inter_page_consumes = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_MACSEC_MODE);
 }
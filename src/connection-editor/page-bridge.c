@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "page-bridge.h"
+#include "ce-client-index.h"
 #include "nm-connection-editor.h"
 #include "connection-helpers.h"
 
@@ -339,12 +340,11 @@ bridge_connection_new (FUNC_TAG_PAGE_NEW_CONNECTION_IMPL,
 	nm_connection_add_setting (connection, nm_setting_bridge_new ());
 
 	/* Find an available interface name */
-	connections = nm_client_get_connections (client);
+	connections = ce_client_index_get_connections_of_type (ce_client_index_get (client),
+	                                                       NM_SETTING_BRIDGE_SETTING_NAME);
 	for (i = 0; i < connections->len; i++) {
 		conn2 = connections->pdata[i];
 
-		if (!nm_connection_is_type (conn2, NM_SETTING_BRIDGE_SETTING_NAME))
-			continue;
 		iface = nm_connection_get_interface_name (conn2);
 		if (!iface || strncmp (iface, "bridge", 6) != 0 || !g_ascii_isdigit (iface[6]))
 			continue;
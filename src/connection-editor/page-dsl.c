@@ -12,6 +12,7 @@
 #include <linux/if.h>
 
 #include "page-dsl.h"
+#include "ce-client-index.h"
 #include "nm-connection-editor.h"
 #include "nm-utils/nm-shared-utils.h"
 
@@ -46,13 +47,11 @@ find_unused_interface_name (NMClient *client, char *buf, gsize size)
 	gint64 num, ppp_num = 0;
 	int i;
 
-	connections = nm_client_get_connections (client);
+	connections = ce_client_index_get_connections_of_type (ce_client_index_get (client),
+	                                                       NM_SETTING_PPPOE_SETTING_NAME);
 	for (i = 0; i < connections->len; i++) {
 		con = connections->pdata[i];
 
-		if (!nm_connection_is_type (con, NM_SETTING_PPPOE_SETTING_NAME))
-			continue;
-
 		iface = nm_connection_get_interface_name (con);
 		if (iface && g_str_has_prefix (iface, "ppp")) {
 			num = _nm_utils_ascii_str_to_int64 (iface + 3, 10, 0, G_MAXUINT32, -1);
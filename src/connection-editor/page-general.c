@@ -7,6 +7,7 @@
 #include "nm-default.h"
 
 #include "page-general.h"
+#include "ce-client-index.h"
 
 G_DEFINE_TYPE (CEPageGeneral, ce_page_general, CE_TYPE_PAGE)
 
@@ -41,9 +42,10 @@ typedef struct {
 #define FIREWALL_ZONE_DEFAULT _("Default")
 #define FIREWALL_ZONE_TOOLTIP _("The zone defines the trust level of the connection. Default is not a regular zone, selecting it results in the use of the default zone set in the firewall. Only usable if firewalld is active.")
 
+/* Same as the columns of the shared VPN model of CEClientIndex */
 enum {
-	COL_ID,
-	COL_UUID,
+	COL_ID = CE_CLIENT_INDEX_VPN_COL_ID,
+	COL_UUID = CE_CLIENT_INDEX_VPN_COL_UUID,
 };
 
 static void populate_firewall_zones_ui (CEPageGeneral *self);
@@ -244,46 +246,62 @@ populate_ui (CEPageGeneral *self)
 	NMSettingConnection *setting = priv->setting;
 	gboolean secondary_found = FALSE;
 	const char *vpn_uuid;
-	const GPtrArray *con_list;
+	GtkTreeModel *vpn_model;
 	gboolean global_connection = TRUE;
 	GtkTreeIter iter;
-	guint i;
 
 	/* Zones are filled when got them from firewalld */
 	if (priv->got_zones)
 		populate_firewall_zones_ui (self);
 
-	/* Secondary UUID (VPN) */
+	/* Secondary UUID (VPN); the combo box uses the shared, live list of VPN
+	 * connections unless the secondary is not one of them.
+	 */
 	vpn_uuid = nm_setting_connection_get_secondary (setting, 0);
-	con_list = nm_client_get_connections (CE_PAGE (self)->client);
-	for (i = 0; i < con_list->len; i++) {
-		NMConnection *conn = con_list->pdata[i];
-		const char *uuid;
+	vpn_model = ce_client_index_get_vpn_model (ce_client_index_get (CE_PAGE (self)->client));
+	if (gtk_tree_model_get_iter_first (vpn_model, &iter)) {
+		do {
+			gs_free char *uuid = NULL;
+
+			gtk_tree_model_get (vpn_model, &iter, COL_UUID, &uuid, -1);
+			if (nm_streq0 (vpn_uuid, uuid)) {
+				secondary_found = TRUE;
+				break;
+			}
+		} while (gtk_tree_model_iter_next (vpn_model, &iter));
+	}
 
-		if (!nm_connection_is_type (conn, NM_SETTING_VPN_SETTING_NAME))
-			continue;
+	if (secondary_found || !vpn_uuid) {
+		gtk_combo_box_set_model (priv->dependent_vpn, vpn_model);
+		if (secondary_found)
+			gtk_combo_box_set_active_iter (priv->dependent_vpn, &iter);
+		else
+			gtk_combo_box_set_active (priv->dependent_vpn, 0);
+	} else {
+		GtkTreeIter vpn_iter;
+
+		if (gtk_tree_model_get_iter_first (vpn_model, &vpn_iter)) {
+			do {
+				gs_free char *id = NULL;
+				gs_free char *uuid = NULL;
+
+				gtk_tree_model_get (vpn_model, &vpn_iter,
+				                    COL_ID, &id,
+				                    COL_UUID, &uuid,
+				                    -1);
+				gtk_list_store_insert_with_values (priv->dependent_vpn_store, NULL, -1,
+				                                   COL_ID, id,
+				                                   COL_UUID, uuid,
+				                                   -1);
+			} while (gtk_tree_model_iter_next (vpn_model, &vpn_iter));
+		}
 
-		uuid = nm_connection_get_uuid (conn);
 		gtk_list_store_append (priv->dependent_vpn_store, &iter);
 		gtk_list_store_set (priv->dependent_vpn_store, &iter,
-		                    COL_ID, nm_connection_get_id (conn),
-		                    COL_UUID, uuid,
+		                    COL_ID, vpn_uuid,
+		                    COL_UUID, vpn_uuid,
 		                    -1);
-		if (nm_streq0 (vpn_uuid, uuid)) {
-			gtk_combo_box_set_active_iter (GTK_COMBO_BOX (priv->dependent_vpn), &iter);
-			secondary_found = TRUE;
-		}
-	}
-	if (!secondary_found) {
-		if (vpn_uuid) {
-			gtk_list_store_append (priv->dependent_vpn_store, &iter);
-			gtk_list_store_set (priv->dependent_vpn_store, &iter,
-			                    COL_ID, vpn_uuid,
-			                    COL_UUID, vpn_uuid,
-			                    -1);
-			gtk_combo_box_set_active_iter (GTK_COMBO_BOX (priv->dependent_vpn), &iter);
-		} else
-			gtk_combo_box_set_active (GTK_COMBO_BOX (priv->dependent_vpn), 0);
+		gtk_combo_box_set_active_iter (GTK_COMBO_BOX (priv->dependent_vpn), &iter);
 	}
 
 	/* We don't support multiple VPNs at the moment, so hide secondary
@@ -413,8 +431,8 @@ ui_to_setting (CEPageGeneral *self)
 
 	if (   gtk_toggle_button_get_active (priv->dependent_vpn_checkbox)
 	    && gtk_combo_box_get_active_iter (priv->dependent_vpn, &iter)) {
-		gtk_tree_model_get (GTK_TREE_MODEL (priv->dependent_vpn_store), &iter,
-		                                    COL_UUID, &secondaries_uuid, -1);
+		gtk_tree_model_get (gtk_combo_box_get_model (priv->dependent_vpn), &iter,
+		                    COL_UUID, &secondaries_uuid, -1);
 		secondaries[0] = secondaries_uuid;
 	}
 
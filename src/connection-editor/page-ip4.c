@@ -18,6 +18,7 @@
 
 #include "page-ip4.h"
 #include "ip4-routes-dialog.h"
+#include "bulk-entry-dialog.h"
 #include "connection-helpers.h"
 #include "ce-utils.h"
 
@@ -29,6 +30,17 @@ G_DEFINE_TYPE (CEPageIP4, ce_page_ip4, CE_TYPE_PAGE)
 #define COL_PREFIX 1
 #define COL_GATEWAY 2
 #define COL_LAST COL_GATEWAY
+/* The address parsed from the row, NULL if the address or the prefix is invalid */
+#define COL_PARSED 3
+/* A mask of the (1 << column)s that are invalid, plus ERROR_GATEWAY_MISMATCH */
+#define COL_ERRORS 4
+
+/* The gateway is not in the subnet of the address; this is only a warning */
+#define ERROR_GATEWAY_MISMATCH (1 << (COL_LAST + 1))
+#define ROW_INVALID_MASK       ((1 << COL_ADDRESS) | (1 << COL_PREFIX) | (1 << COL_GATEWAY))
+
+/* The number of invalid rows, kept on the address store */
+#define INVALID_ROWS_TAG "invalid-rows"
 
 typedef struct {
 	NMSettingIPConfig *setting;
@@ -44,6 +56,7 @@ typedef struct {
 	GtkWidget *addr_label;
 	GtkButton *addr_add;
 	GtkButton *addr_delete;
+	GtkButton *addr_bulk;
 	GtkTreeView *addr_list;
 	GtkCellRenderer *addr_cells[COL_LAST + 1];
 	GtkTreeModel *addr_saved;
@@ -52,10 +65,13 @@ typedef struct {
 	/* DNS servers */
 	GtkWidget *dns_servers_label;
 	GtkEntry *dns_servers;
+	char **dns_servers_parsed;
+	char *dns_servers_invalid;
 
 	/* Search domains */
 	GtkWidget *dns_searches_label;
 	GtkEntry *dns_searches;
+	char **dns_searches_parsed;
 
 	/* DHCP stuff */
 	GtkWidget *dhcp_client_id_label;
@@ -90,6 +106,273 @@ typedef struct {
 #define IP4_METHOD_SHARED          4
 #define IP4_METHOD_DISABLED        5
 
+static gboolean
+parse_netmask (const char *str, guint32 *prefix)
+{
+	struct in_addr tmp_addr;
+	glong tmp_prefix;
+
+	if (!str || !*str)
+		return FALSE;
+
+	errno = 0;
+
+	/* Is it a prefix? */
+	if (!strchr (str, '.')) {
+		tmp_prefix = strtol (str, NULL, 10);
+		if (!errno && tmp_prefix > 0 && tmp_prefix <= 32) {
+			*prefix = tmp_prefix;
+			return TRUE;
+		}
+	}
+
+	/* Is it a netmask? */
+	if (inet_pton (AF_INET, str, &tmp_addr) > 0) {
+		*prefix = nm_utils_ip4_netmask_to_prefix (tmp_addr.s_addr);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean
+is_address_unspecified (const char *str)
+{
+	struct in_addr addr;
+
+	if (!str)
+		return FALSE;
+
+	return (   inet_pton (AF_INET, str, &addr) == 1
+	        && addr.s_addr == INADDR_ANY);
+}
+
+static gboolean
+gateway_matches_address (const char *gw_str, const char *addr_str, guint32 prefix)
+{
+	struct in_addr gw, addr;
+	guint32 netmask;
+
+	if (!gw_str || inet_pton (AF_INET, gw_str, &gw) != 1)
+		return FALSE;
+	if (!addr_str || inet_pton (AF_INET, addr_str, &addr) != 1)
+		return FALSE;
+
+	netmask = nm_utils_ip4_prefix_to_netmask (prefix);
+	return ((addr.s_addr & netmask) == (gw.s_addr & netmask));
+}
+
+static GtkListStore *
+addr_store_new (void)
+{
+	return gtk_list_store_new (5, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+	                           NM_TYPE_IP_ADDRESS, G_TYPE_UINT);
+}
+
+static guint
+addr_store_get_invalid_rows (GtkTreeModel *model)
+{
+	return GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (model), INVALID_ROWS_TAG));
+}
+
+static void
+addr_store_adjust_invalid_rows (GtkTreeModel *model, int delta)
+{
+	g_object_set_data (G_OBJECT (model), INVALID_ROWS_TAG,
+	                   GUINT_TO_POINTER (addr_store_get_invalid_rows (model) + delta));
+}
+
+static guint
+addr_parse (const char *addr, const char *netmask, const char *gateway, NMIPAddress **out_parsed)
+{
+	guint32 prefix = 0;
+	guint errors = 0;
+
+	*out_parsed = NULL;
+
+	if (   !addr
+	    || !nm_utils_ipaddr_valid (AF_INET, addr)
+	    || is_address_unspecified (addr))
+		errors |= (1 << COL_ADDRESS);
+
+	if (!parse_netmask (netmask, &prefix))
+		errors |= (1 << COL_PREFIX);
+
+	/* Gateway is optional... */
+	if (gateway && *gateway && !nm_utils_ipaddr_valid (AF_INET, gateway))
+		errors |= (1 << COL_GATEWAY);
+
+	if (!(errors & ((1 << COL_ADDRESS) | (1 << COL_PREFIX)))) {
+		*out_parsed = nm_ip_address_new (AF_INET, addr, prefix, NULL);
+
+		/* Check gateway against address and prefix */
+		if (   gateway && *gateway
+		    && !(errors & (1 << COL_GATEWAY))
+		    && !gateway_matches_address (gateway, addr, prefix))
+			errors |= ERROR_GATEWAY_MISMATCH;
+	}
+
+	return errors;
+}
+
+static void
+addr_row_append (GtkListStore *store, const char *addr, const char *netmask, const char *gateway)
+{
+	NMIPAddress *parsed;
+	guint errors;
+
+	errors = addr_parse (addr, netmask, gateway, &parsed);
+	if (errors & ROW_INVALID_MASK)
+		addr_store_adjust_invalid_rows (GTK_TREE_MODEL (store), 1);
+
+	gtk_list_store_insert_with_values (store, NULL, -1,
+	                                   COL_ADDRESS, addr,
+	                                   COL_PREFIX, netmask,
+	                                   COL_GATEWAY, gateway,
+	                                   COL_PARSED, parsed,
+	                                   COL_ERRORS, errors,
+	                                   -1);
+	if (parsed)
+		nm_ip_address_unref (parsed);
+}
+
+/* Re-parses a row after one of its cells was changed */
+static void
+addr_row_update (GtkListStore *store, GtkTreeIter *iter)
+{
+	gs_free char *addr = NULL, *netmask = NULL, *gateway = NULL;
+	NMIPAddress *parsed;
+	guint old_errors, errors;
+
+	gtk_tree_model_get (GTK_TREE_MODEL (store), iter,
+	                    COL_ADDRESS, &addr,
+	                    COL_PREFIX, &netmask,
+	                    COL_GATEWAY, &gateway,
+	                    COL_ERRORS, &old_errors,
+	                    -1);
+
+	errors = addr_parse (addr, netmask, gateway, &parsed);
+	gtk_list_store_set (store, iter,
+	                    COL_PARSED, parsed,
+	                    COL_ERRORS, errors,
+	                    -1);
+	if (parsed)
+		nm_ip_address_unref (parsed);
+
+	addr_store_adjust_invalid_rows (GTK_TREE_MODEL (store),
+	                                  !!(errors & ROW_INVALID_MASK)
+	                                - !!(old_errors & ROW_INVALID_MASK));
+}
+
+static gboolean
+addr_row_remove (GtkListStore *store, GtkTreeIter *iter)
+{
+	guint errors;
+
+	gtk_tree_model_get (GTK_TREE_MODEL (store), iter, COL_ERRORS, &errors, -1);
+	if (errors & ROW_INVALID_MASK)
+		addr_store_adjust_invalid_rows (GTK_TREE_MODEL (store), -1);
+
+	return gtk_list_store_remove (store, iter);
+}
+
+static gboolean
+dns_server_valid (const char *str)
+{
+	struct in_addr tmp_addr;
+
+	return inet_pton (AF_INET, str, &tmp_addr) > 0;
+}
+
+/* Splits the text of the DNS servers entry. Returns %NULL and sets
+ * @out_invalid to the first invalid server, if any.
+ */
+static char **
+parse_dns_servers (const char *text, char **out_invalid)
+{
+	gs_strfreev char **items = NULL;
+	GPtrArray *servers;
+	char **iter;
+
+	servers = g_ptr_array_new_with_free_func (g_free);
+	if (text && *text) {
+		items = g_strsplit_set (text, ", ;:", 0);
+		for (iter = items; *iter; iter++) {
+			char *stripped = g_strstrip (*iter);
+
+			if (!*stripped)
+				continue;
+
+			if (!dns_server_valid (stripped)) {
+				*out_invalid = g_strdup (stripped);
+				g_ptr_array_free (servers, TRUE);
+				return NULL;
+			}
+			g_ptr_array_add (servers, g_strdup (stripped));
+		}
+	}
+	g_ptr_array_add (servers, NULL);
+	return (char **) g_ptr_array_free (servers, FALSE);
+}
+
+static char **
+parse_dns_searches (const char *text)
+{
+	gs_strfreev char **items = NULL;
+	GPtrArray *searches;
+	char **iter;
+
+	searches = g_ptr_array_new ();
+	if (text && *text) {
+		items = g_strsplit_set (text, ", ;:", 0);
+		for (iter = items; *iter; iter++) {
+			char *stripped = g_strstrip (*iter);
+
+			if (*stripped)
+				g_ptr_array_add (searches, g_strdup (stripped));
+		}
+	}
+	g_ptr_array_add (searches, NULL);
+	return (char **) g_ptr_array_free (searches, FALSE);
+}
+
+/* The entries are parsed when they change rather than on each validation,
+ * which happens whenever anything in the editor changes.
+ */
+static void
+dns_servers_parse (CEPageIP4 *self)
+{
+	CEPageIP4Private *priv = CE_PAGE_IP4_GET_PRIVATE (self);
+
+	g_clear_pointer (&priv->dns_servers_parsed, g_strfreev);
+	g_clear_pointer (&priv->dns_servers_invalid, g_free);
+	priv->dns_servers_parsed = parse_dns_servers (gtk_entry_get_text (priv->dns_servers),
+	                                              &priv->dns_servers_invalid);
+}
+
+static void
+dns_searches_parse (CEPageIP4 *self)
+{
+	CEPageIP4Private *priv = CE_PAGE_IP4_GET_PRIVATE (self);
+
+	g_clear_pointer (&priv->dns_searches_parsed, g_strfreev);
+	priv->dns_searches_parsed = parse_dns_searches (gtk_entry_get_text (priv->dns_searches));
+}
+
+static void
+dns_servers_changed (GtkEditable *editable, gpointer user_data)
+{
+	dns_servers_parse (CE_PAGE_IP4 (user_data));
+	ce_page_changed (CE_PAGE (user_data));
+}
+
+static void
+dns_searches_changed (GtkEditable *editable, gpointer user_data)
+{
+	dns_searches_parse (CE_PAGE_IP4 (user_data));
+	ce_page_changed (CE_PAGE (user_data));
+}
+
 static void
 ip4_private_init (CEPageIP4 *self, NMConnection *connection)
 {
@@ -192,6 +475,7 @@ ip4_private_init (CEPageIP4 *self, NMConnection *connection)
 	priv->addr_label = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_addr_label"));
 	priv->addr_add = GTK_BUTTON (gtk_builder_get_object (builder, "ip4_addr_add_button"));
 	priv->addr_delete = GTK_BUTTON (gtk_builder_get_object (builder, "ip4_addr_delete_button"));
+	priv->addr_bulk = GTK_BUTTON (gtk_builder_get_object (builder, "ip4_addr_bulk_button"));
 	priv->addr_list = GTK_TREE_VIEW (gtk_builder_get_object (builder, "ip4_addresses"));
 
 	priv->dns_servers_label = GTK_WIDGET (gtk_builder_get_object (builder, "ip4_dns_servers_label"));
@@ -307,6 +591,7 @@ method_changed (GtkComboBox *combo, gpointer user_data)
 	gtk_widget_set_sensitive (priv->addr_label, addr_enabled);
 	gtk_widget_set_sensitive (GTK_WIDGET (priv->addr_add), addr_enabled);
 	gtk_widget_set_sensitive (GTK_WIDGET (priv->addr_delete), addr_enabled);
+	gtk_widget_set_sensitive (GTK_WIDGET (priv->addr_bulk), addr_enabled);
 	gtk_widget_set_sensitive (GTK_WIDGET (priv->addr_list), addr_enabled);
 
 	if (addr_enabled) {
@@ -319,7 +604,7 @@ method_changed (GtkComboBox *combo, gpointer user_data)
 		if (!priv->addr_saved) {
 			/* Save current entries, set empty list */
 			priv->addr_saved = g_object_ref (gtk_tree_view_get_model (priv->addr_list));
-			store = gtk_list_store_new (3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+			store = addr_store_new ();
 			gtk_tree_view_set_model (priv->addr_list, GTK_TREE_MODEL (store));
 			g_object_unref (store);
 		}
@@ -335,7 +620,7 @@ method_changed (GtkComboBox *combo, gpointer user_data)
 		iter_valid = gtk_tree_model_get_iter_first (model, &iter);
 		for (i = 0; iter_valid; i++) {
 			if (i > 0)
-				iter_valid = gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+				iter_valid = addr_row_remove (GTK_LIST_STORE (model), &iter);
 			else
 				iter_valid = gtk_tree_model_iter_next (model, &iter);
 		}
@@ -398,7 +683,6 @@ populate_ui (CEPageIP4 *self)
 	CEPageIP4Private *priv = CE_PAGE_IP4_GET_PRIVATE (self);
 	NMSettingIPConfig *setting = priv->setting;
 	GtkListStore *store;
-	GtkTreeIter model_iter;
 	int method = IP4_METHOD_AUTO;
 	GString *string = NULL;
 	SetMethodInfo info;
@@ -427,7 +711,7 @@ populate_ui (CEPageIP4 *self)
 	gtk_tree_model_foreach (GTK_TREE_MODEL (priv->method_store), set_method, &info);
 
 	/* Addresses */
-	store = gtk_list_store_new (3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
+	store = addr_store_new ();
 	for (i = 0; i < nm_setting_ip_config_get_num_addresses (setting); i++) {
 		NMIPAddress *addr = nm_setting_ip_config_get_address (setting, i);
 		char buf[32];
@@ -439,13 +723,11 @@ populate_ui (CEPageIP4 *self)
 
 		snprintf (buf, sizeof (buf), "%u", nm_ip_address_get_prefix (addr));
 
-		gtk_list_store_append (store, &model_iter);
-		gtk_list_store_set (store, &model_iter,
-		                    COL_ADDRESS, nm_ip_address_get_address (addr),
-		                    COL_PREFIX, buf,
-		                    /* FIXME */
-		                    COL_GATEWAY, i == 0 ? nm_setting_ip_config_get_gateway (setting) : NULL,
-		                    -1);
+		addr_row_append (store,
+		                 nm_ip_address_get_address (addr),
+		                 buf,
+		                 /* FIXME */
+		                 i == 0 ? nm_setting_ip_config_get_gateway (setting) : NULL);
 	}
 
 	gtk_tree_view_set_model (priv->addr_list, GTK_TREE_MODEL (store));
@@ -479,6 +761,9 @@ populate_ui (CEPageIP4 *self)
 	gtk_entry_set_text (priv->dns_searches, string->str);
 	g_string_free (string, TRUE);
 
+	dns_servers_parse (self);
+	dns_searches_parse (self);
+
 	if ((method == IP4_METHOD_AUTO) || (method == IP4_METHOD_AUTO_ADDRESSES)) {
 		if (nm_setting_ip4_config_get_dhcp_client_id (NM_SETTING_IP4_CONFIG (setting))) {
 			gtk_entry_set_text (priv->dhcp_client_id,
@@ -503,8 +788,9 @@ addr_add_clicked (GtkButton *button, gpointer user_data)
 	GList *cells;
 
 	store = GTK_LIST_STORE (gtk_tree_view_get_model (priv->addr_list));
-	gtk_list_store_append (store, &iter);
-	gtk_list_store_set (store, &iter, COL_ADDRESS, "", -1);
+	addr_row_append (store, "", NULL, NULL);
+	gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL,
+	                               gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL) - 1);
 
 	selection = gtk_tree_view_get_selection (priv->addr_list);
 	gtk_tree_selection_select_iter (selection, &iter);
@@ -544,7 +830,7 @@ addr_delete_clicked (GtkButton *button, gpointer user_data)
 		return;
 
 	if (gtk_tree_model_get_iter (model, &iter, (GtkTreePath *) selected_rows->data))
-		gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+		addr_row_remove (GTK_LIST_STORE (model), &iter);
 
 	g_list_free_full (selected_rows, (GDestroyNotify) gtk_tree_path_free);
 
@@ -557,6 +843,184 @@ addr_delete_clicked (GtkButton *button, gpointer user_data)
 	address_list_changed (user_data);
 }
 
+/* Parses an "address/prefix [gateway]" or "address netmask [gateway]" line */
+static gboolean
+addr_line_parse (const char *line, char **out_addr, char **out_netmask, char **out_gateway)
+{
+	gs_strfreev char **tokens = NULL;
+	const char *words[3] = { NULL };
+	const char *slash;
+	NMIPAddress *parsed;
+	guint i, n = 0, errors;
+
+	tokens = g_strsplit_set (line, " \t", 0);
+	for (i = 0; tokens[i]; i++) {
+		if (!tokens[i][0])
+			continue;
+		if (n == G_N_ELEMENTS (words))
+			return FALSE;
+		words[n++] = tokens[i];
+	}
+	if (!n)
+		return FALSE;
+
+	slash = strchr (words[0], '/');
+	if (slash) {
+		if (n > 2)
+			return FALSE;
+		*out_addr = g_strndup (words[0], slash - words[0]);
+		*out_netmask = g_strdup (slash + 1);
+		*out_gateway = g_strdup (words[1]);
+	} else {
+		if (n < 2)
+			return FALSE;
+		*out_addr = g_strdup (words[0]);
+		*out_netmask = g_strdup (words[1]);
+		*out_gateway = g_strdup (words[2]);
+	}
+
+	errors = addr_parse (*out_addr, *out_netmask, *out_gateway, &parsed);
+	if (parsed)
+		nm_ip_address_unref (parsed);
+	return !(errors & ROW_INVALID_MASK);
+}
+
+static gboolean
+addr_line_valid (const char *line, gpointer user_data)
+{
+	gs_free char *addr = NULL, *netmask = NULL, *gateway = NULL;
+
+	return addr_line_parse (line, &addr, &netmask, &gateway);
+}
+
+static void
+addr_bulk_clicked (GtkButton *button, gpointer user_data)
+{
+	CEPageIP4 *self = CE_PAGE_IP4 (user_data);
+	CEPageIP4Private *priv = CE_PAGE_IP4_GET_PRIVATE (self);
+	GtkListStore *store;
+	GtkTreeIter iter;
+	GtkWidget *dialog, *toplevel;
+	gs_strfreev char **lines = NULL;
+	GString *text;
+	gboolean iter_valid;
+	guint i;
+
+	toplevel = gtk_widget_get_toplevel (CE_PAGE (self)->page);
+	g_return_if_fail (gtk_widget_is_toplevel (toplevel));
+
+	/* Start with the current addresses, including the invalid ones */
+	store = GTK_LIST_STORE (gtk_tree_view_get_model (priv->addr_list));
+	text = g_string_new (NULL);
+	iter_valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+	while (iter_valid) {
+		gs_free char *addr = NULL, *netmask = NULL, *gateway = NULL;
+
+		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
+		                    COL_ADDRESS, &addr,
+		                    COL_PREFIX, &netmask,
+		                    COL_GATEWAY, &gateway,
+		                    -1);
+		g_string_append_printf (text, "%s/%s", addr ?: "", netmask ?: "");
+		if (gateway && *gateway)
+			g_string_append_printf (text, " %s", gateway);
+		g_string_append_c (text, '\n');
+
+		iter_valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+	}
+
+	dialog = bulk_entry_dialog_new (GTK_WINDOW (toplevel),
+	                                _("Edit IPv4 Addresses"),
+	                                _("Enter one address per line, as “address/prefix [gateway]” or “address netmask [gateway]”."),
+	                                text->str,
+	                                addr_line_valid,
+	                                NULL);
+	g_string_free (text, TRUE);
+
+	/* Only one address is allowed in shared mode */
+	if (priv->addr_method == IP4_METHOD_SHARED)
+		bulk_entry_dialog_set_max_entries (dialog, 1);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_OK)
+		lines = bulk_entry_dialog_get_lines (dialog);
+	gtk_widget_destroy (dialog);
+
+	if (!lines)
+		return;
+
+	/* Refill the store in one go, with the view detached */
+	g_object_ref (store);
+	gtk_tree_view_set_model (priv->addr_list, NULL);
+	g_signal_handlers_block_by_func (store, ce_page_changed, self);
+
+	gtk_list_store_clear (store);
+	g_object_set_data (G_OBJECT (store), INVALID_ROWS_TAG, NULL);
+	for (i = 0; lines[i]; i++) {
+		gs_free char *addr = NULL, *netmask = NULL, *gateway = NULL;
+
+		if (!addr_line_parse (lines[i], &addr, &netmask, &gateway))
+			continue;
+		addr_row_append (store, addr, netmask, gateway);
+	}
+
+	g_signal_handlers_unblock_by_func (store, ce_page_changed, self);
+	gtk_tree_view_set_model (priv->addr_list, GTK_TREE_MODEL (store));
+	g_object_unref (store);
+
+	address_list_changed (self);
+	ce_page_changed (CE_PAGE (self));
+}
+
+static gboolean
+dns_server_line_valid (const char *line, gpointer user_data)
+{
+	return dns_server_valid (line);
+}
+
+static void
+dns_servers_icon_press (GtkEntry *entry,
+                        GtkEntryIconPosition icon_pos,
+                        GdkEvent *event,
+                        gpointer user_data)
+{
+	CEPageIP4 *self = CE_PAGE_IP4 (user_data);
+	GtkWidget *dialog, *toplevel;
+	gs_strfreev char **items = NULL;
+	gs_strfreev char **lines = NULL;
+	GString *text;
+	char **iter;
+
+	toplevel = gtk_widget_get_toplevel (CE_PAGE (self)->page);
+	g_return_if_fail (gtk_widget_is_toplevel (toplevel));
+
+	text = g_string_new (NULL);
+	items = g_strsplit_set (gtk_entry_get_text (entry), ", ;:", 0);
+	for (iter = items; *iter; iter++) {
+		char *stripped = g_strstrip (*iter);
+
+		if (*stripped)
+			g_string_append_printf (text, "%s\n", stripped);
+	}
+
+	dialog = bulk_entry_dialog_new (GTK_WINDOW (toplevel),
+	                                _("Edit IPv4 DNS Servers"),
+	                                _("Enter one DNS server address per line."),
+	                                text->str,
+	                                dns_server_line_valid,
+	                                NULL);
+	g_string_free (text, TRUE);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_OK)
+		lines = bulk_entry_dialog_get_lines (dialog);
+	gtk_widget_destroy (dialog);
+
+	if (lines) {
+		gs_free char *joined = g_strjoinv (", ", lines);
+
+		gtk_entry_set_text (entry, joined);
+	}
+}
+
 static void
 list_selection_changed (GtkTreeSelection *selection, gpointer user_data)
 {
@@ -592,6 +1056,7 @@ cell_editing_canceled (GtkCellRenderer *renderer, gpointer user_data)
 		if (gtk_tree_selection_get_selected (selection, &model, &iter)) {
 			column = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (renderer), "column"));
 			gtk_list_store_set (GTK_LIST_STORE (model), &iter, column, priv->last_edited, -1);
+			addr_row_update (GTK_LIST_STORE (model), &iter);
 		}
 
 		g_free (priv->last_edited);
@@ -657,6 +1122,8 @@ cell_edited (GtkCellRendererText *cell,
 		g_free (prefix);
 	}
 
+	addr_row_update (store, &iter);
+
 	/* Move focus to the next/previous column */
 	can_cycle = g_object_get_data (G_OBJECT (cell), DO_NOT_CYCLE_TAG) == NULL;
 	direction = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (cell), DIRECTION_TAG));
@@ -737,78 +1204,21 @@ delete_text_cb (GtkEditable *editable,
 	priv->last_edited = gtk_editable_get_chars (editable, 0, -1);
 }
 
-static gboolean
-parse_netmask (const char *str, guint32 *prefix)
-{
-	struct in_addr tmp_addr;
-	glong tmp_prefix;
-
-	if (!str || !*str)
-		return FALSE;
-
-	errno = 0;
-
-	/* Is it a prefix? */
-	if (!strchr (str, '.')) {
-		tmp_prefix = strtol (str, NULL, 10);
-		if (!errno && tmp_prefix > 0 && tmp_prefix <= 32) {
-			*prefix = tmp_prefix;
-			return TRUE;
-		}
-	}
-
-	/* Is it a netmask? */
-	if (inet_pton (AF_INET, str, &tmp_addr) > 0) {
-		*prefix = nm_utils_ip4_netmask_to_prefix (tmp_addr.s_addr);
-		return TRUE;
-	}
-
-	return FALSE;
-}
-
-static gboolean
-is_address_unspecified (const char *str)
-{
-	struct in_addr addr;
-
-	if (!str)
-		return FALSE;
-
-	return (   inet_pton (AF_INET, str, &addr) == 1
-	        && addr.s_addr == INADDR_ANY);
-}
-
-static gboolean
-gateway_matches_address (const char *gw_str, const char *addr_str, guint32 prefix)
-{
-	struct in_addr gw, addr;
-	guint32 netmask;
-
-	if (!gw_str || inet_pton (AF_INET, gw_str, &gw) != 1)
-		return FALSE;
-	if (!addr_str || inet_pton (AF_INET, addr_str, &addr) != 1)
-		return FALSE;
-
-	netmask = nm_utils_ip4_prefix_to_netmask (prefix);
-	return ((addr.s_addr & netmask) == (gw.s_addr & netmask));
-}
-
 static gboolean
 possibly_wrong_gateway (GtkTreeModel *model, GtkTreeIter *iter, const char *gw_str)
 {
-	gs_free char *addr_str = NULL, *prefix_str = NULL;
-	gboolean addr_valid;
-	guint32 prefix;
-
-	gtk_tree_model_get (model, iter, COL_ADDRESS, &addr_str, -1);
-	gtk_tree_model_get (model, iter, COL_PREFIX, &prefix_str, -1);
-	addr_valid =   addr_str && *addr_str && nm_utils_ipaddr_valid (AF_INET, addr_str) && !is_address_unspecified (addr_str)
-	            && parse_netmask (prefix_str, &prefix);
+	NMIPAddress *addr;
+	gboolean wrong;
 
-	if (addr_valid && !gateway_matches_address (gw_str, addr_str, prefix))
-		return TRUE;
-	else
+	gtk_tree_model_get (model, iter, COL_PARSED, &addr, -1);
+	if (!addr)
 		return FALSE;
+
+	wrong = !gateway_matches_address (gw_str,
+	                                  nm_ip_address_get_address (addr),
+	                                  nm_ip_address_get_prefix (addr));
+	nm_ip_address_unref (addr);
+	return wrong;
 }
 
 typedef struct {
@@ -1043,6 +1453,7 @@ tree_view_button_pressed_cb (GtkWidget *widget,
 
 		gtk_tree_model_get_iter (GTK_TREE_MODEL (store), &iter, last_treepath);
 		gtk_list_store_set (store, &iter, priv->last_column, priv->last_edited, -1);
+		addr_row_update (store, &iter);
 		gtk_tree_path_free (last_treepath);
 
 		g_free (priv->last_edited);
@@ -1068,31 +1479,20 @@ cell_error_data_func (GtkTreeViewColumn *tree_column,
                       gpointer data)
 {
 	guint32 col = GPOINTER_TO_UINT (data);
-	char *value = NULL;
+	gs_free char *value = NULL;
 	const char *color = NULL;
-	guint32 prefix;
-	gboolean invalid = FALSE;
+	guint errors;
 
-	gtk_tree_model_get (tree_model, iter, col, &value, -1);
+	gtk_tree_model_get (tree_model, iter, COL_ERRORS, &errors, -1);
 
-	if (col == COL_ADDRESS)
-		invalid =    !value || !*value || !nm_utils_ipaddr_valid (AF_INET, value)
-		          || is_address_unspecified (value);
-	else if (col == COL_PREFIX)
-		invalid = !parse_netmask (value, &prefix);
-	else if (col == COL_GATEWAY) {
-		invalid = value && *value && !nm_utils_ipaddr_valid (AF_INET, value);
-
-		/* Check gateway against address and prefix */
-		if (!invalid && possibly_wrong_gateway (tree_model, iter, value))
-			color = "#DDC000"; /* darker than "yellow", else selected text is hard to read */
-	} else
-		g_warn_if_reached ();
-
-	if (invalid)
+	if (errors & (1 << col))
 		color = "red";
-	utils_set_cell_background (cell, color, color ? value : NULL);
-	g_free (value);
+	else if (col == COL_GATEWAY && (errors & ERROR_GATEWAY_MISMATCH))
+		color = "#DDC000"; /* darker than "yellow", else selected text is hard to read */
+
+	if (color)
+		gtk_tree_model_get (tree_model, iter, col, &value, -1);
+	utils_set_cell_background (cell, color, value);
 }
 
 static void
@@ -1170,12 +1570,14 @@ finish_setup (CEPageIP4 *self, gpointer user_data)
 
 	g_signal_connect (priv->addr_add, "clicked", G_CALLBACK (addr_add_clicked), self);
 	g_signal_connect (priv->addr_delete, "clicked", G_CALLBACK (addr_delete_clicked), self);
+	g_signal_connect (priv->addr_bulk, "clicked", G_CALLBACK (addr_bulk_clicked), self);
 	selection = gtk_tree_view_get_selection (priv->addr_list);
 	g_signal_connect (selection, "changed", G_CALLBACK (list_selection_changed), priv->addr_delete);
 
-	g_signal_connect_swapped (priv->dns_servers, "changed", G_CALLBACK (ce_page_changed), self);
+	g_signal_connect (priv->dns_servers, "changed", G_CALLBACK (dns_servers_changed), self);
 	g_signal_connect (priv->dns_servers, "insert-text", G_CALLBACK (dns_servers_filter_cb), self);
-	g_signal_connect_swapped (priv->dns_searches, "changed", G_CALLBACK (ce_page_changed), self);
+	g_signal_connect (priv->dns_servers, "icon-press", G_CALLBACK (dns_servers_icon_press), self);
+	g_signal_connect (priv->dns_searches, "changed", G_CALLBACK (dns_searches_changed), self);
 
 	method_changed (priv->method, self);
 	g_signal_connect (priv->method, "changed", G_CALLBACK (method_changed), self);
@@ -1235,6 +1637,38 @@ free_one_addr (gpointer data)
 	nm_ip_address_unref ((NMIPAddress *) data);
 }
 
+static void
+addr_store_set_error (GtkTreeModel *model, GError **error)
+{
+	GtkTreeIter iter;
+	gboolean iter_valid;
+	guint errors;
+
+	iter_valid = gtk_tree_model_get_iter_first (model, &iter);
+	while (iter_valid) {
+		gtk_tree_model_get (model, &iter, COL_ERRORS, &errors, -1);
+		if (errors & ROW_INVALID_MASK) {
+			gs_free char *addr = NULL, *netmask = NULL, *addr_gw = NULL;
+
+			gtk_tree_model_get (model, &iter,
+			                    COL_ADDRESS, &addr,
+			                    COL_PREFIX, &netmask,
+			                    COL_GATEWAY, &addr_gw,
+			                    -1);
+			if (errors & (1 << COL_ADDRESS))
+				g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 address “%s” invalid"), addr ? addr : "");
+			else if (errors & (1 << COL_PREFIX))
+				g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 address netmask “%s” invalid"), netmask ? netmask : "");
+			else
+				g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 gateway “%s” invalid"), addr_gw);
+			return;
+		}
+		iter_valid = gtk_tree_model_iter_next (model, &iter);
+	}
+
+	g_return_if_reached ();
+}
+
 static gboolean
 ui_to_setting (CEPageIP4 *self, GError **error)
 {
@@ -1243,16 +1677,11 @@ ui_to_setting (CEPageIP4 *self, GError **error)
 	GtkTreeIter tree_iter;
 	int int_method = IP4_METHOD_AUTO;
 	const char *method;
-	GPtrArray *tmp_array = NULL;
-	char **dns_servers = NULL;
-	char **search_domains = NULL;
 	GPtrArray *addresses = NULL;
 	char *gateway = NULL;
 	gboolean valid = FALSE, iter_valid;
-	const char *text;
 	gboolean ignore_auto_dns = FALSE;
 	const char *dhcp_client_id = NULL;
-	char **items = NULL, **iter;
 	gboolean may_fail = FALSE;
 
 	/* Method */
@@ -1282,61 +1711,27 @@ ui_to_setting (CEPageIP4 *self, GError **error)
 		break;
 	}
 
-	/* IP addresses */
+	/* IP addresses; the rows were parsed as they were edited */
 	model = gtk_tree_view_get_model (priv->addr_list);
-	iter_valid = gtk_tree_model_get_iter_first (model, &tree_iter);
+	if (addr_store_get_invalid_rows (model)) {
+		addr_store_set_error (model, error);
+		goto out;
+	}
 
 	addresses = g_ptr_array_new_with_free_func (free_one_addr);
+	iter_valid = gtk_tree_model_get_iter_first (model, &tree_iter);
 	while (iter_valid) {
-		char *addr = NULL, *netmask = NULL, *addr_gw = NULL;
 		NMIPAddress *nm_addr;
-		guint32 prefix;
-
-		gtk_tree_model_get (model, &tree_iter,
-		                    COL_ADDRESS, &addr,
-		                    COL_PREFIX, &netmask,
-		                    COL_GATEWAY, &addr_gw,
-		                    -1);
-
-		if (   !addr
-		    || !nm_utils_ipaddr_valid (AF_INET, addr)
-		    || is_address_unspecified (addr)) {
-			g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 address “%s” invalid"), addr ? addr : "");
-			g_free (addr);
-			g_free (netmask);
-			g_free (addr_gw);
-			goto out;
-		}
-
-		if (!parse_netmask (netmask, &prefix)) {
-			g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 address netmask “%s” invalid"), netmask ? netmask : "");
-			g_free (addr);
-			g_free (netmask);
-			g_free (addr_gw);
-			goto out;
-		}
 
-		/* Gateway is optional... */
-		if (addr_gw && *addr_gw && !nm_utils_ipaddr_valid (AF_INET, addr_gw)) {
-			g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 gateway “%s” invalid"), addr_gw);
-			g_free (addr);
-			g_free (netmask);
-			g_free (addr_gw);
-			goto out;
-		}
-
-		nm_addr = nm_ip_address_new (AF_INET, addr, prefix, NULL);
+		gtk_tree_model_get (model, &tree_iter, COL_PARSED, &nm_addr, -1);
 		g_ptr_array_add (addresses, nm_addr);
 
-		if (addresses->len == 1 && addr_gw && *addr_gw) {
-			gateway = addr_gw;
-			addr_gw = NULL;
+		if (addresses->len == 1) {
+			gtk_tree_model_get (model, &tree_iter, COL_GATEWAY, &gateway, -1);
+			if (gateway && !*gateway)
+				g_clear_pointer (&gateway, g_free);
 		}
 
-		g_free (addr);
-		g_free (netmask);
-		g_free (addr_gw);
-
 		iter_valid = gtk_tree_model_iter_next (model, &tree_iter);
 	}
 
@@ -1347,46 +1742,11 @@ ui_to_setting (CEPageIP4 *self, GError **error)
 	}
 
 	/* DNS servers */
-	tmp_array = g_ptr_array_new ();
-	text = gtk_entry_get_text (GTK_ENTRY (priv->dns_servers));
-	if (text && strlen (text)) {
-		items = g_strsplit_set (text, ", ;:", 0);
-		for (iter = items; *iter; iter++) {
-			struct in_addr tmp_addr;
-			char *stripped = g_strstrip (*iter);
-
-			if (!*stripped)
-				continue;
-
-			if (inet_pton (AF_INET, stripped, &tmp_addr))
-				g_ptr_array_add (tmp_array, g_strdup (stripped));
-			else {
-				g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 DNS server “%s” invalid"), stripped);
-				g_strfreev (items);
-				g_ptr_array_free (tmp_array, TRUE);
-				goto out;
-			}
-		}
-		g_strfreev (items);
-	}
-	g_ptr_array_add (tmp_array, NULL);
-	dns_servers = (char **) g_ptr_array_free (tmp_array, FALSE);
-
-	/* Search domains */
-	tmp_array = g_ptr_array_new ();
-	text = gtk_entry_get_text (GTK_ENTRY (priv->dns_searches));
-	if (text && strlen (text)) {
-		items = g_strsplit_set (text, ", ;:", 0);
-		for (iter = items; *iter; iter++) {
-			char *stripped = g_strstrip (*iter);
-
-			if (strlen (stripped))
-				g_ptr_array_add (tmp_array, g_strdup (stripped));
-		}
-		g_strfreev (items);
+	if (priv->dns_servers_invalid) {
+		g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC, _("IPv4 DNS server “%s” invalid"),
+		             priv->dns_servers_invalid);
+		goto out;
 	}
-	g_ptr_array_add (tmp_array, NULL);
-	search_domains = (char **) g_ptr_array_free (tmp_array, FALSE);
 
 	/* DHCP client ID */
 	if (!strcmp (method, NM_SETTING_IP4_CONFIG_METHOD_AUTO)) {
@@ -1402,8 +1762,8 @@ ui_to_setting (CEPageIP4 *self, GError **error)
 	              NM_SETTING_IP_CONFIG_METHOD, method,
 	              NM_SETTING_IP_CONFIG_ADDRESSES, addresses,
 	              NM_SETTING_IP_CONFIG_GATEWAY, gateway,
-	              NM_SETTING_IP_CONFIG_DNS, dns_servers,
-	              NM_SETTING_IP_CONFIG_DNS_SEARCH, search_domains,
+	              NM_SETTING_IP_CONFIG_DNS, priv->dns_servers_parsed,
+	              NM_SETTING_IP_CONFIG_DNS_SEARCH, priv->dns_searches_parsed,
 	              NM_SETTING_IP_CONFIG_IGNORE_AUTO_DNS, ignore_auto_dns,
 	              NM_SETTING_IP4_CONFIG_DHCP_CLIENT_ID, dhcp_client_id,
 	              NM_SETTING_IP_CONFIG_MAY_FAIL, may_fail,
@@ -1415,9 +1775,6 @@ out:
 		g_ptr_array_free (addresses, TRUE);
 	g_free (gateway);
 
-	g_strfreev (dns_servers);
-	g_strfreev (search_domains);
-
 	return valid;
 }
 
@@ -1545,6 +1902,9 @@ dispose (GObject *object)
 		g_object_set_data (G_OBJECT (priv->addr_cells[i]), "ce-page-not-valid", GUINT_TO_POINTER (1));
 
 	g_clear_pointer (&priv->connection_id, g_free);
+	g_clear_pointer (&priv->dns_servers_parsed, g_strfreev);
+	g_clear_pointer (&priv->dns_servers_invalid, g_free);
+	g_clear_pointer (&priv->dns_searches_parsed, g_strfreev);
 
 	G_OBJECT_CLASS (ce_page_ip4_parent_class)->dispose (object);
 }
@@ -1560,5 +1920,6 @@ ce_page_ip4_class_init (CEPageIP4Class *ip4_class)
 	/* virtual methods */
 	parent_class->ce_page_validate_v = ce_page_validate_v;
 	parent_class->inter_page_change = inter_page_change;
+	parent_class->inter_page_consumes = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_WIFI_MODE);
 	object_class->dispose = dispose;
 }
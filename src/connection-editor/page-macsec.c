@@ -295,6 +295,8 @@ ce_page_macsec_class_init (CEPageMacsecClass *macsec_class)
 	/* virtual methods */
 	parent_class->ce_page_validate_v = ce_page_validate_v;
 	parent_class->inter_page_change = inter_page_change;
+	parent_class->inter_page_produces = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_MACSEC_MODE);
+	parent_class->inter_page_consumes = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_802_1X_ENABLE);
 }
 
 void
@@ -12,6 +12,7 @@
 
 #include "page-master.h"
 #include "nm-connection-editor.h"
+#include "ce-client-index.h"
 
 G_DEFINE_TYPE (CEPageMaster, ce_page_master, CE_TYPE_PAGE)
 
@@ -480,6 +481,7 @@ populate_ui (CEPageMaster *self)
 	CEPageMasterPrivate *priv = CE_PAGE_MASTER_GET_PRIVATE (self);
 	NMSettingConnection *s_con;
 	const char *iface;
+	CEClientIndex *client_index;
 	const GPtrArray *connections;
 	int i;
 
@@ -490,10 +492,16 @@ populate_ui (CEPageMaster *self)
 	iface = nm_connection_get_interface_name (CE_PAGE (self)->connection);
 	gtk_entry_set_text (priv->interface_name, iface ? iface : "");
 
-	/* Port connections */
-	connections = nm_client_get_connections (CE_PAGE (self)->client);
+	/* Port connections; they refer to the controller by UUID or interface name */
+	client_index = ce_client_index_get (CE_PAGE (self)->client);
+	connections = ce_client_index_get_ports (client_index, priv->uuid);
 	for (i = 0; i < connections->len; i++)
 		connection_added (CE_PAGE (self)->client, connections->pdata[i], self);
+	if (iface) {
+		connections = ce_client_index_get_ports (client_index, iface);
+		for (i = 0; i < connections->len; i++)
+			connection_added (CE_PAGE (self)->client, connections->pdata[i], self);
+	}
 }
 
 static void
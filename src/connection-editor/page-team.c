@@ -14,6 +14,7 @@
 #endif
 
 #include "page-team.h"
+#include "ce-client-index.h"
 #include "page-infiniband.h"
 #include "nm-connection-editor.h"
 #include "connection-helpers.h"
@@ -1119,12 +1120,11 @@ team_connection_new (FUNC_TAG_PAGE_NEW_CONNECTION_IMPL,
 
 	/* Find an available interface name */
 	team_num = 0;
-	connections = nm_client_get_connections (client);
+	connections = ce_client_index_get_connections_of_type (ce_client_index_get (client),
+	                                                       NM_SETTING_TEAM_SETTING_NAME);
 	for (i = 0; i < connections->len; i++) {
 		conn2 = connections->pdata[i];
 
-		if (!nm_connection_is_type (conn2, NM_SETTING_TEAM_SETTING_NAME))
-			continue;
 		iface = nm_connection_get_interface_name (conn2);
 		if (!iface || strncmp (iface, "team", 4) != 0 || !g_ascii_isdigit (iface[4]))
 			continue;
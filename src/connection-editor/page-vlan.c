@@ -13,6 +13,7 @@
 #include "page-vlan.h"
 #include "connection-helpers.h"
 #include "nm-connection-editor.h"
+#include "ce-client-index.h"
 
 G_DEFINE_TYPE (CEPageVlan, ce_page_vlan, CE_TYPE_PAGE)
 
@@ -32,6 +33,9 @@ typedef struct {
 	char **parent_labels;
 	int parents_len;
 
+	GtkTreeModel *device_model;
+	guint refresh_parents_id;
+
 	GtkWindow *toplevel;
 
 	GtkComboBox *parent;
@@ -338,7 +342,7 @@ static void
 build_vlan_parent_list (CEPageVlan *self, GSList *devices)
 {
 	CEPageVlanPrivate *priv = CE_PAGE_VLAN_GET_PRIVATE (self);
-	const GPtrArray *connections;
+	gs_unref_ptrarray GPtrArray *connections = NULL;
 	GSList *d_iter;
 	GPtrArray *parents;
 	VlanParent *parent;
@@ -369,18 +373,11 @@ build_vlan_parent_list (CEPageVlan *self, GSList *devices)
 	}
 
 	/* Otherwise, VLANs have to be built on top of configured connections */
-	connections = nm_client_get_connections (CE_PAGE (self)->client);
+	connections = ce_client_index_get_parent_connections (ce_client_index_get (CE_PAGE (self)->client),
+	                                                      NM_TYPE_SETTING_VLAN);
 	for (i = 0; i < connections->len; i++) {
 		NMConnection *candidate = connections->pdata[i];
 		NMSettingConnection *s_con = nm_connection_get_setting_connection (candidate);
-		GType connection_gtype;
-
-		if (nm_setting_connection_get_master (s_con))
-			continue;
-
-		connection_gtype = nm_setting_lookup_type (nm_setting_connection_get_connection_type (s_con));
-		if (!nm_utils_check_virtual_device_compatibility (NM_TYPE_SETTING_VLAN, connection_gtype))
-			continue;
 
 		for (d_iter = devices; d_iter; d_iter = d_iter->next) {
 			device = d_iter->data;
@@ -422,6 +419,63 @@ build_vlan_parent_list (CEPageVlan *self, GSList *devices)
 	priv->parents_len = i;
 }
 
+static void
+free_vlan_parents (CEPageVlanPrivate *priv)
+{
+	int i;
+
+	if (!priv->parents)
+		return;
+
+	for (i = 0; priv->parents[i]; i++) {
+		g_free (priv->parents[i]->label);
+		g_slice_free (VlanParent, priv->parents[i]);
+	}
+	g_clear_pointer (&priv->parents, g_free);
+	g_clear_pointer (&priv->parent_labels, g_free);
+	priv->parents_len = 0;
+}
+
+static gboolean
+refresh_parents (gpointer user_data)
+{
+	CEPageVlan *self = user_data;
+	CEPageVlanPrivate *priv = CE_PAGE_VLAN_GET_PRIVATE (self);
+	gs_free char *current = NULL;
+	GSList *devices;
+
+	priv->refresh_parents_id = 0;
+
+	/* Rebuild the list, keeping what the user picked or typed */
+	current = g_strdup (gtk_entry_get_text (priv->parent_entry));
+
+	g_signal_handlers_block_by_func (priv->parent, G_CALLBACK (parent_changed), self);
+
+	gtk_combo_box_text_remove_all (GTK_COMBO_BOX_TEXT (priv->parent));
+	free_vlan_parents (priv);
+
+	devices = get_vlan_devices (self);
+	build_vlan_parent_list (self, devices);
+	g_slist_free (devices);
+
+	ce_page_setup_data_combo (CE_PAGE (self), priv->parent,
+	                          current[0] ? current : NULL,
+	                          priv->parent_labels);
+
+	g_signal_handlers_unblock_by_func (priv->parent, G_CALLBACK (parent_changed), self);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+devices_changed (CEPageVlan *self)
+{
+	CEPageVlanPrivate *priv = CE_PAGE_VLAN_GET_PRIVATE (self);
+
+	if (!priv->refresh_parents_id)
+		priv->refresh_parents_id = g_idle_add (refresh_parents, self);
+}
+
 static void
 populate_ui (CEPageVlan *self)
 {
@@ -502,6 +556,14 @@ populate_ui (CEPageVlan *self)
 	if (current_parent)
 		priv->last_parent = g_strndup (current_parent, strcspn (current_parent, " "));
 
+	/* Follow the devices that come and go while the page is shown. The
+	 * filter model only reports the rows of a level that was built. */
+	priv->device_model = ce_client_index_new_device_model (ce_client_index_get (CE_PAGE (self)->client),
+	                                                       G_TYPE_NONE, NULL);
+	gtk_tree_model_iter_n_children (priv->device_model, NULL);
+	g_signal_connect_swapped (priv->device_model, "row-inserted", G_CALLBACK (devices_changed), self);
+	g_signal_connect_swapped (priv->device_model, "row-deleted", G_CALLBACK (devices_changed), self);
+
 	/* Name */
 	iface = nm_connection_get_interface_name (CE_PAGE (self)->connection);
 	if (iface)
@@ -732,18 +794,30 @@ ce_page_validate_v (CEPage *page, NMConnection *connection, GError **error)
 	return nm_setting_verify (NM_SETTING (priv->setting), NULL, error);
 }
 
+static void
+dispose (GObject *object)
+{
+	CEPageVlan *self = CE_PAGE_VLAN (object);
+	CEPageVlanPrivate *priv = CE_PAGE_VLAN_GET_PRIVATE (self);
+
+	nm_clear_g_source (&priv->refresh_parents_id);
+	if (priv->device_model) {
+		g_signal_handlers_disconnect_by_data (priv->device_model, self);
+		g_clear_object (&priv->device_model);
+	}
+
+	G_OBJECT_CLASS (ce_page_vlan_parent_class)->dispose (object);
+}
+
 static void
 finalize (GObject *object)
 {
 	CEPageVlan *self = CE_PAGE_VLAN (object);
 	CEPageVlanPrivate *priv = CE_PAGE_VLAN_GET_PRIVATE (self);
-	int i;
 
 	g_free (priv->last_parent);
 
-	for (i = 0; priv->parents[i]; i++)
-		g_slice_free (VlanParent, priv->parents[i]);
-	g_free (priv->parents);
+	free_vlan_parents (priv);
 
 	G_OBJECT_CLASS (ce_page_vlan_parent_class)->finalize (object);
 }
@@ -762,6 +836,7 @@ ce_page_vlan_class_init (CEPageVlanClass *vlan_class)
 	g_type_class_add_private (object_class, sizeof (CEPageVlanPrivate));
 
 	/* virtual methods */
+	object_class->dispose = dispose;
 	object_class->finalize = finalize;
 	parent_class->ce_page_validate_v = ce_page_validate_v;
 }
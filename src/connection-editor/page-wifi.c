@@ -543,6 +543,7 @@ ce_page_wifi_class_init (CEPageWifiClass *wifi_class)
 
 	/* virtual methods */
 	parent_class->ce_page_validate_v = ce_page_validate_v;
+	parent_class->inter_page_produces = INTER_PAGE_CHANGE_MASK (INTER_PAGE_CHANGE_WIFI_MODE);
 }
 
 
@@ -45,11 +45,19 @@ typedef struct {
 	GtkToggleButton *toggle_show_pk;
 	GtkButton *button_add;
 	GtkButton *button_delete;
+	GtkButton *button_import;
+	GtkEntry *entry_filter;
 
 	GtkTreeView *tree;
-	GtkTreeStore *store;
+	GtkListStore *store;
+	GtkTreeModel *filter;
+
+	/* Public keys of the peers added or edited since the last validation;
+	 * the other peers are known to be valid. */
+	GHashTable *touched_peers;
 } CEPageWireGuardPrivate;
 
+/* The rows of the store are the peers of the setting, in the same order */
 enum {
 	COL_PUBLIC_KEY,
 	COL_ALLOWED_IPS,
@@ -235,6 +243,8 @@ peer_dialog_create (GtkWidget *toplevel, NMWireGuardPeer *peer)
 	return dialog;
 }
 
+static gboolean peer_visible_func (GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data);
+
 static void
 wireguard_private_init (CEPageWireGuard *self)
 {
@@ -254,14 +264,22 @@ wireguard_private_init (CEPageWireGuard *self)
 	priv->tree = GTK_TREE_VIEW (gtk_builder_get_object (builder, "tree_peers"));
 	priv->button_add = GTK_BUTTON (gtk_builder_get_object (builder, "button_add"));
 	priv->button_delete = GTK_BUTTON (gtk_builder_get_object (builder, "button_delete"));
+	priv->button_import = GTK_BUTTON (gtk_builder_get_object (builder, "button_import"));
+	priv->entry_filter = GTK_ENTRY (gtk_builder_get_object (builder, "entry_peer_filter"));
 
 	gtk_entry_set_visibility (priv->entry_pk, FALSE);
 
-	priv->store = gtk_tree_store_new (3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_POINTER);
+	priv->touched_peers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	/* The tree view is in fixed-height mode, so that it doesn't have to
+	 * measure every row of large peer lists. */
+	priv->store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING);
 	column = gtk_tree_view_column_new_with_attributes (_("Public key"),
 	                                                   gtk_cell_renderer_text_new (),
 	                                                   "text", COL_PUBLIC_KEY,
 	                                                   NULL);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 300);
 	gtk_tree_view_column_set_resizable (column, TRUE);
 	gtk_tree_view_append_column (priv->tree, column);
 
@@ -269,36 +287,98 @@ wireguard_private_init (CEPageWireGuard *self)
 	                                                   gtk_cell_renderer_text_new (),
 	                                                   "text", COL_ALLOWED_IPS,
 	                                                   NULL);
+	gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_FIXED);
+	gtk_tree_view_column_set_fixed_width (column, 200);
+	gtk_tree_view_column_set_expand (column, TRUE);
 	gtk_tree_view_column_set_resizable (column, TRUE);
 	gtk_tree_view_append_column (priv->tree, column);
 
-	gtk_tree_view_set_model (priv->tree, GTK_TREE_MODEL (priv->store));
+	priv->filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (priv->store), NULL);
+	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (priv->filter),
+	                                        peer_visible_func, self, NULL);
+	gtk_tree_view_set_model (priv->tree, priv->filter);
 }
 
 static void
-update_peers_table (CEPageWireGuard *self)
+peer_row_set (CEPageWireGuard *self, GtkTreeIter *iter, NMWireGuardPeer *peer)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+	gs_free char *ips = NULL;
+
+	ips = format_allowed_ips (peer);
+	gtk_list_store_set (priv->store, iter,
+	                    COL_PUBLIC_KEY, nm_wireguard_peer_get_public_key (peer),
+	                    COL_ALLOWED_IPS, ips,
+	                    -1);
+}
+
+/* Appends rows for the peers of the setting from @first on */
+static void
+peers_table_append (CEPageWireGuard *self, guint first)
 {
 	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
-	NMSettingWireGuard *setting = priv->setting;
 	guint i, num;
+	gboolean bulk;
+
+	num = nm_setting_wireguard_get_peers_len (priv->setting);
 
-	gtk_tree_store_clear (priv->store);
+	/* Don't let the view follow every single insertion */
+	bulk = num - first > 1;
+	if (bulk)
+		gtk_tree_view_set_model (priv->tree, NULL);
 
-	num = nm_setting_wireguard_get_peers_len (setting);
-	for (i = 0; i < num; i++) {
+	for (i = first; i < num; i++) {
 		NMWireGuardPeer *peer;
-		GtkTreeIter iter;
 		gs_free char *ips = NULL;
 
-		peer = nm_setting_wireguard_get_peer (setting, i);
+		peer = nm_setting_wireguard_get_peer (priv->setting, i);
 		ips = format_allowed_ips (peer);
-		gtk_tree_store_append (priv->store, &iter, NULL);
-
-		gtk_tree_store_set (priv->store, &iter,
-		                    COL_PUBLIC_KEY, nm_wireguard_peer_get_public_key (peer),
-		                    COL_ALLOWED_IPS, ips,
-		                    -1);
+		gtk_list_store_insert_with_values (priv->store, NULL, -1,
+		                                   COL_PUBLIC_KEY, nm_wireguard_peer_get_public_key (peer),
+		                                   COL_ALLOWED_IPS, ips,
+		                                   -1);
 	}
+
+	if (bulk)
+		gtk_tree_view_set_model (priv->tree, priv->filter);
+}
+
+static void
+update_peers_table (CEPageWireGuard *self)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+
+	gtk_list_store_clear (priv->store);
+	peers_table_append (self, 0);
+}
+
+static gboolean
+peer_visible_func (GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (user_data);
+	gs_free char *public_key = NULL;
+	gs_free char *allowed_ips = NULL;
+	const char *text;
+
+	text = gtk_entry_get_text (priv->entry_filter);
+	if (!text || !text[0])
+		return TRUE;
+
+	gtk_tree_model_get (model, iter,
+	                    COL_PUBLIC_KEY, &public_key,
+	                    COL_ALLOWED_IPS, &allowed_ips,
+	                    -1);
+
+	return    (public_key && strstr (public_key, text))
+	       || (allowed_ips && strstr (allowed_ips, text));
+}
+
+static void
+filter_changed (CEPageWireGuard *self)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+
+	gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (priv->filter));
 }
 
 static int
@@ -307,6 +387,7 @@ get_selected_index (CEPageWireGuard *self)
 	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
 	GtkTreeSelection *selection;
 	GtkTreeModel *model;
+	GtkTreePath *path = NULL;
 	GList *list;
 	int *indices;
 	int ret = -1;
@@ -318,12 +399,19 @@ get_selected_index (CEPageWireGuard *self)
 	if (!list)
 		goto done;
 
-	indices = gtk_tree_path_get_indices ((GtkTreePath *) list->data);
+	path = gtk_tree_model_filter_convert_path_to_child_path (GTK_TREE_MODEL_FILTER (priv->filter),
+	                                                         (GtkTreePath *) list->data);
+	if (!path)
+		goto done;
+
+	indices = gtk_tree_path_get_indices (path);
 	if (!indices)
 		goto done;
 
 	ret = indices[0];
 done:
+	if (path)
+		gtk_tree_path_free (path);
 	g_list_free_full (list, (GDestroyNotify) gtk_tree_path_free);
 	return ret;
 }
@@ -378,6 +466,16 @@ stuff_changed (GtkEditable *editable, gpointer user_data)
 	ce_page_changed (CE_PAGE (user_data));
 }
 
+static void
+mark_peer_touched (CEPageWireGuard *self, NMWireGuardPeer *peer)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+	const char *public_key = nm_wireguard_peer_get_public_key (peer);
+
+	if (public_key && !g_hash_table_contains (priv->touched_peers, public_key))
+		g_hash_table_add (priv->touched_peers, g_strdup (public_key));
+}
+
 static void
 peer_dialog_response_cb (GtkWidget *dialog, gint response, gpointer user_data)
 {
@@ -385,6 +483,9 @@ peer_dialog_response_cb (GtkWidget *dialog, gint response, gpointer user_data)
 	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
 
 	if (response == GTK_RESPONSE_APPLY) {
+		guint old_len = nm_setting_wireguard_get_peers_len (priv->setting);
+		GtkTreeIter iter;
+
 		peer_dialog_update_peer (dialog);
 		if (priv->dialog_peer_index >= 0) {
 			nm_setting_wireguard_set_peer (priv->setting,
@@ -394,7 +495,21 @@ peer_dialog_response_cb (GtkWidget *dialog, gint response, gpointer user_data)
 			nm_setting_wireguard_append_peer (priv->setting,
 			                                  priv->dialog_peer);
 		}
-		update_peers_table (self);
+		mark_peer_touched (self, priv->dialog_peer);
+
+		/* Only update the affected row, unless the setting replaced
+		 * another peer with the same public key. */
+		if (   priv->dialog_peer_index >= 0
+		    && nm_setting_wireguard_get_peers_len (priv->setting) == old_len
+		    && gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (priv->store), &iter, NULL, priv->dialog_peer_index))
+			peer_row_set (self, &iter, priv->dialog_peer);
+		else if (   priv->dialog_peer_index < 0
+		         && nm_setting_wireguard_get_peers_len (priv->setting) == old_len + 1)
+			peers_table_append (self, old_len);
+		else
+			update_peers_table (self);
+
+		ce_page_changed (CE_PAGE (self));
 	}
 
 	nm_wireguard_peer_unref (priv->dialog_peer);
@@ -426,8 +541,16 @@ add_delete_clicked (GtkButton *button, CEPageWireGuard *self)
 	} else {
 		index = get_selected_index (self);
 		if (index >= 0) {
+			NMWireGuardPeer *peer;
+			GtkTreeIter iter;
+
+			peer = nm_setting_wireguard_get_peer (priv->setting, (guint) index);
+			if (nm_wireguard_peer_get_public_key (peer))
+				g_hash_table_remove (priv->touched_peers, nm_wireguard_peer_get_public_key (peer));
 			nm_setting_wireguard_remove_peer (priv->setting, (guint) index);
-			update_peers_table (self);
+			if (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (priv->store), &iter, NULL, index))
+				gtk_list_store_remove (priv->store, &iter);
+			ce_page_changed (CE_PAGE (self));
 		}
 	}
 }
@@ -460,6 +583,230 @@ row_activated (GtkTreeView       *tree_view,
 	gtk_widget_show (dialog);
 }
 
+/*****************************************************************************/
+
+static NMWireGuardPeer *
+import_finish_peer (NMWireGuardPeer *peer, guint line, GError **error)
+{
+	gs_free_error GError *local = NULL;
+
+	nm_wireguard_peer_seal (peer);
+	if (!nm_wireguard_peer_is_valid (peer, TRUE, TRUE, &local)) {
+		g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC,
+		             _("Invalid peer ending at line %u: %s"), line, local->message);
+		nm_wireguard_peer_unref (peer);
+		return NULL;
+	}
+	return peer;
+}
+
+/* Parses the [Peer] sections of a wg-quick configuration file. The
+ * [Interface] section is ignored. Runs in a worker thread. */
+static GPtrArray *
+import_parse_peers (const char *contents, GError **error)
+{
+	gs_unref_ptrarray GPtrArray *peers = NULL;
+	gs_strfreev char **lines = NULL;
+	NMWireGuardPeer *peer = NULL;
+	gboolean in_peer = FALSE;
+	guint i;
+
+	peers = g_ptr_array_new_with_free_func ((GDestroyNotify) nm_wireguard_peer_unref);
+	lines = g_strsplit (contents, "\n", -1);
+
+	for (i = 0; lines[i]; i++) {
+		char *line = lines[i];
+		char *key, *value, *p;
+		gboolean ok = TRUE;
+
+		p = strchr (line, '#');
+		if (p)
+			*p = '\0';
+		g_strstrip (line);
+		if (!line[0])
+			continue;
+
+		if (line[0] == '[') {
+			if (peer) {
+				peer = import_finish_peer (peer, i, error);
+				if (!peer)
+					return NULL;
+				g_ptr_array_add (peers, peer);
+				peer = NULL;
+			}
+			in_peer = (g_ascii_strcasecmp (line, "[Peer]") == 0);
+			if (in_peer)
+				peer = nm_wireguard_peer_new ();
+			continue;
+		}
+		if (!in_peer)
+			continue;
+
+		p = strchr (line, '=');
+		if (!p) {
+			ok = FALSE;
+			goto next;
+		}
+		*p = '\0';
+		key = g_strstrip (line);
+		value = g_strstrip (p + 1);
+
+		if (g_ascii_strcasecmp (key, "PublicKey") == 0)
+			ok = nm_wireguard_peer_set_public_key (peer, value, FALSE);
+		else if (g_ascii_strcasecmp (key, "PresharedKey") == 0)
+			ok = nm_wireguard_peer_set_preshared_key (peer, value, FALSE);
+		else if (g_ascii_strcasecmp (key, "Endpoint") == 0)
+			ok = nm_wireguard_peer_set_endpoint (peer, value, FALSE);
+		else if (g_ascii_strcasecmp (key, "PersistentKeepalive") == 0) {
+			gint64 keepalive = 0;
+
+			if (g_ascii_strcasecmp (value, "off") != 0) {
+				keepalive = _nm_utils_ascii_str_to_int64 (value, 10, 0, G_MAXUINT16, -1);
+				ok = keepalive >= 0;
+			}
+			if (ok)
+				nm_wireguard_peer_set_persistent_keepalive (peer, keepalive);
+		} else if (g_ascii_strcasecmp (key, "AllowedIPs") == 0) {
+			gs_strfreev char **ips = g_strsplit (value, ",", -1);
+			guint j;
+
+			for (j = 0; ok && ips[j]; j++) {
+				g_strstrip (ips[j]);
+				if (ips[j][0])
+					ok = nm_wireguard_peer_append_allowed_ip (peer, ips[j], FALSE);
+			}
+		}
+
+next:
+		if (!ok) {
+			g_set_error (error, NMA_ERROR, NMA_ERROR_GENERIC,
+			             _("Invalid peer configuration at line %u"), i + 1);
+			nm_wireguard_peer_unref (peer);
+			return NULL;
+		}
+	}
+
+	if (peer) {
+		peer = import_finish_peer (peer, i, error);
+		if (!peer)
+			return NULL;
+		g_ptr_array_add (peers, peer);
+	}
+
+	if (!peers->len) {
+		g_set_error_literal (error, NMA_ERROR, NMA_ERROR_GENERIC,
+		                     _("The file doesn't contain any peers"));
+		return NULL;
+	}
+
+	return g_steal_pointer (&peers);
+}
+
+static void
+import_thread (GTask *task,
+               gpointer source_object,
+               gpointer task_data,
+               GCancellable *cancellable)
+{
+	const char *filename = task_data;
+	gs_free char *contents = NULL;
+	GPtrArray *peers;
+	GError *error = NULL;
+
+	if (!g_file_get_contents (filename, &contents, NULL, &error)) {
+		g_task_return_error (task, error);
+		return;
+	}
+
+	peers = import_parse_peers (contents, &error);
+	if (peers)
+		g_task_return_pointer (task, peers, (GDestroyNotify) g_ptr_array_unref);
+	else
+		g_task_return_error (task, error);
+}
+
+static void
+import_done (GObject *source_object, GAsyncResult *result, gpointer user_data)
+{
+	CEPageWireGuard *self = CE_PAGE_WIREGUARD (source_object);
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+	gs_unref_ptrarray GPtrArray *peers = NULL;
+	gs_free_error GError *error = NULL;
+	guint i, old_len;
+
+	peers = g_task_propagate_pointer (G_TASK (result), &error);
+
+	/* The editor was closed meanwhile */
+	if (!priv->store)
+		return;
+
+	gtk_widget_set_sensitive (GTK_WIDGET (priv->button_import), TRUE);
+
+	if (!peers) {
+		nm_connection_editor_error (CE_PAGE (self)->parent_window,
+		                            _("Cannot import WireGuard peers"),
+		                            "%s", error->message);
+		return;
+	}
+
+	/* The peers were validated while parsing */
+	old_len = nm_setting_wireguard_get_peers_len (priv->setting);
+	for (i = 0; i < peers->len; i++)
+		nm_setting_wireguard_append_peer (priv->setting, peers->pdata[i]);
+
+	if (nm_setting_wireguard_get_peers_len (priv->setting) == old_len + peers->len)
+		peers_table_append (self, old_len);
+	else {
+		/* Some imported peers replaced existing ones */
+		update_peers_table (self);
+	}
+
+	ce_page_changed (CE_PAGE (self));
+}
+
+static void
+import_clicked (GtkButton *button, CEPageWireGuard *self)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+	GtkWidget *dialog, *toplevel;
+	GtkFileFilter *filter;
+	char *filename;
+	GTask *task;
+
+	toplevel = gtk_widget_get_toplevel (CE_PAGE (self)->page);
+	g_return_if_fail (toplevel);
+	g_return_if_fail (gtk_widget_is_toplevel (toplevel));
+
+	dialog = gtk_file_chooser_dialog_new (_("Select file to import"),
+	                                      GTK_WINDOW (toplevel),
+	                                      GTK_FILE_CHOOSER_ACTION_OPEN,
+	                                      _("_Cancel"), GTK_RESPONSE_CANCEL,
+	                                      _("_Open"), GTK_RESPONSE_ACCEPT,
+	                                      NULL);
+	gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+
+	filter = gtk_file_filter_new ();
+	gtk_file_filter_set_name (filter, _("WireGuard configuration (*.conf)"));
+	gtk_file_filter_add_pattern (filter, "*.conf");
+	gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), filter);
+
+	if (gtk_dialog_run (GTK_DIALOG (dialog)) == GTK_RESPONSE_ACCEPT) {
+		filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+		if (filename) {
+			/* Parsing hundreds of peers takes a while; don't block the UI */
+			gtk_widget_set_sensitive (GTK_WIDGET (priv->button_import), FALSE);
+			task = g_task_new (self, NULL, import_done, NULL);
+			g_task_set_task_data (task, filename, g_free);
+			g_task_run_in_thread (task, import_thread);
+			g_object_unref (task);
+		}
+	}
+
+	gtk_widget_destroy (dialog);
+}
+
+/*****************************************************************************/
+
 static void
 show_private_key (GtkToggleButton *button, gpointer user_data)
 {
@@ -483,10 +830,12 @@ finish_setup (CEPageWireGuard *self, gpointer user_data)
 	g_signal_connect (priv->spin_listen_port,  "value-changed", G_CALLBACK (stuff_changed), self);
 	g_signal_connect (priv->button_add,        "clicked",       G_CALLBACK (add_delete_clicked), self);
 	g_signal_connect (priv->button_delete,     "clicked",       G_CALLBACK (add_delete_clicked), self);
+	g_signal_connect (priv->button_import,     "clicked",       G_CALLBACK (import_clicked), self);
 	g_signal_connect (priv->tree,              "row-activated", G_CALLBACK (row_activated), self);
 	g_signal_connect (priv->toggle_show_pk,    "toggled",       G_CALLBACK (show_private_key), self);
 
 	g_signal_connect_swapped (selection,       "changed",       G_CALLBACK (tree_selection_changed), self);
+	g_signal_connect_swapped (priv->entry_filter, "search-changed", G_CALLBACK (filter_changed), self);
 }
 
 CEPage *
@@ -587,11 +936,41 @@ ce_page_validate_v (CEPage *page, NMConnection *connection, GError **error)
 {
 	CEPageWireGuard *self = CE_PAGE_WIREGUARD (page);
 	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (self);
+	gs_unref_object NMSetting *s_peerless = NULL;
+	GHashTableIter iter;
+	const char *public_key;
 
 	ui_to_setting (self);
 
-	return    nm_setting_verify (NM_SETTING (priv->setting), connection, error)
-	       && nm_setting_verify_secrets (NM_SETTING (priv->setting), connection, error);
+	/* Only check the peers that were added or edited; verifying the
+	 * setting itself would check all of them again. */
+	g_hash_table_iter_init (&iter, priv->touched_peers);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &public_key, NULL)) {
+		NMWireGuardPeer *peer;
+
+		peer = nm_setting_wireguard_get_peer_by_public_key (priv->setting, public_key, NULL);
+		if (peer && !nm_wireguard_peer_is_valid (peer, TRUE, TRUE, error))
+			return FALSE;
+		g_hash_table_iter_remove (&iter);
+	}
+
+	s_peerless = nm_setting_duplicate (NM_SETTING (priv->setting));
+	nm_setting_wireguard_clear_peers (NM_SETTING_WIREGUARD (s_peerless));
+
+	return    nm_setting_verify (s_peerless, connection, error)
+	       && nm_setting_verify_secrets (s_peerless, connection, error);
+}
+
+static void
+dispose (GObject *object)
+{
+	CEPageWireGuardPrivate *priv = CE_PAGE_WIREGUARD_GET_PRIVATE (object);
+
+	g_clear_object (&priv->filter);
+	g_clear_object (&priv->store);
+	g_clear_pointer (&priv->touched_peers, g_hash_table_unref);
+
+	G_OBJECT_CLASS (ce_page_wireguard_parent_class)->dispose (object);
 }
 
 static void
@@ -607,6 +986,7 @@ ce_page_wireguard_class_init (CEPageWireGuardClass *wireguard_class)
 
 	g_type_class_add_private (object_class, sizeof (CEPageWireGuardPrivate));
 
+	object_class->dispose = dispose;
 	parent_class->ce_page_validate_v = ce_page_validate_v;
 }
 
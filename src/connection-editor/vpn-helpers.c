@@ -12,8 +12,80 @@
 #include <gmodule.h>
 
 #include "vpn-helpers.h"
+#include "ce-client-index.h"
 #include "utils.h"
 
+/* Editor plugins are only loaded when a connection of their service type
+ * needs them. They can be prefetched from a worker thread, so the loading
+ * (and the libnm NMVpnPluginInfo state it touches) is serialized. */
+static GMutex plugins_lock;
+static GHashTable *plugins_tried;
+
+static NMVpnEditorPlugin *
+load_editor_plugin (NMVpnPluginInfo *plugin_info)
+{
+	NMVpnEditorPlugin *plugin;
+	GError *error = NULL;
+
+	g_mutex_lock (&plugins_lock);
+
+	plugin = nm_vpn_plugin_info_get_editor_plugin (plugin_info);
+	if (plugin || g_hash_table_contains (plugins_tried, plugin_info))
+		goto out;
+	g_hash_table_add (plugins_tried, plugin_info);
+
+	plugin = nm_vpn_plugin_info_load_editor_plugin (plugin_info, &error);
+	if (plugin) {
+		g_info ("vpn: (%s,%s) loaded",
+		        nm_vpn_plugin_info_get_name (plugin_info),
+		        nm_vpn_plugin_info_get_filename (plugin_info));
+	} else if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+		g_message ("vpn: (%s,%s) file \"%s\" not found. Did you install the client package?",
+		           nm_vpn_plugin_info_get_name (plugin_info),
+		           nm_vpn_plugin_info_get_filename (plugin_info),
+		           nm_vpn_plugin_info_get_plugin (plugin_info));
+	} else {
+		g_warning ("vpn: (%s,%s) could not load plugin: %s",
+		           nm_vpn_plugin_info_get_name (plugin_info),
+		           nm_vpn_plugin_info_get_filename (plugin_info),
+		           error->message);
+	}
+	g_clear_error (&error);
+
+out:
+	g_mutex_unlock (&plugins_lock);
+	return plugin;
+}
+
+NMVpnEditorPlugin *
+vpn_get_plugin (NMVpnPluginInfo *plugin_info)
+{
+	g_return_val_if_fail (NM_IS_VPN_PLUGIN_INFO (plugin_info), NULL);
+
+	vpn_get_plugin_infos ();
+	return load_editor_plugin (plugin_info);
+}
+
+/**
+ * vpn_peek_plugin:
+ * @plugin_info: the VPN plugin
+ *
+ * Returns: (transfer none): the editor plugin of @plugin_info if it was
+ *   already loaded (or prefetched), %NULL otherwise. Never loads it.
+ */
+NMVpnEditorPlugin *
+vpn_peek_plugin (NMVpnPluginInfo *plugin_info)
+{
+	NMVpnEditorPlugin *plugin;
+
+	g_return_val_if_fail (NM_IS_VPN_PLUGIN_INFO (plugin_info), NULL);
+
+	g_mutex_lock (&plugins_lock);
+	plugin = nm_vpn_plugin_info_get_editor_plugin (plugin_info);
+	g_mutex_unlock (&plugins_lock);
+	return plugin;
+}
+
 NMVpnEditorPlugin *
 vpn_get_plugin_by_service (const char *service)
 {
@@ -21,7 +93,7 @@ vpn_get_plugin_by_service (const char *service)
 
 	plugin_info = nm_vpn_plugin_info_list_find_by_service (vpn_get_plugin_infos (), service);
 	if (plugin_info)
-		return nm_vpn_plugin_info_get_editor_plugin (plugin_info);
+		return load_editor_plugin (plugin_info);
 	return NULL;
 }
 
@@ -31,6 +103,13 @@ _sort_vpn_plugins (NMVpnPluginInfo *aa, NMVpnPluginInfo *bb)
 	return strcmp (nm_vpn_plugin_info_get_name (aa), nm_vpn_plugin_info_get_name (bb));
 }
 
+/**
+ * vpn_get_plugin_infos:
+ *
+ * Returns: (transfer none): the installed VPN plugins, as described by their
+ *   .name files, sorted by name. Their editor plugins are not loaded; use
+ *   vpn_get_plugin() or vpn_get_plugin_by_service() for that.
+ */
 GSList *
 vpn_get_plugin_infos (void)
 {
@@ -42,37 +121,22 @@ vpn_get_plugin_infos (void)
 		return plugins;
 	plugins_loaded = TRUE;
 
+	plugins_tried = g_hash_table_new (g_direct_hash, g_direct_equal);
+
 	p = nm_vpn_plugin_info_list_load ();
 	plugins = NULL;
 	while (p) {
 		NMVpnPluginInfo *plugin_info = NM_VPN_PLUGIN_INFO (p->data);
-		GError *error = NULL;
 
-		/* load the editor plugin, and preserve only those NMVpnPluginInfo that can
-		 * successfully load the plugin. */
-		if (nm_vpn_plugin_info_load_editor_plugin (plugin_info, &error)) {
+		/* preserve only those NMVpnPluginInfo that name an editor plugin. */
+		if (nm_vpn_plugin_info_get_plugin (plugin_info))
 			plugins = g_slist_prepend (plugins, plugin_info);
-			g_info ("vpn: (%s,%s) loaded",
-			        nm_vpn_plugin_info_get_name (plugin_info),
-			        nm_vpn_plugin_info_get_filename (plugin_info));
-		} else {
-			if (   !nm_vpn_plugin_info_get_plugin (plugin_info)
-			    && nm_vpn_plugin_info_lookup_property (plugin_info, NM_VPN_PLUGIN_INFO_KF_GROUP_GNOME, "properties")) {
+		else {
+			if (nm_vpn_plugin_info_lookup_property (plugin_info, NM_VPN_PLUGIN_INFO_KF_GROUP_GNOME, "properties")) {
 				g_message ("vpn: (%s,%s) cannot load legacy-only plugin",
 				           nm_vpn_plugin_info_get_name (plugin_info),
 				           nm_vpn_plugin_info_get_filename (plugin_info));
-			} else if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
-				g_message ("vpn: (%s,%s) file \"%s\" not found. Did you install the client package?",
-				           nm_vpn_plugin_info_get_name (plugin_info),
-				           nm_vpn_plugin_info_get_filename (plugin_info),
-				           nm_vpn_plugin_info_get_plugin (plugin_info));
-			} else {
-				g_warning ("vpn: (%s,%s) could not load plugin: %s",
-				           nm_vpn_plugin_info_get_name (plugin_info),
-				           nm_vpn_plugin_info_get_filename (plugin_info),
-				           error->message);
 			}
-			g_clear_error (&error);
 			g_object_unref (plugin_info);
 		}
 		p = g_slist_delete_link (p, p);
@@ -83,6 +147,65 @@ vpn_get_plugin_infos (void)
 	return plugins;
 }
 
+static void
+prefetch_thread (GTask *task,
+                 gpointer source_object,
+                 gpointer task_data,
+                 GCancellable *cancellable)
+{
+	GPtrArray *plugin_infos = task_data;
+	guint i;
+
+	for (i = 0; i < plugin_infos->len; i++)
+		load_editor_plugin (plugin_infos->pdata[i]);
+}
+
+/**
+ * vpn_prefetch_editor_plugins:
+ * @client: the #NMClient whose VPN connections to look at
+ *
+ * Loads, in a worker thread, the editor plugins of the service types
+ * used by the VPN connections of @client; so that opening one of them
+ * doesn't have to wait for the plugin to load.
+ */
+void
+vpn_prefetch_editor_plugins (NMClient *client)
+{
+	const GPtrArray *connections;
+	gs_unref_hashtable GHashTable *seen = NULL;
+	GPtrArray *plugin_infos;
+	GTask *task;
+	guint i;
+
+	connections = ce_client_index_get_connections_of_type (ce_client_index_get (client),
+	                                                       NM_SETTING_VPN_SETTING_NAME);
+
+	seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+	plugin_infos = g_ptr_array_new_with_free_func (g_object_unref);
+	for (i = 0; i < connections->len; i++) {
+		NMSettingVpn *s_vpn;
+		NMVpnPluginInfo *plugin_info;
+
+		s_vpn = nm_connection_get_setting_vpn (connections->pdata[i]);
+		if (!s_vpn || !nm_setting_vpn_get_service_type (s_vpn))
+			continue;
+		plugin_info = nm_vpn_plugin_info_list_find_by_service (vpn_get_plugin_infos (),
+		                                                       nm_setting_vpn_get_service_type (s_vpn));
+		if (plugin_info && g_hash_table_add (seen, plugin_info))
+			g_ptr_array_add (plugin_infos, g_object_ref (plugin_info));
+	}
+
+	if (!plugin_infos->len) {
+		g_ptr_array_unref (plugin_infos);
+		return;
+	}
+
+	task = g_task_new (NULL, NULL, NULL, NULL);
+	g_task_set_task_data (task, plugin_infos, (GDestroyNotify) g_ptr_array_unref);
+	g_task_run_in_thread (task, prefetch_thread);
+	g_object_unref (task);
+}
+
 static void
 export_vpn_to_file_cb (GtkWidget *dialog, gint response, gpointer user_data)
 {
@@ -16,8 +16,14 @@
 
 GSList *vpn_get_plugin_infos (void);
 
+NMVpnEditorPlugin *vpn_get_plugin (NMVpnPluginInfo *plugin_info);
+
+NMVpnEditorPlugin *vpn_peek_plugin (NMVpnPluginInfo *plugin_info);
+
 NMVpnEditorPlugin *vpn_get_plugin_by_service (const char *service);
 
+void vpn_prefetch_editor_plugins (NMClient *client);
+
 void vpn_export (NMConnection *connection);
 
 gboolean vpn_supports_ipv6 (NMConnection *connection);
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#include "nm-default.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "icon-atlas.h"
+
+/* The rendered applet icons of one theme, size and scale, in a single file
+ * under $XDG_CACHE_HOME/nm-applet. The pixbufs loaded from it point right
+ * into the mapped file. The file name includes the newest modification time
+ * of the theme directories, so that an updated theme gets a new atlas; the
+ * atlases of the older versions get pruned.
+ *
+ * The layout is a header, the entries, then the names and the pixel data,
+ * in host byte order.
+ */
+
+#define ATLAS_MAGIC "NMAICON1"
+#define ATLAS_ALIGN 8
+#define ATLAS_PREFIX "icons-"
+#define ATLAS_SUFFIX ".atlas"
+
+typedef struct {
+	char magic[8];
+	guint32 n_entries;
+	guint32 reserved;
+} AtlasHeader;
+
+typedef struct {
+	guint32 name_offset;
+	guint32 data_offset;
+	guint32 width;
+	guint32 height;
+	guint32 rowstride;
+	guint32 has_alpha;
+} AtlasEntry;
+
+static gint64
+theme_dir_mtime (const char *dir, const char *theme_name)
+{
+	const char *files[] = { "", "index.theme", "icon-theme.cache" };
+	struct stat st;
+	gint64 mtime = 0;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (files); i++) {
+		gs_free char *path = g_build_filename (dir, theme_name, files[i], NULL);
+
+		if (stat (path, &st) == 0)
+			mtime = MAX (mtime, (gint64) st.st_mtime);
+	}
+	return mtime;
+}
+
+/**
+ * icon_atlas_get_path:
+ * @theme: the icon theme
+ * @theme_name: the name of @theme
+ * @size: the icon size
+ * @scale: the scale factor
+ *
+ * Returns: the atlas file for the icons of @theme at the size and scale.
+ */
+char *
+icon_atlas_get_path (GtkIconTheme *theme, const char *theme_name, int size, int scale)
+{
+	gs_strfreev char **search_path = NULL;
+	gs_free char *file_name = NULL;
+	gint64 mtime = 0;
+	int i, n;
+
+	/* The applet's own icons come from hicolor */
+	gtk_icon_theme_get_search_path (theme, &search_path, &n);
+	for (i = 0; i < n; i++) {
+		mtime = MAX (mtime, theme_dir_mtime (search_path[i], theme_name));
+		mtime = MAX (mtime, theme_dir_mtime (search_path[i], "hicolor"));
+	}
+
+	file_name = g_strdup_printf (ATLAS_PREFIX "%s-%d@%d-%" G_GINT64_FORMAT ATLAS_SUFFIX,
+	                             theme_name, size, scale, mtime);
+	g_strdelimit (file_name, "/", '_');
+	return g_build_filename (g_get_user_cache_dir (), "nm-applet", file_name, NULL);
+}
+
+static void
+pixbuf_free_mapping (guchar *pixels, gpointer data)
+{
+	g_mapped_file_unref (data);
+}
+
+/**
+ * icon_atlas_load:
+ * @path: the atlas file
+ * @cache: an icon cache, by name
+ *
+ * Adds the icons of the atlas not in @cache yet to it.
+ *
+ * Returns: whether the atlas could be read.
+ */
+gboolean
+icon_atlas_load (const char *path, GHashTable *cache)
+{
+	GMappedFile *file;
+	const AtlasHeader *header;
+	const AtlasEntry *entries;
+	const char *contents;
+	gsize length;
+	guint i;
+
+	file = g_mapped_file_new (path, FALSE, NULL);
+	if (!file)
+		return FALSE;
+
+	contents = g_mapped_file_get_contents (file);
+	length = g_mapped_file_get_length (file);
+	header = (const AtlasHeader *) contents;
+	if (   length < sizeof (*header)
+	    || memcmp (header->magic, ATLAS_MAGIC, sizeof (header->magic)) != 0
+	    || header->n_entries > (length - sizeof (*header)) / sizeof (*entries)) {
+		g_warning ("Ignoring invalid icon cache %s", path);
+		g_mapped_file_unref (file);
+		return FALSE;
+	}
+
+	entries = (const AtlasEntry *) (contents + sizeof (*header));
+	for (i = 0; i < header->n_entries; i++) {
+		const AtlasEntry *e = &entries[i];
+		guint n_channels = e->has_alpha ? 4 : 3;
+		const char *name;
+		GdkPixbuf *icon;
+
+		if (   e->name_offset >= length
+		    || !memchr (contents + e->name_offset, '\0', length - e->name_offset)
+		    || !e->width
+		    || !e->height
+		    || e->rowstride < (guint64) e->width * n_channels
+		    || e->data_offset > length
+		    || (guint64) e->rowstride * (e->height - 1) + e->width * n_channels > length - e->data_offset) {
+			g_warning ("Ignoring invalid icon cache %s", path);
+			break;
+		}
+
+		name = contents + e->name_offset;
+		if (g_hash_table_contains (cache, name))
+			continue;
+
+		icon = gdk_pixbuf_new_from_data ((const guchar *) contents + e->data_offset,
+		                                 GDK_COLORSPACE_RGB,
+		                                 e->has_alpha,
+		                                 8,
+		                                 e->width,
+		                                 e->height,
+		                                 e->rowstride,
+		                                 pixbuf_free_mapping,
+		                                 g_mapped_file_ref (file));
+		g_hash_table_insert (cache, g_strdup (name), icon);
+	}
+
+	g_mapped_file_unref (file);
+	return i == header->n_entries;
+}
+
+static void
+byte_array_align (GByteArray *array)
+{
+	static const guint8 zeros[ATLAS_ALIGN] = { 0 };
+
+	if (array->len % ATLAS_ALIGN)
+		g_byte_array_append (array, zeros, ATLAS_ALIGN - array->len % ATLAS_ALIGN);
+}
+
+/**
+ * icon_atlas_save:
+ * @path: the atlas file
+ * @cache: an icon cache, by name
+ * @names: the names of the icons to save
+ * @skip: (allow-none): an icon not to save, such as the fallback icon
+ *
+ * Writes the icons of @names found in @cache to the atlas file.
+ */
+void
+icon_atlas_save (const char *path, GHashTable *cache, const GPtrArray *names, GdkPixbuf *skip)
+{
+	gs_free char *dir = NULL;
+	gs_free_error GError *error = NULL;
+	GByteArray *array;
+	AtlasHeader header = { ATLAS_MAGIC, 0, 0 };
+	AtlasEntry *entries;
+	guint i, n = 0;
+
+	entries = g_new0 (AtlasEntry, names->len);
+	array = g_byte_array_new ();
+	g_byte_array_set_size (array, sizeof (header) + names->len * sizeof (*entries));
+
+	for (i = 0; i < names->len; i++) {
+		const char *name = names->pdata[i];
+		GdkPixbuf *icon = g_hash_table_lookup (cache, name);
+
+		if (   !icon
+		    || icon == skip
+		    || gdk_pixbuf_get_colorspace (icon) != GDK_COLORSPACE_RGB
+		    || gdk_pixbuf_get_bits_per_sample (icon) != 8)
+			continue;
+
+		entries[n].name_offset = array->len;
+		g_byte_array_append (array, (const guint8 *) name, strlen (name) + 1);
+		byte_array_align (array);
+
+		entries[n].data_offset = array->len;
+		entries[n].width = gdk_pixbuf_get_width (icon);
+		entries[n].height = gdk_pixbuf_get_height (icon);
+		entries[n].rowstride = gdk_pixbuf_get_rowstride (icon);
+		entries[n].has_alpha = gdk_pixbuf_get_has_alpha (icon);
+		g_byte_array_append (array, gdk_pixbuf_get_pixels (icon), gdk_pixbuf_get_byte_length (icon));
+		byte_array_align (array);
+		n++;
+	}
+
+	header.n_entries = n;
+	memcpy (array->data, &header, sizeof (header));
+	memcpy (array->data + sizeof (header), entries, n * sizeof (*entries));
+	g_free (entries);
+
+	dir = g_path_get_dirname (path);
+	if (   g_mkdir_with_parents (dir, 0700) != 0
+	    || !g_file_set_contents (path, (const char *) array->data, array->len, &error))
+		g_debug ("Could not write icon cache %s: %s", path, error ? error->message : g_strerror (errno));
+
+	g_byte_array_unref (array);
+}
+
+/**
+ * icon_atlas_prune:
+ * @path: the atlas file in use
+ *
+ * Removes the out of date atlases of the same theme, size and scale as
+ * @path, that is the ones for older versions of the theme. The atlases
+ * of other themes stay, for when the user switches back to them.
+ */
+void
+icon_atlas_prune (const char *path)
+{
+	gs_free char *dir_path = NULL;
+	gs_free char *base = NULL;
+	const char *name;
+	gsize key_len;
+	GDir *dir;
+
+	/* The key is everything up to the theme's modification time */
+	base = g_path_get_basename (path);
+	key_len = strrchr (base, '-') - base + 1;
+
+	dir_path = g_path_get_dirname (path);
+	dir = g_dir_open (dir_path, 0, NULL);
+	if (!dir)
+		return;
+
+	while ((name = g_dir_read_name (dir))) {
+		gs_free char *stale = NULL;
+		gsize len = strlen (name);
+
+		if (   nm_streq (name, base)
+		    || strncmp (name, base, key_len) != 0
+		    || !g_str_has_suffix (name, ATLAS_SUFFIX)
+		    || len == key_len + strlen (ATLAS_SUFFIX)
+		    || strspn (name + key_len, "0123456789") != len - key_len - strlen (ATLAS_SUFFIX))
+			continue;
+
+		stale = g_build_filename (dir_path, name, NULL);
+		if (unlink (stale) != 0)
+			g_debug ("Could not remove icon cache %s: %s", stale, g_strerror (errno));
+	}
+
+	g_dir_close (dir);
+}
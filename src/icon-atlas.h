@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#ifndef ICON_ATLAS_H
+#define ICON_ATLAS_H
+
+#include <gtk/gtk.h>
+
+char *   icon_atlas_get_path (GtkIconTheme *theme,
+                              const char *theme_name,
+                              int size,
+                              int scale);
+
+gboolean icon_atlas_load (const char *path, GHashTable *cache);
+
+void     icon_atlas_save (const char *path,
+                          GHashTable *cache,
+                          const GPtrArray *names,
+                          GdkPixbuf *skip);
+
+void     icon_atlas_prune (const char *path);
+
+#endif /* ICON_ATLAS_H */
@@ -12,12 +12,17 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <locale.h>
 
 #include "applet.h"
+#include "profile.h"
+#include "applet-stats.h"
 
 gboolean shell_debug = FALSE;
 gboolean with_agent = TRUE;
 gboolean with_appindicator = FALSE;
+gboolean with_stats = FALSE;
+gboolean agent_only = FALSE;
 
 static void
 usage (const char *progname)
@@ -47,6 +52,17 @@ int main (int argc, char *argv[])
 			shell_debug = TRUE;
 		else if (!strcmp (argv[i], "--no-agent"))
 			with_agent = FALSE;
+		else if (!strcmp (argv[i], "--agent-only"))
+			agent_only = TRUE;
+		else if (!strcmp (argv[i], "--stats"))
+			with_stats = TRUE;
+		else if (!strcmp (argv[i], "--dump-stats")) {
+			setlocale (LC_ALL, "");
+			bindtextdomain (GETTEXT_PACKAGE, NMALOCALEDIR);
+			bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+			textdomain (GETTEXT_PACKAGE);
+			return applet_stats_dump ();
+		}
 		else if (!strcmp (argv[i], "--indicator")) {
 #ifdef WITH_APPINDICATOR
 			with_appindicator = TRUE;
@@ -56,18 +72,30 @@ int main (int argc, char *argv[])
 		}
 	}
 
+	/* Otherwise done by gtk_init() */
+	if (agent_only)
+		setlocale (LC_ALL, "");
+
 	bindtextdomain (GETTEXT_PACKAGE, NMALOCALEDIR);
 	bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
-	if (!with_appindicator)
-		gdk_set_allowed_backends ("x11,*");
-	gtk_init (&argc, &argv);
+	if (agent_only) {
+		/* GTK is initialized on the first secrets request */
+		with_agent = TRUE;
+		with_appindicator = FALSE;
+	} else {
+		if (!with_appindicator)
+			gdk_set_allowed_backends ("x11,*");
+		gtk_init (&argc, &argv);
+	}
 	textdomain (GETTEXT_PACKAGE);
+	nma_profile_init ();
 
 	applet = g_object_new (NM_TYPE_APPLET,
 	                       "application-id", "org.freedesktop.network-manager-applet",
 	                       NULL);
 	status = g_application_run (applet, 1, fake_args);
 	g_object_unref (applet);
+	nma_profile_shutdown ();
 
 	return status;
 }
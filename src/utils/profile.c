@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#include "nm-default.h"
+
+#include "profile.h"
+
+#if WITH_SYSPROF
+
+#include <unistd.h>
+#include <sysprof-capture.h>
+
+static SysprofCaptureWriter *writer;
+
+/**
+ * nma_profile_init:
+ *
+ * Opens the capture file if NMA_SYSPROF_CAPTURE is set. Call early in main(),
+ * after g_set_prgname().
+ */
+void
+nma_profile_init (void)
+{
+	const char *prefix;
+	gs_free char *path = NULL;
+
+	sysprof_clock_init ();
+
+	prefix = g_getenv ("NMA_SYSPROF_CAPTURE");
+	if (!prefix || !*prefix || writer)
+		return;
+
+	path = g_strdup_printf ("%s-%s.syscap", prefix, g_get_prgname () ?: "nma");
+	writer = sysprof_capture_writer_new (path, 0);
+	if (!writer)
+		g_warning ("Can't write the profiling capture to '%s'", path);
+}
+
+void
+nma_profile_shutdown (void)
+{
+	if (!writer)
+		return;
+
+	sysprof_capture_writer_flush (writer);
+	g_clear_pointer (&writer, sysprof_capture_writer_unref);
+}
+
+gint64
+nma_profile_now (void)
+{
+	return SYSPROF_CAPTURE_CURRENT_TIME;
+}
+
+static void
+mark (gint64 begin, const char *group, const char *name, const char *message)
+{
+	gint64 duration = SYSPROF_CAPTURE_CURRENT_TIME - begin;
+
+	if (writer) {
+		sysprof_capture_writer_add_mark (writer, begin, -1, getpid (),
+		                                 duration, group, name, message);
+	} else
+		sysprof_collector_mark (begin, duration, group, name, message);
+}
+
+/**
+ * nma_profile_mark:
+ * @begin: the nma_profile_now() timestamp the marked span started at
+ * @group: the group the mark is shown under
+ * @name: the name of the mark
+ *
+ * Records a mark spanning from @begin to now.
+ */
+void
+nma_profile_mark (gint64 begin, const char *group, const char *name)
+{
+	mark (begin, group, name, NULL);
+}
+
+/**
+ * nma_profile_mark_message:
+ * @begin: the nma_profile_now() timestamp the marked span started at
+ * @group: the group the mark is shown under
+ * @name: the name of the mark
+ * @format: printf() format of the message attached to the mark
+ * @...: the parameters
+ *
+ * Like nma_profile_mark(), with a message describing the span.
+ */
+void
+nma_profile_mark_message (gint64 begin,
+                          const char *group,
+                          const char *name,
+                          const char *format,
+                          ...)
+{
+	gs_free char *message = NULL;
+	va_list args;
+
+	va_start (args, format);
+	message = g_strdup_vprintf (format, args);
+	va_end (args);
+
+	mark (begin, group, name, message);
+}
+
+#endif /* WITH_SYSPROF */
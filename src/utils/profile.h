@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0+
+/* NetworkManager Applet -- allow user control over networking */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/* Sysprof capture marks. With -Dsysprof=true, the marks are written to
+ * "$NMA_SYSPROF_CAPTURE-<program>.syscap" if that variable is set, or
+ * handed to sysprof if running under it. Otherwise these are no-ops.
+ *
+ * Usage:
+ *
+ *	gint64 begin = nma_profile_now ();
+ *	...
+ *	nma_profile_mark (begin, "applet", "update-menu");
+ */
+
+#if WITH_SYSPROF
+
+void   nma_profile_init (void);
+void   nma_profile_shutdown (void);
+gint64 nma_profile_now (void);
+void   nma_profile_mark (gint64 begin, const char *group, const char *name);
+void   nma_profile_mark_message (gint64 begin,
+                                 const char *group,
+                                 const char *name,
+                                 const char *format,
+                                 ...) G_GNUC_PRINTF (4, 5);
+
+#else
+
+static inline void nma_profile_init (void) { }
+static inline void nma_profile_shutdown (void) { }
+static inline gint64 nma_profile_now (void) { return 0; }
+static inline void nma_profile_mark (gint64 begin, const char *group, const char *name) { }
+
+/* A macro, so that the message arguments are not even evaluated */
+#define nma_profile_mark_message(begin, group, name, ...) \
+	G_STMT_START { \
+		(void) (begin); \
+	} G_STMT_END
+
+#endif
+
+#endif /* PROFILE_H */
@@ -399,6 +399,60 @@ test_ap_hash_foobar_asdf11_adhoc_wpa_rsn (TestData *d)
 
 NMTST_DEFINE ();
 
+static void
+test_parse_ip_routes (void)
+{
+	GPtrArray *routes;
+	NMIPRoute *route;
+	guint skipped = 0;
+
+	routes = utils_parse_ip_routes ("default via 192.168.1.1 dev eth0 proto dhcp metric 100\n"
+	                                "10.0.0.0/8 via 192.168.1.254 dev eth0 metric 50\n"
+	                                "\n"
+	                                "# comment\n"
+	                                "  192.168.1.0/24  dev eth0 proto kernel scope link src 192.168.1.5\n"
+	                                "ip route add 172.16.1.1 via 10.1.1.1 onlink\n"
+	                                "blackhole 10.9.0.0/16\n"
+	                                "10.2.0.0/33 dev eth0\n"
+	                                "10.3.0.0/16 metric\n",
+	                                AF_INET, &skipped);
+	g_assert (routes);
+	g_assert_cmpint (routes->len, ==, 3);
+	g_assert_cmpint (skipped, ==, 4);
+
+	route = routes->pdata[0];
+	g_assert_cmpstr (nm_ip_route_get_dest (route), ==, "10.0.0.0");
+	g_assert_cmpint (nm_ip_route_get_prefix (route), ==, 8);
+	g_assert_cmpstr (nm_ip_route_get_next_hop (route), ==, "192.168.1.254");
+	g_assert_cmpint (nm_ip_route_get_metric (route), ==, 50);
+
+	route = routes->pdata[1];
+	g_assert_cmpstr (nm_ip_route_get_dest (route), ==, "192.168.1.0");
+	g_assert_cmpint (nm_ip_route_get_prefix (route), ==, 24);
+	g_assert_cmpstr (nm_ip_route_get_next_hop (route), ==, NULL);
+	g_assert_cmpint (nm_ip_route_get_metric (route), ==, -1);
+
+	route = routes->pdata[2];
+	g_assert_cmpstr (nm_ip_route_get_dest (route), ==, "172.16.1.1");
+	g_assert_cmpint (nm_ip_route_get_prefix (route), ==, 32);
+	g_assert_cmpstr (nm_ip_route_get_next_hop (route), ==, "10.1.1.1");
+	g_ptr_array_unref (routes);
+
+	routes = utils_parse_ip_routes ("2001:db8::/64 via fe80::1 dev eth0 proto static metric 1024 pref medium\n"
+	                                "10.0.0.0/8 dev eth0\n",
+	                                AF_INET6, &skipped);
+	g_assert (routes);
+	g_assert_cmpint (routes->len, ==, 1);
+	g_assert_cmpint (skipped, ==, 1);
+
+	route = routes->pdata[0];
+	g_assert_cmpstr (nm_ip_route_get_dest (route), ==, "2001:db8::");
+	g_assert_cmpint (nm_ip_route_get_prefix (route), ==, 64);
+	g_assert_cmpstr (nm_ip_route_get_next_hop (route), ==, "fe80::1");
+	g_assert_cmpint (nm_ip_route_get_metric (route), ==, 1024);
+	g_ptr_array_unref (routes);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -488,6 +542,8 @@ main (int argc, char **argv)
 	g_test_add_data_func ("/ap_hash/foobar_asdf11/adhoc_wpa_rsn", data,
 	                      (GTestDataFunc) test_ap_hash_foobar_asdf11_adhoc_wpa_rsn);
 
+	g_test_add_func ("/routes/parse", test_parse_ip_routes);
+
 	result = g_test_run ();
 
 	test_data_free (data);
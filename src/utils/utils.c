@@ -491,6 +491,120 @@ out:
 	return success;
 }
 
+/**
+ * utils_parse_ip_routes:
+ * @text: routes in the format of "ip route" output or arguments, one per line
+ * @family: %AF_INET or %AF_INET6
+ * @out_skipped: (out) (allow-none): the number of non-empty lines that are
+ *   not usable routes
+ *
+ * Default routes, routes of a type other than unicast and lines that can't
+ * be parsed are skipped. Can be called from any thread.
+ *
+ * Returns: (transfer full): an array of #NMIPRoute
+ */
+GPtrArray *
+utils_parse_ip_routes (const char *text, int family, guint *out_skipped)
+{
+	static const char *const commands[] = { "ip", "-4", "-6", "route", "ro", "r",
+	                                        "add", "append", "replace", NULL };
+	static const char *const types[] = { "unreachable", "blackhole", "prohibit", "throw",
+	                                     "local", "broadcast", "multicast", "nat", "anycast", NULL };
+	static const char *const flags[] = { "onlink", "linkdown", "dead", "pervasive", "notify", NULL };
+	GPtrArray *routes;
+	gs_strfreev char **lines = NULL;
+	guint max_prefix = family == AF_INET ? 32 : 128;
+	guint skipped = 0;
+	guint i;
+
+	g_return_val_if_fail (text, NULL);
+	g_return_val_if_fail (family == AF_INET || family == AF_INET6, NULL);
+
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nm_ip_route_unref);
+	lines = g_strsplit (text, "\n", -1);
+
+	for (i = 0; lines[i]; i++) {
+		gs_strfreev char **tokens = NULL;
+		gs_free char *dest = NULL;
+		const char *next_hop = NULL;
+		gint64 prefix = max_prefix;
+		gint64 metric = -1;
+		NMIPRoute *route;
+		char *slash;
+		guint j, n;
+
+		g_strstrip (lines[i]);
+		if (!lines[i][0] || lines[i][0] == '#')
+			continue;
+
+		/* Split on whitespace, dropping the empty tokens */
+		tokens = g_strsplit_set (lines[i], " \t", -1);
+		for (j = 0, n = 0; tokens[j]; j++) {
+			if (tokens[j][0])
+				tokens[n++] = tokens[j];
+			else
+				g_free (tokens[j]);
+		}
+		tokens[n] = NULL;
+
+		j = 0;
+		while (tokens[j] && g_strv_contains (commands, tokens[j]))
+			j++;
+		if (nm_streq0 (tokens[j], "unicast"))
+			j++;
+		if (   !tokens[j]
+		    || nm_streq (tokens[j], "default")
+		    || g_strv_contains (types, tokens[j]))
+			goto skip;
+
+		dest = g_strdup (tokens[j++]);
+		slash = strchr (dest, '/');
+		if (slash) {
+			*slash = '\0';
+			prefix = _nm_utils_ascii_str_to_int64 (slash + 1, 10, 0, max_prefix, -1);
+		}
+		if (prefix <= 0 || !nm_utils_ipaddr_valid (family, dest))
+			goto skip;
+
+		/* The remaining tokens are flags or key-value pairs */
+		while (tokens[j]) {
+			const char *key = tokens[j++];
+			const char *value;
+
+			if (g_strv_contains (flags, key))
+				continue;
+			value = tokens[j++];
+			if (!value)
+				goto skip;
+
+			if (nm_streq (key, "via")) {
+				if (NM_IN_STRSET (value, "inet", "inet6")) {
+					value = tokens[j++];
+					if (!value)
+						goto skip;
+				}
+				next_hop = value;
+			} else if (NM_IN_STRSET (key, "metric", "priority", "preference")) {
+				metric = _nm_utils_ascii_str_to_int64 (value, 10, 0, G_MAXUINT32, -1);
+				if (metric < 0)
+					goto skip;
+			}
+		}
+
+		route = nm_ip_route_new (family, dest, prefix, next_hop, metric, NULL);
+		if (!route)
+			goto skip;
+		g_ptr_array_add (routes, route);
+		continue;
+
+skip:
+		skipped++;
+	}
+
+	NM_SET_OUT (out_skipped, skipped);
+	return routes;
+}
+
 static gboolean
 file_has_extension (const char *filename, const char *const*extensions)
 {
@@ -84,6 +84,10 @@ gboolean utils_tree_model_get_ip4_prefix (GtkTreeModel *model,
                                           guint32 *out,
                                           char **out_raw);
 
+GPtrArray *utils_parse_ip_routes (const char *text,
+                                  int family,
+                                  guint *out_skipped);
+
 GtkFileFilter *utils_cert_filter (void);
 
 GtkFileFilter *utils_key_filter (void);